@@ -22,6 +22,7 @@
 #define POPPLER_DOCUMENT_PRIVATE_H
 
 #include "poppler-global.h"
+#include "poppler-document.h"
 
 #include "poppler-config.h"
 #include "GooString.h"
@@ -45,6 +46,8 @@ public:
 
     static document *check_document(document_private *doc, byte_array *file_data);
 
+    static inline document_private *get(const poppler::document *d) { return d->d; }
+
     PDFDoc *doc;
     byte_array doc_data;
     const char *raw_doc_data;
@@ -0,0 +1,258 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/**
+ \file poppler-document-renderer.h
+ */
+#include "poppler-document-renderer.h"
+
+#include "poppler-document-private.h"
+#include "poppler-page-renderer-private.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "PDFDoc.h"
+#include "SplashOutputDev.h"
+
+using namespace poppler;
+
+class poppler::document_renderer_private
+{
+public:
+    document_renderer_private() : threads(std::max(std::thread::hardware_concurrency(), 1u)) { }
+
+    unsigned int threads;
+};
+
+/**
+ \class poppler::document_renderer poppler-document-renderer.h "poppler/cpp/poppler-document-renderer.h"
+
+ Renders many pages of a PDF %document on a pool of threads.
+
+ All the threads work on the same %document, and the objects read from it are
+ shared. Each thread has its own output device, which is kept from one page
+ to the next: the fonts and glyph caches are not shared between the threads,
+ so each font used on pages rendered by several threads is loaded, and its
+ glyphs rasterized, once per thread, with the memory this takes.
+
+ \since 22.01
+ */
+
+/**
+ \struct poppler::document_renderer::page_options
+
+ The parameters used to render a page, with the same meaning as the ones of
+ page_renderer::render_page().
+*/
+
+/**
+ \typedef poppler::document_renderer::options_function
+
+ Returns the page_options for the page of the specified index.
+*/
+
+/**
+ \typedef poppler::document_renderer::page_function
+
+ Receives a rendered page, with its index; the image is null in case of
+ errors.
+*/
+
+/**
+ Constructs a new %document renderer.
+ */
+document_renderer::document_renderer() : d(new document_renderer_private()) { }
+
+/**
+ Destructor.
+ */
+document_renderer::~document_renderer()
+{
+    delete d;
+}
+
+/**
+ The number of threads used when rendering.
+
+ By default as many threads as the hardware can run concurrently are used.
+
+ \returns the number of threads
+ */
+unsigned int document_renderer::thread_count() const
+{
+    return d->threads;
+}
+
+/**
+ Set the number of threads used when rendering.
+
+ \param count the new number of threads; 0 is taken as 1
+ */
+void document_renderer::set_thread_count(unsigned int count)
+{
+    d->threads = std::max(count, 1u);
+}
+
+/**
+ Render a range of pages.
+
+ The pages are rendered concurrently, following the paper color, hints,
+ image format, line mode and time limit of \p renderer. \p page_done is
+ called on the calling thread for each page, in page order, as soon as the
+ page and all the ones before it are rendered; render_pages() returns after
+ the last one.
+
+ If \p page_done throws, no more pages are rendered, and the exception is
+ passed on once the pages being rendered are done.
+
+ \param doc the %document to render
+ \param first the index of the first page to render
+ \param last the index of the last page to render
+ \param renderer the renderer holding the rendering settings
+ \param page_done called for each rendered page
+ \param options returns the parameters for each page; if not set, the default
+                page_options are used for all the pages
+
+ \see page_renderer::can_render
+ */
+void document_renderer::render_pages(const document *doc, int first, int last, const page_renderer &renderer, const page_function &page_done, const options_function &options) const
+{
+    if (!doc || doc->is_locked() || first < 0 || last >= doc->pages() || last < first) {
+        return;
+    }
+
+    PDFDoc *pdfdoc = document_private::get(doc)->doc;
+    const page_renderer_private *rd = page_renderer_private::get(&renderer);
+
+    std::vector<page_options> page_opts(last - first + 1);
+    if (options) {
+        for (int i = first; i <= last; ++i) {
+            page_opts[i - first] = options(i);
+        }
+    }
+
+    const int nthreads = std::min<int>(d->threads, last - first + 1);
+    // rendered pages not passed to page_done yet are kept at most this many
+    const int window = 2 * nthreads;
+
+    std::mutex mutex;
+    std::condition_variable page_ready; // signalled by the workers
+    std::condition_variable page_taken; // signalled by the calling thread
+    // reordering buffer; image is not thread-safe, so each one is only
+    // accessed by one thread at a time
+    std::map<int, std::unique_ptr<image>> finished;
+    int next_page = first; // next page to hand out to a worker
+    int next_done = first; // next page to pass to page_done
+    bool canceled = false; // set when page_done threw, the workers then stop
+
+    auto worker = [&] {
+        std::unique_ptr<render_output_dev> output_dev = rd->create_output_dev(pdfdoc);
+        while (true) {
+            int index;
+            {
+                std::unique_lock<std::mutex> locker(mutex);
+                page_taken.wait(locker, [&] { return canceled || next_page > last || next_page < next_done + window; });
+                if (canceled || next_page > last) {
+                    return;
+                }
+                index = next_page++;
+            }
+
+            std::unique_ptr<image> img;
+            if (output_dev) {
+                const page_options &o = page_opts[index - first];
+                img = std::make_unique<image>(rd->render_page(output_dev.get(), pdfdoc, index, o.xres, o.yres, o.x, o.y, o.w, o.h, o.rotate, nullptr));
+            }
+
+            std::unique_lock<std::mutex> locker(mutex);
+            finished[index] = std::move(img);
+            page_ready.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    auto join_threads = [&threads] {
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    };
+
+    try {
+        threads.reserve(nthreads);
+        for (int i = 0; i < nthreads; ++i) {
+            threads.emplace_back(worker);
+        }
+
+        while (next_done <= last) {
+            std::unique_ptr<image> img;
+            {
+                std::unique_lock<std::mutex> locker(mutex);
+                page_ready.wait(locker, [&] { return finished.count(next_done) > 0; });
+                auto it = finished.find(next_done);
+                img = std::move(it->second);
+                finished.erase(it);
+            }
+            if (page_done) {
+                page_done(next_done, img ? *img : image());
+            }
+            {
+                std::unique_lock<std::mutex> locker(mutex);
+                ++next_done;
+            }
+            page_taken.notify_all();
+        }
+    } catch (...) {
+        // the workers must not outlive the state they share with this
+        // function: let them finish their current page, and stop
+        {
+            std::unique_lock<std::mutex> locker(mutex);
+            canceled = true;
+        }
+        page_taken.notify_all();
+        join_threads();
+        throw;
+    }
+
+    join_threads();
+}
+
+/**
+ Render a range of pages.
+
+ This is a convenience overload rendering all the pages with the same
+ parameters, and returning all the images at once.
+
+ \param doc the %document to render
+ \param first the index of the first page to render
+ \param last the index of the last page to render
+ \param renderer the renderer holding the rendering settings
+ \param options the parameters used for all the pages
+
+ \returns the rendered images, in page order, or an empty list in case of
+          errors
+ */
+std::vector<image> document_renderer::render_pages(const document *doc, int first, int last, const page_renderer &renderer, const page_options &options) const
+{
+    std::vector<image> images;
+    render_pages(
+            doc, first, last, renderer, [&images](int, const image &img) { images.push_back(img); }, [&options](int) { return options; });
+    return images;
+}
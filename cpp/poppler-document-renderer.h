@@ -0,0 +1,67 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef POPPLER_DOCUMENT_RENDERER_H
+#define POPPLER_DOCUMENT_RENDERER_H
+
+#include "poppler-global.h"
+#include "poppler-image.h"
+
+#include <functional>
+#include <vector>
+
+namespace poppler {
+
+class document;
+class document_renderer_private;
+class page_renderer;
+
+class POPPLER_CPP_EXPORT document_renderer : public poppler::noncopyable
+{
+public:
+    struct page_options
+    {
+        page_options() : xres(72.0), yres(72.0), x(-1), y(-1), w(-1), h(-1), rotate(rotate_0) { }
+
+        double xres;
+        double yres;
+        int x;
+        int y;
+        int w;
+        int h;
+        rotation_enum rotate;
+    };
+
+    typedef std::function<page_options(int index)> options_function;
+    typedef std::function<void(int index, const image &img)> page_function;
+
+    document_renderer();
+    ~document_renderer();
+
+    unsigned int thread_count() const;
+    void set_thread_count(unsigned int count);
+
+    void render_pages(const document *doc, int first, int last, const page_renderer &renderer, const page_function &page_done, const options_function &options = options_function()) const;
+    std::vector<image> render_pages(const document *doc, int first, int last, const page_renderer &renderer, const page_options &options = page_options()) const;
+
+private:
+    document_renderer_private *d;
+    friend class document_renderer_private;
+};
+
+}
+
+#endif
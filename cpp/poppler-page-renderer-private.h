@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef POPPLER_PAGE_RENDERER_PRIVATE_H
+#define POPPLER_PAGE_RENDERER_PRIVATE_H
+
+#include "poppler-page-renderer.h"
+
+#include "SplashOutputDev.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+class PDFDoc;
+
+namespace poppler {
+
+// stops a rendering, checked by Gfx through its abort callback
+class render_control
+{
+public:
+    render_control() : canceled(false), timed_out(false), has_deadline(false) { }
+
+    void set_time_limit(int msecs);
+
+    static bool abort_check(void *data);
+
+    std::atomic<bool> canceled;
+    std::atomic<bool> timed_out;
+    bool has_deadline;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+class render_output_dev : public SplashOutputDev
+{
+public:
+    render_output_dev(SplashColorMode colorModeA, SplashColor paperColorA, SplashThinLineMode thinLineMode, image::format_enum formatA);
+
+    void dump() override;
+
+    // a copy of the current bitmap
+    image bitmap_image();
+
+    page_renderer::partial_update_function partial_update;
+
+private:
+    image::format_enum format;
+};
+
+class page_renderer_private
+{
+public:
+    page_renderer_private() : paper_color(0xffffffff), hints(0), image_format(image::format_enum::format_argb32), line_mode(page_renderer::line_mode_enum::line_default), time_limit(-1) { }
+
+    static bool conv_color_mode(image::format_enum mode, SplashColorMode &splash_mode);
+    static bool conv_line_mode(page_renderer::line_mode_enum mode, SplashThinLineMode &splash_mode);
+
+    // creates an output device set up for pdfdoc following the current
+    // options, or nullptr if they are not valid
+    std::unique_ptr<render_output_dev> create_output_dev(PDFDoc *pdfdoc) const;
+    // renders the page (0-based index) with an output device returned by
+    // create_output_dev; the device can be reused for further pages.
+    // Returns a null image if the rendering is stopped through control
+    // (which can be null).
+    image render_page(render_output_dev *output_dev, PDFDoc *pdfdoc, int index, double xres, double yres, int x, int y, int w, int h, rotation_enum rotate, render_control *control) const;
+
+    static inline page_renderer_private *get(const page_renderer *r) { return r->d; }
+
+    argb paper_color;
+    unsigned int hints;
+    image::format_enum image_format;
+    page_renderer::line_mode_enum line_mode;
+    int time_limit;
+};
+
+}
+
+#endif
@@ -25,6 +25,7 @@
  \file poppler-page-renderer.h
  */
 #include "poppler-page-renderer.h"
+#include "poppler-page-renderer-private.h"
 
 #include "poppler-document-private.h"
 #include "poppler-page-private.h"
@@ -37,21 +38,11 @@
 #include "SplashOutputDev.h"
 #include "splash/SplashBitmap.h"
 
-using namespace poppler;
-
-class poppler::page_renderer_private
-{
-public:
-    page_renderer_private() : paper_color(0xffffffff), hints(0), image_format(image::format_enum::format_argb32), line_mode(page_renderer::line_mode_enum::line_default) { }
-
-    static bool conv_color_mode(image::format_enum mode, SplashColorMode &splash_mode);
-    static bool conv_line_mode(page_renderer::line_mode_enum mode, SplashThinLineMode &splash_mode);
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
-    argb paper_color;
-    unsigned int hints;
-    image::format_enum image_format;
-    page_renderer::line_mode_enum line_mode;
-};
+using namespace poppler;
 
 bool page_renderer_private::conv_color_mode(image::format_enum mode, SplashColorMode &splash_mode)
 {
@@ -95,6 +86,102 @@ bool page_renderer_private::conv_line_mode(page_renderer::line_mode_enum mode, S
     return true;
 }
 
+std::unique_ptr<render_output_dev> page_renderer_private::create_output_dev(PDFDoc *pdfdoc) const
+{
+    SplashColorMode colorMode;
+    SplashThinLineMode lineMode;
+
+    if (!conv_color_mode(image_format, colorMode) || !conv_line_mode(line_mode, lineMode)) {
+        return nullptr;
+    }
+
+    SplashColor bgColor;
+    bgColor[0] = paper_color & 0xff;
+    bgColor[1] = (paper_color >> 8) & 0xff;
+    bgColor[2] = (paper_color >> 16) & 0xff;
+    auto splashOutputDev = std::make_unique<render_output_dev>(colorMode, bgColor, lineMode, image_format);
+    splashOutputDev->setFontAntialias(hints & page_renderer::text_antialiasing ? true : false);
+    splashOutputDev->setVectorAntialias(hints & page_renderer::antialiasing ? true : false);
+    splashOutputDev->setFreeTypeHinting(hints & page_renderer::text_hinting ? true : false, false);
+    splashOutputDev->startDoc(pdfdoc);
+    return splashOutputDev;
+}
+
+image page_renderer_private::render_page(render_output_dev *output_dev, PDFDoc *pdfdoc, int index, double xres, double yres, int x, int y, int w, int h, rotation_enum rotate, render_control *control) const
+{
+    render_control local_control;
+    if (!control && time_limit >= 0) {
+        control = &local_control;
+    }
+    if (control && time_limit >= 0 && !control->has_deadline) {
+        control->set_time_limit(time_limit);
+    }
+
+    pdfdoc->displayPageSlice(output_dev, index + 1, xres, yres, int(rotate) * 90, false, true, false, x, y, w, h, control ? &render_control::abort_check : nullptr, control, nullptr, nullptr, true);
+
+    if (control && (control->canceled || control->timed_out)) {
+        return image();
+    }
+    return output_dev->bitmap_image();
+}
+
+void render_control::set_time_limit(int msecs)
+{
+    has_deadline = true;
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(msecs);
+}
+
+bool render_control::abort_check(void *data)
+{
+    render_control *control = static_cast<render_control *>(data);
+    if (control->canceled) {
+        return true;
+    }
+    if (control->has_deadline && std::chrono::steady_clock::now() >= control->deadline) {
+        control->timed_out = true;
+        return true;
+    }
+    return false;
+}
+
+render_output_dev::render_output_dev(SplashColorMode colorModeA, SplashColor paperColorA, SplashThinLineMode thinLineMode, image::format_enum formatA)
+    : SplashOutputDev(colorModeA, 4, false, paperColorA, true, thinLineMode), format(formatA)
+{
+}
+
+void render_output_dev::dump()
+{
+    if (partial_update) {
+        partial_update(bitmap_image());
+    }
+}
+
+image render_output_dev::bitmap_image()
+{
+    SplashBitmap *bmp = getBitmap();
+    const int bw = bmp->getWidth();
+    const int bh = bmp->getHeight();
+
+    SplashColorPtr data_ptr = bmp->getDataPtr();
+
+    const image img(reinterpret_cast<char *>(data_ptr), bw, bh, format);
+    return img.copy();
+}
+
+class poppler::render_job_private
+{
+public:
+    render_job_private() : state(render_job::state_running) { }
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable finished;
+    render_job::state_enum state;
+    // only set by the rendering thread, and only read once it is done
+    std::unique_ptr<image> result;
+    render_control control;
+    std::thread thread;
+};
+
 /**
  \class poppler::page_renderer poppler-page-renderer.h "poppler/cpp/poppler-renderer.h"
 
@@ -233,6 +320,34 @@ void page_renderer::set_line_mode(page_renderer::line_mode_enum mode)
     d->line_mode = mode;
 }
 
+/**
+ The maximum time spent rendering a page.
+
+ By default there is no limit (-1).
+
+ \returns the time limit, in milliseconds
+
+ \since 22.01
+ */
+int page_renderer::time_limit() const
+{
+    return d->time_limit;
+}
+
+/**
+ Set the maximum time spent rendering a page.
+
+ A rendering taking longer is stopped, and gives a null image.
+
+ \param msecs the new time limit, in milliseconds, or -1 for no limit
+
+ \since 22.01
+ */
+void page_renderer::set_time_limit(int msecs)
+{
+    d->time_limit = msecs < 0 ? -1 : msecs;
+}
+
 /**
  Render the specified page.
 
@@ -248,7 +363,8 @@ void page_renderer::set_line_mode(page_renderer::line_mode_enum mode)
  \param h the height in pixels of the area to render
  \param rotate the rotation to apply when rendering the page
 
- \returns the rendered image, or a null one in case of errors
+ \returns the rendered image, or a null one in case of errors or if the
+          rendering takes longer than time_limit()
 
  \see can_render
  */
@@ -261,32 +377,75 @@ image page_renderer::render_page(const page *p, double xres, double yres, int x,
     page_private *pp = page_private::get(p);
     PDFDoc *pdfdoc = pp->doc->doc;
 
-    SplashColorMode colorMode;
-    SplashThinLineMode lineMode;
-
-    if (!d->conv_color_mode(d->image_format, colorMode) || !d->conv_line_mode(d->line_mode, lineMode)) {
+    std::unique_ptr<render_output_dev> splashOutputDev = d->create_output_dev(pdfdoc);
+    if (!splashOutputDev) {
         return image();
     }
 
-    SplashColor bgColor;
-    bgColor[0] = d->paper_color & 0xff;
-    bgColor[1] = (d->paper_color >> 8) & 0xff;
-    bgColor[2] = (d->paper_color >> 16) & 0xff;
-    SplashOutputDev splashOutputDev(colorMode, 4, false, bgColor, true, lineMode);
-    splashOutputDev.setFontAntialias(d->hints & text_antialiasing ? true : false);
-    splashOutputDev.setVectorAntialias(d->hints & antialiasing ? true : false);
-    splashOutputDev.setFreeTypeHinting(d->hints & text_hinting ? true : false, false);
-    splashOutputDev.startDoc(pdfdoc);
-    pdfdoc->displayPageSlice(&splashOutputDev, pp->index + 1, xres, yres, int(rotate) * 90, false, true, false, x, y, w, h, nullptr, nullptr, nullptr, nullptr, true);
-
-    SplashBitmap *bitmap = splashOutputDev.getBitmap();
-    const int bw = bitmap->getWidth();
-    const int bh = bitmap->getHeight();
-
-    SplashColorPtr data_ptr = bitmap->getDataPtr();
-
-    const image img(reinterpret_cast<char *>(data_ptr), bw, bh, d->image_format);
-    return img.copy();
+    return d->render_page(splashOutputDev.get(), pdfdoc, pp->index, xres, yres, x, y, w, h, rotate, nullptr);
+}
+
+/**
+ Start rendering the specified page in the background.
+
+ The page is rendered as by render_page(), on a separate thread; the returned
+ %render_job gives its result, and allows to cancel the rendering. The
+ %document of the page must be kept until the job is deleted.
+
+ \param p the page to render
+ \param xres the X resolution, in dot per inch (DPI)
+ \param yres the Y resolution, in dot per inch (DPI)
+ \param x the X top-right coordinate, in pixels
+ \param y the Y top-right coordinate, in pixels
+ \param w the width in pixels of the area to render
+ \param h the height in pixels of the area to render
+ \param rotate the rotation to apply when rendering the page
+ \param partial_update if set, called on the rendering thread from time to time
+                       with the page rendered so far, and at the end with the
+                       whole page
+
+ \returns the new job, which must be deleted by the caller, or null in case of
+          errors
+
+ \see time_limit
+ \since 22.01
+ */
+render_job *page_renderer::render_page_async(const page *p, double xres, double yres, int x, int y, int w, int h, rotation_enum rotate, const partial_update_function &partial_update) const
+{
+    if (!p) {
+        return nullptr;
+    }
+
+    page_private *pp = page_private::get(p);
+    PDFDoc *pdfdoc = pp->doc->doc;
+    const int index = pp->index;
+
+    std::unique_ptr<render_output_dev> splashOutputDev = d->create_output_dev(pdfdoc);
+    if (!splashOutputDev) {
+        return nullptr;
+    }
+    splashOutputDev->partial_update = partial_update;
+
+    // the job is freed if the thread can't be started
+    std::unique_ptr<render_job> job(new render_job());
+    render_job_private *jd = job->d;
+    // the options are copied, so that this renderer can go away or change
+    // in the meantime
+    jd->thread = std::thread([jd, renderer = *d, output_dev = std::move(splashOutputDev), pdfdoc, index, xres, yres, x, y, w, h, rotate] {
+        auto img = std::make_unique<image>(renderer.render_page(output_dev.get(), pdfdoc, index, xres, yres, x, y, w, h, rotate, &jd->control));
+
+        std::unique_lock<std::mutex> locker(jd->mutex);
+        if (jd->control.canceled) {
+            jd->state = render_job::state_canceled;
+        } else if (jd->control.timed_out) {
+            jd->state = render_job::state_timed_out;
+        } else {
+            jd->state = render_job::state_done;
+            jd->result = std::move(img);
+        }
+        jd->finished.notify_all();
+    });
+    return job.release();
 }
 
 /**
@@ -301,3 +460,99 @@ bool page_renderer::can_render()
 {
     return true;
 }
+
+/**
+ \class poppler::render_job poppler-page-renderer.h "poppler/cpp/poppler-renderer.h"
+
+ A page being rendered in the background, as started by
+ page_renderer::render_page_async().
+
+ \since 22.01
+ */
+
+/**
+ \enum poppler::render_job::state_enum
+
+ The state of a %render_job.
+*/
+
+render_job::render_job() : d(new render_job_private()) { }
+
+/**
+ Destructor.
+
+ If the rendering is still going on, it is canceled first.
+ */
+render_job::~render_job()
+{
+    cancel();
+    if (d->thread.joinable()) {
+        d->thread.join();
+    }
+    delete d;
+}
+
+/**
+ \returns the current state of the job
+ */
+render_job::state_enum render_job::state() const
+{
+    std::unique_lock<std::mutex> locker(d->mutex);
+    return d->state;
+}
+
+/**
+ \returns whether the rendering is over, whatever its outcome
+ */
+bool render_job::is_finished() const
+{
+    return state() != state_running;
+}
+
+/**
+ Stop the rendering as soon as possible.
+
+ The job then ends in the \ref state_canceled state, unless it was already
+ over.
+ */
+void render_job::cancel()
+{
+    d->control.canceled = true;
+}
+
+/**
+ Wait for the rendering to be over.
+ */
+void render_job::wait() const
+{
+    std::unique_lock<std::mutex> locker(d->mutex);
+    d->finished.wait(locker, [this] { return d->state != state_running; });
+}
+
+/**
+ Wait for the rendering to be over, for at most the specified time.
+
+ \param msecs the maximum time to wait, in milliseconds
+
+ \returns whether the rendering is over
+ */
+bool render_job::wait_for(int msecs) const
+{
+    std::unique_lock<std::mutex> locker(d->mutex);
+    return d->finished.wait_for(locker, std::chrono::milliseconds(msecs), [this] { return d->state != state_running; });
+}
+
+/**
+ The rendered page.
+
+ This waits for the rendering to be over.
+
+ \returns the rendered image, or a null one if the rendering failed, was
+          canceled or timed out
+ */
+image render_job::result() const
+{
+    wait();
+    std::unique_lock<std::mutex> locker(d->mutex);
+    return d->result ? *d->result : image();
+}
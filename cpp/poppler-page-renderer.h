@@ -23,12 +23,16 @@
 #include "poppler-global.h"
 #include "poppler-image.h"
 
+#include <functional>
+
 namespace poppler {
 
 typedef unsigned int argb;
 
 class page;
 class page_renderer_private;
+class render_job;
+class render_job_private;
 
 class POPPLER_CPP_EXPORT page_renderer : public poppler::noncopyable
 {
@@ -47,6 +51,8 @@ public:
         line_shape
     };
 
+    typedef std::function<void(const image &img)> partial_update_function;
+
     page_renderer();
     ~page_renderer();
 
@@ -63,7 +69,12 @@ public:
     line_mode_enum line_mode() const;
     void set_line_mode(line_mode_enum mode);
 
+    int time_limit() const;
+    void set_time_limit(int msecs);
+
     image render_page(const page *p, double xres = 72.0, double yres = 72.0, int x = -1, int y = -1, int w = -1, int h = -1, rotation_enum rotate = rotate_0) const;
+    render_job *render_page_async(const page *p, double xres = 72.0, double yres = 72.0, int x = -1, int y = -1, int w = -1, int h = -1, rotation_enum rotate = rotate_0,
+                                  const partial_update_function &partial_update = partial_update_function()) const;
 
     static bool can_render();
 
@@ -72,6 +83,37 @@ private:
     friend class page_renderer_private;
 };
 
+class POPPLER_CPP_EXPORT render_job : public poppler::noncopyable
+{
+public:
+    enum state_enum
+    {
+        state_running,
+        state_done,
+        state_canceled,
+        state_timed_out
+    };
+
+    ~render_job();
+
+    state_enum state() const;
+    bool is_finished() const;
+
+    void cancel();
+
+    void wait() const;
+    bool wait_for(int msecs) const;
+
+    image result() const;
+
+private:
+    render_job();
+
+    render_job_private *d;
+    friend class page_renderer;
+    friend class render_job_private;
+};
+
 }
 
 #endif
@@ -0,0 +1,175 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/**
+ \file poppler-text-index.h
+ */
+#include "poppler-text-index.h"
+
+#include "poppler-document-private.h"
+
+#include <memory>
+
+#include "goo/GooString.h"
+#include "PDFDoc.h"
+#include "TextIndex.h"
+
+using namespace poppler;
+
+class poppler::text_index_private
+{
+public:
+    explicit text_index_private(std::unique_ptr<TextIndex> &&index_a) : index(std::move(index_a)) { }
+
+    std::unique_ptr<TextIndex> index;
+};
+
+/**
+ \class poppler::text_index poppler-text-index.h "poppler/cpp/poppler-text-index.h"
+
+ An index of the text of a %document, for searching it many times.
+
+ The pages are extracted once, when the index is created; the searches then
+ only look at the index, and an index can be saved to a file and loaded back
+ without the %document.
+
+ \since 22.01
+ */
+
+/**
+ \var poppler::text_index::hit::page_index
+
+ The index of the page of the hit, in the range [0, document::pages()[.
+ */
+
+/**
+ \var poppler::text_index::hit::rect
+
+ The area of the hit, in points, in the same coordinates as page::search()
+ with no rotation.
+ */
+
+text_index::text_index(text_index_private *dd) : d(dd) { }
+
+/**
+ Destructor.
+ */
+text_index::~text_index()
+{
+    delete d;
+}
+
+/**
+ \returns the index of the first page of the %document in the index
+ */
+int text_index::first_page() const
+{
+    return d->index->getFirstPage() - 1;
+}
+
+/**
+ \returns the number of pages in the index
+ */
+int text_index::pages() const
+{
+    return d->index->getNumPages();
+}
+
+/**
+ Searches the index.
+
+ The \p text is split on white space into terms: a page matches only if all
+ the terms occur on it, and there is one hit for each word touched by each
+ occurrence of each term, in page order.
+
+ \param text the text to search
+ \param case_sensitivity whether search in a case sensitive way
+ \param ignore_diacritics whether "e" also finds "é"; this applies only to
+                          the terms made of ASCII characters
+ \param whole_words whether the terms only match whole words
+ \returns the hits
+ */
+std::vector<text_index::hit> text_index::search(const ustring &text, case_sensitivity_enum case_sensitivity, bool ignore_diacritics, bool whole_words) const
+{
+    std::vector<hit> result;
+    const size_t len = text.length();
+    if (len == 0) {
+        return result;
+    }
+
+    std::vector<Unicode> u(len);
+    for (size_t i = 0; i < len; ++i) {
+        u[i] = text[i];
+    }
+
+    const std::vector<TextIndexHit> hits = d->index->find(u.data(), len, case_sensitivity == case_sensitive, ignore_diacritics, whole_words);
+    result.reserve(hits.size());
+    for (const TextIndexHit &h : hits) {
+        result.push_back({ h.page - 1, rectf(h.rect.x1, h.rect.y1, h.rect.x2 - h.rect.x1, h.rect.y2 - h.rect.y1) });
+    }
+    return result;
+}
+
+/**
+ Saves the index to the specified file.
+
+ \returns true on success, false on failure
+ */
+bool text_index::save(const std::string &file_name) const
+{
+    const GooString fname(file_name);
+    return d->index->save(&fname);
+}
+
+/**
+ Creates the index of some pages of a %document.
+
+ \note this extracts the text of all the pages, and can be slow for big
+       documents
+
+ \param doc the %document
+ \param first_page the index of the first page to index
+ \param last_page the index of the last page to index, or -1 for the last
+                  page of the %document
+ \returns a new index, or NULL if the %document is locked
+ */
+text_index *text_index::create(const document *doc, int first_page, int last_page)
+{
+    if (!doc || doc->is_locked()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<TextIndex> index = TextIndex::build(document_private::get(doc)->doc, first_page + 1, last_page < 0 ? -1 : last_page + 1);
+    if (!index) {
+        return nullptr;
+    }
+    return new text_index(new text_index_private(std::move(index)));
+}
+
+/**
+ Loads an index saved with save().
+
+ \returns a new index, or NULL if the file can't be read or is not an index
+ */
+text_index *text_index::load(const std::string &file_name)
+{
+    const GooString fname(file_name);
+    std::unique_ptr<TextIndex> index = TextIndex::load(&fname);
+    if (!index) {
+        return nullptr;
+    }
+    return new text_index(new text_index_private(std::move(index)));
+}
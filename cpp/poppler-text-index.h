@@ -0,0 +1,60 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef POPPLER_TEXT_INDEX_H
+#define POPPLER_TEXT_INDEX_H
+
+#include "poppler-global.h"
+#include "poppler-rectangle.h"
+
+#include <vector>
+
+namespace poppler {
+
+class document;
+class text_index_private;
+
+class POPPLER_CPP_EXPORT text_index : public poppler::noncopyable
+{
+public:
+    struct hit
+    {
+        int page_index;
+        rectf rect;
+    };
+
+    ~text_index();
+
+    int first_page() const;
+    int pages() const;
+
+    std::vector<hit> search(const ustring &text, case_sensitivity_enum case_sensitivity, bool ignore_diacritics = false, bool whole_words = false) const;
+
+    bool save(const std::string &file_name) const;
+
+    static text_index *create(const document *doc, int first_page = 0, int last_page = -1);
+    static text_index *load(const std::string &file_name);
+
+private:
+    explicit text_index(text_index_private *dd);
+
+    text_index_private *d;
+    friend class text_index_private;
+};
+
+}
+
+#endif
@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/**
+ \file poppler-tile-renderer.h
+ */
+#include "poppler-tile-renderer.h"
+
+#include "poppler-document-private.h"
+#include "poppler-page-private.h"
+#include "poppler-page-renderer-private.h"
+
+#include <memory>
+
+#include "PDFDoc.h"
+#include "SplashOutputDev.h"
+#include "SplashTileRenderer.h"
+#include "splash/SplashBitmap.h"
+
+using namespace poppler;
+
+// tiles kept by default, in bytes
+#define default_cache_size (64 * 1024 * 1024)
+
+class poppler::tile_renderer_private
+{
+public:
+    tile_renderer_private(const page_renderer_private *renderer, int tile_size);
+
+    std::vector<image> render_tiles(const page *p, double res, const std::vector<std::pair<int, int>> &tiles, rotation_enum rotate);
+
+    image::format_enum image_format;
+    int time_limit;
+    int tile_size;
+    PDFDoc *doc;
+    std::unique_ptr<SplashTileRenderer> tiles;
+};
+
+tile_renderer_private::tile_renderer_private(const page_renderer_private *renderer, int tile_size_a) : image_format(renderer->image_format), time_limit(renderer->time_limit), tile_size(tile_size_a), doc(nullptr) { }
+
+std::vector<image> tile_renderer_private::render_tiles(const page *p, double res, const std::vector<std::pair<int, int>> &tile_list, rotation_enum rotate)
+{
+    std::vector<image> images(tile_list.size());
+    if (!p || !tiles) {
+        return images;
+    }
+
+    page_private *pp = page_private::get(p);
+    if (pp->doc->doc != doc) {
+        return images;
+    }
+
+    render_control control;
+    if (time_limit >= 0) {
+        control.set_time_limit(time_limit);
+    }
+    const std::vector<std::shared_ptr<SplashBitmap>> bitmaps = tiles->renderTiles(pp->index + 1, res, int(rotate) * 90, tile_list, time_limit >= 0 ? &render_control::abort_check : nullptr, &control);
+    for (size_t i = 0; i < bitmaps.size(); ++i) {
+        SplashBitmap *bitmap = bitmaps[i].get();
+        if (bitmap) {
+            const image img(reinterpret_cast<char *>(bitmap->getDataPtr()), bitmap->getWidth(), bitmap->getHeight(), image_format);
+            images[i] = img.copy();
+        }
+    }
+    return images;
+}
+
+/**
+ \class poppler::tile_renderer poppler-tile-renderer.h "poppler/cpp/poppler-tile-renderer.h"
+
+ Renders the pages of a %document as square tiles, for viewers which show
+ only a part of a page at a time.
+
+ Tile (\em column, \em row) of a page covers the pixels starting at
+ (\em column * tile_size(), \em row * tile_size()); the tiles on the right
+ and bottom sides of the page are cut to the page size. The tiles are kept in
+ a cache, limited to cache_size() bytes, and the tiles asked for together
+ which are not in the cache are rendered in one go.
+
+ \since 22.01
+ */
+
+/**
+ Constructs a new %tile renderer.
+
+ \param doc the %document whose pages are rendered; it must be kept until the
+            renderer is deleted
+ \param renderer the renderer holding the rendering settings (paper color,
+                 hints, image format, line mode and time limit), which are
+                 copied
+ \param tile_size the width and height of the tiles, in pixels
+ */
+tile_renderer::tile_renderer(const document *doc, const page_renderer &renderer, int tile_size) : d(new tile_renderer_private(page_renderer_private::get(&renderer), tile_size))
+{
+    if (!doc || doc->is_locked() || tile_size <= 0) {
+        return;
+    }
+
+    d->doc = document_private::get(doc)->doc;
+    std::unique_ptr<render_output_dev> output_dev = page_renderer_private::get(&renderer)->create_output_dev(d->doc);
+    if (output_dev) {
+        d->tiles = std::make_unique<SplashTileRenderer>(d->doc, std::move(output_dev), tile_size, default_cache_size);
+    }
+}
+
+/**
+ Destructor.
+ */
+tile_renderer::~tile_renderer()
+{
+    delete d;
+}
+
+/**
+ \returns the width and height of the tiles, in pixels
+ */
+int tile_renderer::tile_size() const
+{
+    return d->tile_size;
+}
+
+/**
+ The maximum memory used by the cached tiles.
+
+ By default it is 64 MB.
+
+ \returns the cache size, in bytes
+ */
+size_t tile_renderer::cache_size() const
+{
+    return d->tiles ? d->tiles->getCache()->getMaxSize() : 0;
+}
+
+/**
+ Set the maximum memory used by the cached tiles.
+
+ The least recently used tiles are dropped first.
+
+ \param bytes the new cache size, in bytes
+ */
+void tile_renderer::set_cache_size(size_t bytes)
+{
+    if (d->tiles) {
+        d->tiles->getCache()->setMaxSize(bytes);
+    }
+}
+
+/**
+ Drop all the cached tiles.
+ */
+void tile_renderer::clear_cache()
+{
+    if (d->tiles) {
+        d->tiles->getCache()->clear();
+    }
+}
+
+/**
+ Render a tile of a page.
+
+ \param p the page, of the %document of the renderer
+ \param res the resolution, in dot per inch (DPI)
+ \param column the column of the tile
+ \param row the row of the tile
+ \param rotate the rotation to apply when rendering the page
+
+ \returns the rendered tile, or a null image if the tile is outside of the
+          page, or in case of errors
+ */
+image tile_renderer::render_tile(const page *p, double res, int column, int row, rotation_enum rotate) const
+{
+    return d->render_tiles(p, res, std::vector<std::pair<int, int>> { { column, row } }, rotate)[0];
+}
+
+/**
+ Render several tiles of a page.
+
+ \param p the page, of the %document of the renderer
+ \param res the resolution, in dot per inch (DPI)
+ \param tiles the columns and rows of the tiles
+ \param rotate the rotation to apply when rendering the page
+
+ \returns the rendered tiles, in the order of \p tiles; the tiles outside of
+          the page, and the ones which could not be rendered, are null images
+ */
+std::vector<image> tile_renderer::render_tiles(const page *p, double res, const std::vector<std::pair<int, int>> &tiles, rotation_enum rotate) const
+{
+    return d->render_tiles(p, res, tiles, rotate);
+}
@@ -0,0 +1,54 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef POPPLER_TILE_RENDERER_H
+#define POPPLER_TILE_RENDERER_H
+
+#include "poppler-global.h"
+#include "poppler-image.h"
+
+#include <utility>
+
+namespace poppler {
+
+class document;
+class page;
+class page_renderer;
+class tile_renderer_private;
+
+class POPPLER_CPP_EXPORT tile_renderer : public poppler::noncopyable
+{
+public:
+    tile_renderer(const document *doc, const page_renderer &renderer, int tile_size = 256);
+    ~tile_renderer();
+
+    int tile_size() const;
+
+    size_t cache_size() const;
+    void set_cache_size(size_t bytes);
+    void clear_cache();
+
+    image render_tile(const page *p, double res, int column, int row, rotation_enum rotate = rotate_0) const;
+    std::vector<image> render_tiles(const page *p, double res, const std::vector<std::pair<int, int>> &tiles, rotation_enum rotate = rotate_0) const;
+
+private:
+    tile_renderer_private *d;
+    friend class tile_renderer_private;
+};
+
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checks document_renderer: the pages rendered on several threads must be
+ * passed in order, be the same as the ones rendered one by one, and an
+ * exception thrown by the page callback must reach the caller.
+ */
+
+#include <poppler-document.h>
+#include <poppler-document-renderer.h>
+#include <poppler-image.h>
+#include <poppler-page.h>
+#include <poppler-page-renderer.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test-pdf-writer.h"
+
+static const int num_pages = 12;
+
+// A document whose pages all look different: a gray rectangle, moving
+// and getting darker from one page to the next.
+static std::string make_test_pdf()
+{
+    TestPDFWriter writer;
+    std::string kids;
+    for (int i = 0; i < num_pages; ++i) {
+        kids += std::to_string(3 + 2 * i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(num_pages) + " >>");
+    for (int i = 0; i < num_pages; ++i) {
+        char content[128];
+        snprintf(content, sizeof(content), "%.3f g %d %d 40 30 re f", 1.0 - (i + 1) / (num_pages + 1.0), 5 * i, 8 * i);
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 120 160 ] /Contents " + std::to_string(4 + 2 * i) + " 0 R >>");
+        writer.addStream("", content);
+    }
+    return writer.finish();
+}
+
+static bool same_image(const poppler::image &a, const poppler::image &b)
+{
+    if (!a.is_valid() || !b.is_valid() || a.width() != b.width() || a.height() != b.height() || a.format() != b.format()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.const_data() + y * a.bytes_per_row(), b.const_data() + y * b.bytes_per_row(), a.width() * 4) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    if (!poppler::page_renderer::can_render()) {
+        return 0;
+    }
+
+    const std::string pdf = make_test_pdf();
+    std::unique_ptr<poppler::document> doc(poppler::document::load_from_raw_data(pdf.data(), pdf.size()));
+    if (!doc || doc->pages() != num_pages) {
+        std::cerr << "Error loading the generated document" << std::endl;
+        return 1;
+    }
+
+    poppler::page_renderer renderer;
+    std::vector<poppler::image> expected;
+    for (int i = 0; i < num_pages; ++i) {
+        std::unique_ptr<poppler::page> p(doc->create_page(i));
+        expected.push_back(renderer.render_page(p.get()));
+    }
+    int errors = 0;
+    for (int i = 1; i < num_pages; ++i) {
+        if (same_image(expected[i - 1], expected[i])) {
+            std::cerr << "pages " << i - 1 << " and " << i << " look the same" << std::endl;
+            ++errors;
+        }
+    }
+
+    poppler::document_renderer doc_renderer;
+    for (unsigned int threads : { 1u, 2u, 4u }) {
+        doc_renderer.set_thread_count(threads);
+        int next = 2;
+        doc_renderer.render_pages(doc.get(), 2, num_pages - 1, renderer, [&](int index, const poppler::image &img) {
+            if (index != next) {
+                std::cerr << threads << " threads: got page " << index << " instead of " << next << std::endl;
+                ++errors;
+            } else if (!same_image(img, expected[index])) {
+                std::cerr << threads << " threads: page " << index << " differs" << std::endl;
+                ++errors;
+            }
+            next = index + 1;
+        });
+        if (next != num_pages) {
+            std::cerr << threads << " threads: stopped before page " << next << std::endl;
+            ++errors;
+        }
+    }
+
+    // the convenience overload
+    doc_renderer.set_thread_count(3);
+    const std::vector<poppler::image> images = doc_renderer.render_pages(doc.get(), 0, num_pages - 1, renderer);
+    if (images.size() != expected.size()) {
+        std::cerr << "got " << images.size() << " images instead of " << expected.size() << std::endl;
+        ++errors;
+    } else {
+        for (int i = 0; i < num_pages; ++i) {
+            if (!same_image(images[i], expected[i])) {
+                std::cerr << "image " << i << " differs" << std::endl;
+                ++errors;
+            }
+        }
+    }
+
+    // an exception thrown by the callback stops the rendering, and is
+    // passed on once the workers are done
+    doc_renderer.set_thread_count(4);
+    int calls = 0;
+    try {
+        doc_renderer.render_pages(doc.get(), 0, num_pages - 1, renderer, [&calls](int index, const poppler::image &) {
+            ++calls;
+            if (index == 3) {
+                throw std::runtime_error("stop");
+            }
+        });
+        std::cerr << "the exception of the callback was lost" << std::endl;
+        ++errors;
+    } catch (const std::runtime_error &) {
+        if (calls != 4) {
+            std::cerr << "the callback was called " << calls << " times instead of 4" << std::endl;
+            ++errors;
+        }
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checks page_renderer::render_page_async(): a finished job must give the
+ * same page as render_page(), with partial updates along the way and the
+ * whole page last; a job canceled or running out of time in the middle of
+ * the page must end in the matching state, without an image.
+ *
+ * The page has enough operators for Gfx to send partial updates while
+ * rendering it, and the update callback holds the rendering thread, so
+ * that the job is always stopped in the middle of the page.
+ */
+
+#include <poppler-document.h>
+#include <poppler-image.h>
+#include <poppler-page.h>
+#include <poppler-page-renderer.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "test-pdf-writer.h"
+
+// Gfx sends a partial update every 20000 operators
+static const int num_rects = 50000;
+
+// A one page document with num_rects small rectangles, two operators each.
+static std::string make_test_pdf()
+{
+    std::string content;
+    char buf[64];
+    for (int i = 0; i < num_rects; ++i) {
+        snprintf(buf, sizeof(buf), "%d %d 3 3 re f\n", (i * 7) % 97, (i * 13) % 97);
+        content += buf;
+    }
+
+    TestPDFWriter writer;
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ 3 0 R ] /Count 1 >>");
+    writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 100 100 ] /Contents 4 0 R >>");
+    writer.addStream("", content);
+    return writer.finish();
+}
+
+static bool same_image(const poppler::image &a, const poppler::image &b)
+{
+    if (!a.is_valid() || !b.is_valid() || a.width() != b.width() || a.height() != b.height() || a.format() != b.format()) {
+        return false;
+    }
+    for (int y = 0; y < a.height(); ++y) {
+        if (memcmp(a.const_data() + y * a.bytes_per_row(), b.const_data() + y * b.bytes_per_row(), a.width() * 4) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Holds the rendering thread in its first partial update until release().
+class update_gate
+{
+public:
+    void update()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        if (updates++ == 0) {
+            changed.notify_all();
+            changed.wait(locker, [this] { return released; });
+        }
+    }
+
+    void wait_for_update()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        changed.wait(locker, [this] { return updates > 0; });
+    }
+
+    void release()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        released = true;
+        changed.notify_all();
+    }
+
+    int update_count()
+    {
+        std::unique_lock<std::mutex> locker(mutex);
+        return updates;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    int updates = 0;
+    bool released = false;
+};
+
+static int check_finished(const poppler::page_renderer &renderer, const poppler::page *p, int *updates_out)
+{
+    const poppler::image expected = renderer.render_page(p);
+
+    int updates = 0;
+    poppler::image last_update;
+    std::unique_ptr<poppler::render_job> job(renderer.render_page_async(p, 72, 72, -1, -1, -1, -1, poppler::rotate_0, [&](const poppler::image &img) {
+        ++updates;
+        last_update = img.copy();
+    }));
+    if (!job) {
+        std::cerr << "finished job: render_page_async() failed" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    if (!job->wait_for(60000) || !job->is_finished() || job->state() != poppler::render_job::state_done) {
+        std::cerr << "finished job: wrong state " << job->state() << std::endl;
+        return 1;
+    }
+    if (!same_image(job->result(), expected)) {
+        std::cerr << "finished job: the result differs from render_page()" << std::endl;
+        ++errors;
+    }
+    // the page is over 20000 operators, so there is at least one update
+    // before the final one
+    if (updates < 2 || !same_image(last_update, expected)) {
+        std::cerr << "finished job: wrong partial updates (" << updates << ")" << std::endl;
+        ++errors;
+    }
+    *updates_out = updates;
+
+    // canceling a finished job changes nothing
+    job->cancel();
+    if (job->state() != poppler::render_job::state_done || !job->result().is_valid()) {
+        std::cerr << "finished job: canceled after the end" << std::endl;
+        ++errors;
+    }
+    return errors;
+}
+
+static int check_canceled(const poppler::page_renderer &renderer, const poppler::page *p, int full_updates)
+{
+    update_gate gate;
+    std::unique_ptr<poppler::render_job> job(renderer.render_page_async(p, 72, 72, -1, -1, -1, -1, poppler::rotate_0, [&](const poppler::image &) { gate.update(); }));
+    if (!job) {
+        std::cerr << "canceled job: render_page_async() failed" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    gate.wait_for_update();
+    if (job->wait_for(10) || job->is_finished()) {
+        std::cerr << "canceled job: over while held in the middle of the page" << std::endl;
+        ++errors;
+    }
+    job->cancel();
+    gate.release();
+    if (!job->wait_for(60000) || job->state() != poppler::render_job::state_canceled) {
+        std::cerr << "canceled job: wrong state " << job->state() << std::endl;
+        return errors + 1;
+    }
+    if (job->result().is_valid()) {
+        std::cerr << "canceled job: got an image" << std::endl;
+        ++errors;
+    }
+    // the rendering stopped before the updates of the rest of the page
+    if (gate.update_count() >= full_updates) {
+        std::cerr << "canceled job: rendered to the end" << std::endl;
+        ++errors;
+    }
+    return errors;
+}
+
+static int check_timed_out(const poppler::page_renderer &renderer, const poppler::page *p)
+{
+    poppler::page_renderer limited_renderer;
+    limited_renderer.set_time_limit(50);
+    update_gate gate;
+    std::unique_ptr<poppler::render_job> job(limited_renderer.render_page_async(p, 72, 72, -1, -1, -1, -1, poppler::rotate_0, [&](const poppler::image &) { gate.update(); }));
+    if (!job) {
+        std::cerr << "timed out job: render_page_async() failed" << std::endl;
+        return 1;
+    }
+
+    // the limit applies to the job, not to the renderer it came from
+    limited_renderer.set_time_limit(-1);
+
+    gate.wait_for_update();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    gate.release();
+    job->wait();
+    if (job->state() != poppler::render_job::state_timed_out || job->result().is_valid()) {
+        std::cerr << "timed out job: wrong state " << job->state() << std::endl;
+        return 1;
+    }
+
+    // without a limit, the same page renders
+    std::unique_ptr<poppler::render_job> unlimited(renderer.render_page_async(p));
+    if (!unlimited || !unlimited->result().is_valid() || unlimited->state() != poppler::render_job::state_done) {
+        std::cerr << "job without a time limit failed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main()
+{
+    if (!poppler::page_renderer::can_render()) {
+        return 0;
+    }
+
+    const std::string pdf = make_test_pdf();
+    std::unique_ptr<poppler::document> doc(poppler::document::load_from_raw_data(pdf.data(), pdf.size()));
+    std::unique_ptr<poppler::page> p(doc ? doc->create_page(0) : nullptr);
+    if (!p) {
+        std::cerr << "Error loading the generated document" << std::endl;
+        return 1;
+    }
+
+    poppler::page_renderer renderer;
+    int full_updates = 0;
+    int errors = check_finished(renderer, p.get(), &full_updates);
+    errors += check_canceled(renderer, p.get(), full_updates);
+    errors += check_timed_out(renderer, p.get());
+
+    // deleting a running job stops it
+    std::unique_ptr<poppler::render_job> job(renderer.render_page_async(p.get()));
+    job.reset();
+
+    if (renderer.render_page_async(nullptr)) {
+        std::cerr << "render_page_async() accepted a null page" << std::endl;
+        ++errors;
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checks text_index: its hits must be on the pages page::search() finds,
+ * at the same places, and the same once the index is saved to the file
+ * given as argument and loaded back.
+ */
+
+#include <poppler-document.h>
+#include <poppler-page.h>
+#include <poppler-text-index.h>
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "test-pdf-writer.h"
+
+static const char *const page_contents[] = { "BT /F1 24 Tf 72 700 Td (Hello World) Tj ET", "BT /F1 24 Tf 72 600 Td (nothing here) Tj ET", "BT /F1 24 Tf 200 300 Td (hello again) Tj ET" };
+static const int num_pages = sizeof(page_contents) / sizeof(page_contents[0]);
+
+static std::string make_test_pdf()
+{
+    TestPDFWriter writer;
+    std::string kids;
+    for (int i = 0; i < num_pages; ++i) {
+        kids += std::to_string(4 + 2 * i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(num_pages) + " >>");
+    writer.addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    for (int i = 0; i < num_pages; ++i) {
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 612 792 ] /Contents " + std::to_string(5 + 2 * i) + " 0 R /Resources << /Font << /F1 3 0 R >> >> >>");
+        writer.addStream("", page_contents[i]);
+    }
+    return writer.finish();
+}
+
+static bool same_rect(const poppler::rectf &a, const poppler::rectf &b)
+{
+    return std::fabs(a.left() - b.left()) < 0.01 && std::fabs(a.top() - b.top()) < 0.01 && std::fabs(a.right() - b.right()) < 0.01 && std::fabs(a.bottom() - b.bottom()) < 0.01;
+}
+
+// Compares the hits of index for text with page::search() on each page.
+static int check_search(const poppler::document *doc, const poppler::text_index *index, const char *text, const char *what)
+{
+    const poppler::ustring utext = poppler::ustring::from_utf8(text);
+    const std::vector<poppler::text_index::hit> hits = index->search(utext, poppler::case_insensitive);
+    int errors = 0;
+    size_t next = 0;
+    for (int i = 0; i < num_pages; ++i) {
+        std::unique_ptr<poppler::page> p(doc->create_page(i));
+        poppler::rectf r;
+        bool found = p->search(utext, r, poppler::page::search_from_top, poppler::case_insensitive);
+        while (found) {
+            if (next >= hits.size() || hits[next].page_index != i || !same_rect(hits[next].rect, r)) {
+                std::cerr << what << ": wrong hit for \"" << text << "\" on page " << i << std::endl;
+                return errors + 1;
+            }
+            ++next;
+            found = p->search(utext, r, poppler::page::search_next_result, poppler::case_insensitive);
+        }
+    }
+    if (next != hits.size()) {
+        std::cerr << what << ": too many hits for \"" << text << "\"" << std::endl;
+        ++errors;
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " index-file" << std::endl;
+        return 1;
+    }
+    const std::string file_name = argv[1];
+
+    const std::string pdf = make_test_pdf();
+    std::unique_ptr<poppler::document> doc(poppler::document::load_from_raw_data(pdf.data(), pdf.size()));
+    if (!doc) {
+        std::cerr << "Error loading the generated document" << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<poppler::text_index> index(poppler::text_index::create(doc.get()));
+    if (!index || index->first_page() != 0 || index->pages() != num_pages) {
+        std::cerr << "text_index::create() failed" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    for (const char *text : { "hello", "world", "here", "missing" }) {
+        errors += check_search(doc.get(), index.get(), text, "created index");
+    }
+
+    std::unique_ptr<poppler::text_index> range(poppler::text_index::create(doc.get(), 1, 2));
+    const std::vector<poppler::text_index::hit> range_hits = range ? range->search(poppler::ustring::from_utf8("hello"), poppler::case_insensitive) : std::vector<poppler::text_index::hit>();
+    if (!range || range->first_page() != 1 || range->pages() != 2 || range_hits.size() != 1 || range_hits[0].page_index != 2) {
+        std::cerr << "wrong index of the pages 1 to 2" << std::endl;
+        ++errors;
+    }
+
+    if (!index->save(file_name)) {
+        std::cerr << "text_index::save() failed" << std::endl;
+        return 1;
+    }
+    std::unique_ptr<poppler::text_index> loaded(poppler::text_index::load(file_name));
+    remove(file_name.c_str());
+    if (!loaded || loaded->pages() != num_pages) {
+        std::cerr << "text_index::load() failed" << std::endl;
+        return 1;
+    }
+    for (const char *text : { "hello", "world", "here", "missing" }) {
+        errors += check_search(doc.get(), loaded.get(), text, "loaded index");
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checks tile_renderer: each tile must be the same as the matching part of
+ * the page rendered by page_renderer, whether it comes from the cache or
+ * not, and at any rotation.
+ */
+
+#include <poppler-document.h>
+#include <poppler-image.h>
+#include <poppler-page.h>
+#include <poppler-page-renderer.h>
+#include <poppler-tile-renderer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test-pdf-writer.h"
+
+static const int tile_size = 64;
+
+// A one page document with shapes crossing the tile edges.
+static std::string make_test_pdf()
+{
+    const std::string content = "0.2 0.4 0.8 rg 10 10 190 120 re f "
+                                "1 0 0 RG 3 w 0 0 m 200 150 l S "
+                                "0 0.6 0 rg 150 75 m 100 140 l 50 75 l f";
+    TestPDFWriter writer;
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ 3 0 R ] /Count 1 >>");
+    writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 200 150 ] /Contents 4 0 R >>");
+    writer.addStream("", content);
+    return writer.finish();
+}
+
+// Compares tile (col, row) with the matching part of page.
+static bool check_tile(const poppler::image &tile, const poppler::image &page, int col, int row)
+{
+    const int x = col * tile_size;
+    const int y = row * tile_size;
+    if (!tile.is_valid() || tile.format() != page.format() || tile.width() != std::min(tile_size, page.width() - x) || tile.height() != std::min(tile_size, page.height() - y)) {
+        return false;
+    }
+    for (int i = 0; i < tile.height(); ++i) {
+        if (memcmp(tile.const_data() + i * tile.bytes_per_row(), page.const_data() + (y + i) * page.bytes_per_row() + x * 4, tile.width() * 4) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Renders the tiles of p at all the rotations, and compares them with the
+// whole page.
+static int check_tiles(const poppler::tile_renderer &tiles, const poppler::page_renderer &renderer, const poppler::page *p, bool antialias)
+{
+    int errors = 0;
+    for (const poppler::rotation_enum rotate : { poppler::rotate_0, poppler::rotate_90, poppler::rotate_180, poppler::rotate_270 }) {
+        for (const double res : { 72.0, 100.0, 150.0 }) {
+            const poppler::image page = renderer.render_page(p, res, res, -1, -1, -1, -1, rotate);
+            const int cols = (page.width() + tile_size - 1) / tile_size;
+            const int rows = (page.height() + tile_size - 1) / tile_size;
+
+            // all the tiles at once, a few outside of the page, and then
+            // again one by one, from the cache
+            std::vector<std::pair<int, int>> list;
+            for (int row = -1; row <= rows; ++row) {
+                for (int col = -1; col <= cols; ++col) {
+                    list.emplace_back(col, row);
+                }
+            }
+            for (int pass = 0; pass < 2; ++pass) {
+                std::vector<poppler::image> images;
+                if (pass == 0) {
+                    images = tiles.render_tiles(p, res, list, rotate);
+                } else {
+                    for (const std::pair<int, int> &tile : list) {
+                        images.push_back(tiles.render_tile(p, res, tile.first, tile.second, rotate));
+                    }
+                }
+                for (size_t i = 0; i < list.size(); ++i) {
+                    const int col = list[i].first;
+                    const int row = list[i].second;
+                    const bool inside = col >= 0 && col < cols && row >= 0 && row < rows;
+                    if (inside ? !check_tile(images[i], page, col, row) : images[i].is_valid()) {
+                        std::cerr << (antialias ? "antialiased, " : "") << "rotation " << rotate << ", " << res << " dpi, pass " << pass << ": wrong tile (" << col << ", " << row << ")" << std::endl;
+                        ++errors;
+                    }
+                }
+            }
+        }
+    }
+
+    return errors;
+}
+
+int main()
+{
+    if (!poppler::page_renderer::can_render()) {
+        return 0;
+    }
+
+    const std::string pdf = make_test_pdf();
+    std::unique_ptr<poppler::document> doc(poppler::document::load_from_raw_data(pdf.data(), pdf.size()));
+    std::unique_ptr<poppler::page> p(doc ? doc->create_page(0) : nullptr);
+    if (!p) {
+        std::cerr << "Error loading the generated document" << std::endl;
+        return 1;
+    }
+
+    int errors = 0;
+    for (const bool antialias : { false, true }) {
+        poppler::page_renderer renderer;
+        renderer.set_render_hint(poppler::page_renderer::antialiasing, antialias);
+        poppler::tile_renderer tiles(doc.get(), renderer, tile_size);
+        if (tiles.tile_size() != tile_size) {
+            std::cerr << "wrong tile size " << tiles.tile_size() << std::endl;
+            return 1;
+        }
+        errors += check_tiles(tiles, renderer, p.get(), antialias);
+    }
+
+    poppler::page_renderer renderer;
+    renderer.set_render_hint(poppler::page_renderer::antialiasing);
+    poppler::tile_renderer tiles(doc.get(), renderer, tile_size);
+
+    // scattered tiles are rendered one by one, with an empty cache
+    tiles.clear_cache();
+    const poppler::image page = renderer.render_page(p.get(), 150, 150);
+    const std::vector<std::pair<int, int>> corners { { 0, 0 }, { (page.width() - 1) / tile_size, (page.height() - 1) / tile_size } };
+    const std::vector<poppler::image> images = tiles.render_tiles(p.get(), 150, corners);
+    for (size_t i = 0; i < corners.size(); ++i) {
+        if (!check_tile(images[i], page, corners[i].first, corners[i].second)) {
+            std::cerr << "wrong scattered tile " << i << std::endl;
+            ++errors;
+        }
+    }
+
+    tiles.set_cache_size(12345);
+    if (tiles.cache_size() != 12345) {
+        std::cerr << "wrong cache size " << tiles.cache_size() << std::endl;
+        ++errors;
+    }
+
+    return errors ? 1 : 0;
+}
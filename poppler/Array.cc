@@ -31,6 +31,7 @@
 
 #include "Object.h"
 #include "Array.h"
+#include "ObjectPool.h"
 
 //------------------------------------------------------------------------
 // Array
@@ -46,6 +47,23 @@ Array::Array(XRef *xrefA)
 
 Array::~Array() { }
 
+void *Array::operator new(size_t size)
+{
+    if (size != sizeof(Array)) {
+        return ::operator new(size);
+    }
+    return ObjectPool<Array>::allocate();
+}
+
+void Array::operator delete(void *p, size_t size)
+{
+    if (size != sizeof(Array)) {
+        ::operator delete(p);
+        return;
+    }
+    ObjectPool<Array>::release(p);
+}
+
 Array *Array::copy(XRef *xrefA) const
 {
     arrayLocker();
@@ -74,6 +92,12 @@ void Array::add(Object &&elem)
     elems.push_back(std::move(elem));
 }
 
+void Array::reserve(int n)
+{
+    arrayLocker();
+    elems.reserve(n);
+}
+
 void Array::remove(int i)
 {
     arrayLocker();
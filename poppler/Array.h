@@ -54,6 +54,10 @@ public:
     Array(const Array &) = delete;
     Array &operator=(const Array &) = delete;
 
+    // Arrays are allocated from a per-thread pool (see ObjectPool).
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     // Get number of elements.
     int getLength() const { return elems.size(); }
 
@@ -66,6 +70,9 @@ public:
     // elem becomes a dead object after this call
     void add(Object &&elem);
 
+    // Make room for <n> elements.
+    void reserve(int n);
+
     // Remove an element by position
     void remove(int i);
 
@@ -0,0 +1,99 @@
+//========================================================================
+//
+// Atom.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstring>
+
+#include "Atom.h"
+
+//------------------------------------------------------------------------
+
+const char atomTable[][atomMaxLength] = {
+#define POPPLER_ATOM_NAME(id, name) name,
+    POPPLER_NAMED_ATOMS(POPPLER_ATOM_NAME)
+#undef POPPLER_ATOM_NAME
+
+    // content stream operators which aren't also keys
+    "\"", "'", "B", "B*", "BDC", "BI", "BMC", "BT", "BX", "Do", "EI", "EMC", "ET", "EX", "J", "MP", "Q", "RG", "SC", "SCN", "T*", "TD", "TJ", "TL", "Tc", "Td", "Tf", "Tj", "Tm", "Tr", "Ts", "Tw", "Tz", "W*", "b", "b*", "c", "cm", "cs", "d", "d0", "d1", "f",
+    "f*", "g", "gs", "h", "i", "j", "k", "l", "m", "n", "q", "re", "rg", "ri", "s", "sc", "scn", "sh", "v", "w", "y",
+
+    // other commands
+    "[", "]", "<<", ">>", "obj", "endobj", "stream", "endstream", "xref", "trailer", "startxref"
+};
+
+const int numAtoms = sizeof(atomTable) / sizeof(atomTable[0]);
+
+//------------------------------------------------------------------------
+
+// number of slots in the hash table; more than twice the number of
+// atoms, to keep the probe sequences short
+#define atomHashSize 1024
+
+static inline unsigned int hashAtomChar(unsigned int h, unsigned char c)
+{
+    return (h ^ c) * 16777619u;
+}
+
+namespace {
+
+class AtomHash
+{
+public:
+    AtomHash()
+    {
+        for (short &slot : slots) {
+            slot = -1;
+        }
+        for (int atom = 0; atom < numAtoms; ++atom) {
+            unsigned int h = 2166136261u;
+            for (const char *p = atomTable[atom]; *p; ++p) {
+                h = hashAtomChar(h, *p);
+            }
+            unsigned int i = h % atomHashSize;
+            // if a name appears twice in the table, the first one wins
+            while (slots[i] >= 0 && strcmp(atomTable[slots[i]], atomTable[atom])) {
+                i = (i + 1) % atomHashSize;
+            }
+            if (slots[i] < 0) {
+                slots[i] = atom;
+            }
+        }
+    }
+
+    Atom find(const char *name) const
+    {
+        unsigned int h = 2166136261u;
+        const char *p = name;
+        for (; *p; ++p) {
+            if (p - name == atomMaxLength - 1) {
+                return atomNone;
+            }
+            h = hashAtomChar(h, *p);
+        }
+        const size_t length = p - name;
+        for (unsigned int i = h % atomHashSize; slots[i] >= 0; i = (i + 1) % atomHashSize) {
+            const char *atomName = atomTable[slots[i]];
+            if (!memcmp(atomName, name, length) && !atomName[length]) {
+                return static_cast<Atom>(slots[i]);
+            }
+        }
+        return atomNone;
+    }
+
+private:
+    short slots[atomHashSize];
+};
+
+}
+
+Atom findAtom(const char *name)
+{
+    static const AtomHash hash;
+    return hash.find(name);
+}
@@ -0,0 +1,315 @@
+//========================================================================
+//
+// Atom.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef ATOM_H
+#define ATOM_H
+
+#include <cstdint>
+
+#include "poppler_private_export.h"
+
+//------------------------------------------------------------------------
+// Atoms
+//
+// The names that show up over and over in PDF files (the standard
+// dictionary keys and values, the content stream operators) are kept,
+// once, in a read-only table.  The index of a name in that table is its
+// atom.  Name and command Objects for those names point into the table
+// instead of owning a copy of the string, and Dict compares the atoms
+// of its keys instead of the strings.  The table never changes, so it
+// can be used from any thread without locking.  Names outside of the
+// table have no atom (atomNone).
+//------------------------------------------------------------------------
+
+// The atoms that can be named in the code: X(identifier, name).
+#define POPPLER_NAMED_ATOMS(X)                                                                                                                                                                                                                 \
+    X(A, "A")                                                                                                                                                                                                                                  \
+    X(AA, "AA")                                                                                                                                                                                                                                \
+    X(AIS, "AIS")                                                                                                                                                                                                                              \
+    X(AP, "AP")                                                                                                                                                                                                                                \
+    X(AS, "AS")                                                                                                                                                                                                                                \
+    X(AcroForm, "AcroForm")                                                                                                                                                                                                                    \
+    X(Alternate, "Alternate")                                                                                                                                                                                                                  \
+    X(Annot, "Annot")                                                                                                                                                                                                                          \
+    X(Annots, "Annots")                                                                                                                                                                                                                        \
+    X(ArtBox, "ArtBox")                                                                                                                                                                                                                        \
+    X(Ascent, "Ascent")                                                                                                                                                                                                                        \
+    X(BBox, "BBox")                                                                                                                                                                                                                            \
+    X(BC, "BC")                                                                                                                                                                                                                                \
+    X(BE, "BE")                                                                                                                                                                                                                                \
+    X(BG, "BG")                                                                                                                                                                                                                                \
+    X(BG2, "BG2")                                                                                                                                                                                                                              \
+    X(BM, "BM")                                                                                                                                                                                                                                \
+    X(BPC, "BPC")                                                                                                                                                                                                                              \
+    X(BS, "BS")                                                                                                                                                                                                                                \
+    X(Background, "Background")                                                                                                                                                                                                                \
+    X(BaseEncoding, "BaseEncoding")                                                                                                                                                                                                            \
+    X(BaseFont, "BaseFont")                                                                                                                                                                                                                    \
+    X(BitsPerComponent, "BitsPerComponent")                                                                                                                                                                                                    \
+    X(BlackIs1, "BlackIs1")                                                                                                                                                                                                                    \
+    X(BleedBox, "BleedBox")                                                                                                                                                                                                                    \
+    X(Border, "Border")                                                                                                                                                                                                                        \
+    X(Bounds, "Bounds")                                                                                                                                                                                                                        \
+    X(C, "C")                                                                                                                                                                                                                                  \
+    X(C0, "C0")                                                                                                                                                                                                                                \
+    X(C1, "C1")                                                                                                                                                                                                                                \
+    X(CA, "CA")                                                                                                                                                                                                                                \
+    X(CCITTFaxDecode, "CCITTFaxDecode")                                                                                                                                                                                                        \
+    X(CF, "CF")                                                                                                                                                                                                                                \
+    X(CFM, "CFM")                                                                                                                                                                                                                              \
+    X(CIDFontType0, "CIDFontType0")                                                                                                                                                                                                            \
+    X(CIDFontType0C, "CIDFontType0C")                                                                                                                                                                                                          \
+    X(CIDFontType2, "CIDFontType2")                                                                                                                                                                                                            \
+    X(CIDSystemInfo, "CIDSystemInfo")                                                                                                                                                                                                          \
+    X(CIDToGIDMap, "CIDToGIDMap")                                                                                                                                                                                                              \
+    X(CMYK, "CMYK")                                                                                                                                                                                                                            \
+    X(CS, "CS")                                                                                                                                                                                                                                \
+    X(CalGray, "CalGray")                                                                                                                                                                                                                      \
+    X(CalRGB, "CalRGB")                                                                                                                                                                                                                        \
+    X(CapHeight, "CapHeight")                                                                                                                                                                                                                  \
+    X(Catalog, "Catalog")                                                                                                                                                                                                                      \
+    X(CharProcs, "CharProcs")                                                                                                                                                                                                                  \
+    X(ColorSpace, "ColorSpace")                                                                                                                                                                                                                \
+    X(ColorTransform, "ColorTransform")                                                                                                                                                                                                        \
+    X(Colors, "Colors")                                                                                                                                                                                                                        \
+    X(Columns, "Columns")                                                                                                                                                                                                                      \
+    X(Contents, "Contents")                                                                                                                                                                                                                    \
+    X(Coords, "Coords")                                                                                                                                                                                                                        \
+    X(Count, "Count")                                                                                                                                                                                                                          \
+    X(CreationDate, "CreationDate")                                                                                                                                                                                                            \
+    X(Creator, "Creator")                                                                                                                                                                                                                      \
+    X(CropBox, "CropBox")                                                                                                                                                                                                                      \
+    X(Crypt, "Crypt")                                                                                                                                                                                                                          \
+    X(D, "D")                                                                                                                                                                                                                                  \
+    X(DA, "DA")                                                                                                                                                                                                                                \
+    X(DCTDecode, "DCTDecode")                                                                                                                                                                                                                  \
+    X(DP, "DP")                                                                                                                                                                                                                                \
+    X(DR, "DR")                                                                                                                                                                                                                                \
+    X(DW, "DW")                                                                                                                                                                                                                                \
+    X(DW2, "DW2")                                                                                                                                                                                                                              \
+    X(Decode, "Decode")                                                                                                                                                                                                                        \
+    X(DecodeParms, "DecodeParms")                                                                                                                                                                                                              \
+    X(DescendantFonts, "DescendantFonts")                                                                                                                                                                                                      \
+    X(Descent, "Descent")                                                                                                                                                                                                                      \
+    X(Dest, "Dest")                                                                                                                                                                                                                            \
+    X(Dests, "Dests")                                                                                                                                                                                                                          \
+    X(DeviceCMYK, "DeviceCMYK")                                                                                                                                                                                                                \
+    X(DeviceGray, "DeviceGray")                                                                                                                                                                                                                \
+    X(DeviceN, "DeviceN")                                                                                                                                                                                                                      \
+    X(DeviceRGB, "DeviceRGB")                                                                                                                                                                                                                  \
+    X(Differences, "Differences")                                                                                                                                                                                                              \
+    X(Domain, "Domain")                                                                                                                                                                                                                        \
+    X(E, "E")                                                                                                                                                                                                                                  \
+    X(EarlyChange, "EarlyChange")                                                                                                                                                                                                              \
+    X(EncodedByteAlign, "EncodedByteAlign")                                                                                                                                                                                                    \
+    X(Encoding, "Encoding")                                                                                                                                                                                                                    \
+    X(Encrypt, "Encrypt")                                                                                                                                                                                                                      \
+    X(EncryptMetadata, "EncryptMetadata")                                                                                                                                                                                                      \
+    X(EndOfBlock, "EndOfBlock")                                                                                                                                                                                                                \
+    X(EndOfLine, "EndOfLine")                                                                                                                                                                                                                  \
+    X(Extend, "Extend")                                                                                                                                                                                                                        \
+    X(ExtGState, "ExtGState")                                                                                                                                                                                                                  \
+    X(Extends, "Extends")                                                                                                                                                                                                                      \
+    X(F, "F")                                                                                                                                                                                                                                  \
+    X(FT, "FT")                                                                                                                                                                                                                                \
+    X(Ff, "Ff")                                                                                                                                                                                                                                \
+    X(Fields, "Fields")                                                                                                                                                                                                                        \
+    X(Filter, "Filter")                                                                                                                                                                                                                        \
+    X(First, "First")                                                                                                                                                                                                                          \
+    X(FirstChar, "FirstChar")                                                                                                                                                                                                                  \
+    X(Fl, "Fl")                                                                                                                                                                                                                                \
+    X(Flags, "Flags")                                                                                                                                                                                                                          \
+    X(FlateDecode, "FlateDecode")                                                                                                                                                                                                              \
+    X(Font, "Font")                                                                                                                                                                                                                            \
+    X(FontBBox, "FontBBox")                                                                                                                                                                                                                    \
+    X(FontDescriptor, "FontDescriptor")                                                                                                                                                                                                        \
+    X(FontFile, "FontFile")                                                                                                                                                                                                                    \
+    X(FontFile2, "FontFile2")                                                                                                                                                                                                                  \
+    X(FontFile3, "FontFile3")                                                                                                                                                                                                                  \
+    X(FontMatrix, "FontMatrix")                                                                                                                                                                                                                \
+    X(FontName, "FontName")                                                                                                                                                                                                                    \
+    X(Form, "Form")                                                                                                                                                                                                                            \
+    X(FormType, "FormType")                                                                                                                                                                                                                    \
+    X(Function, "Function")                                                                                                                                                                                                                    \
+    X(FunctionType, "FunctionType")                                                                                                                                                                                                            \
+    X(Functions, "Functions")                                                                                                                                                                                                                  \
+    X(G, "G")                                                                                                                                                                                                                                  \
+    X(Group, "Group")                                                                                                                                                                                                                          \
+    X(H, "H")                                                                                                                                                                                                                                  \
+    X(HT, "HT")                                                                                                                                                                                                                                \
+    X(Height, "Height")                                                                                                                                                                                                                        \
+    X(I, "I")                                                                                                                                                                                                                                  \
+    X(ICCBased, "ICCBased")                                                                                                                                                                                                                    \
+    X(ID, "ID")                                                                                                                                                                                                                                \
+    X(IM, "IM")                                                                                                                                                                                                                                \
+    X(Identity, "Identity")                                                                                                                                                                                                                    \
+    X(IdentityH, "Identity-H")                                                                                                                                                                                                                 \
+    X(IdentityV, "Identity-V")                                                                                                                                                                                                                 \
+    X(Image, "Image")                                                                                                                                                                                                                          \
+    X(ImageMask, "ImageMask")                                                                                                                                                                                                                  \
+    X(Index, "Index")                                                                                                                                                                                                                          \
+    X(Indexed, "Indexed")                                                                                                                                                                                                                      \
+    X(Info, "Info")                                                                                                                                                                                                                            \
+    X(Intent, "Intent")                                                                                                                                                                                                                        \
+    X(Interpolate, "Interpolate")                                                                                                                                                                                                              \
+    X(ItalicAngle, "ItalicAngle")                                                                                                                                                                                                              \
+    X(JBIG2Decode, "JBIG2Decode")                                                                                                                                                                                                              \
+    X(JBIG2Globals, "JBIG2Globals")                                                                                                                                                                                                            \
+    X(JPXDecode, "JPXDecode")                                                                                                                                                                                                                  \
+    X(K, "K")                                                                                                                                                                                                                                  \
+    X(Kids, "Kids")                                                                                                                                                                                                                            \
+    X(L, "L")                                                                                                                                                                                                                                  \
+    X(LC, "LC")                                                                                                                                                                                                                                \
+    X(LJ, "LJ")                                                                                                                                                                                                                                \
+    X(LW, "LW")                                                                                                                                                                                                                                \
+    X(LZWDecode, "LZWDecode")                                                                                                                                                                                                                  \
+    X(Lab, "Lab")                                                                                                                                                                                                                              \
+    X(LastChar, "LastChar")                                                                                                                                                                                                                    \
+    X(Length, "Length")                                                                                                                                                                                                                        \
+    X(Length1, "Length1")                                                                                                                                                                                                                      \
+    X(Length2, "Length2")                                                                                                                                                                                                                      \
+    X(Length3, "Length3")                                                                                                                                                                                                                      \
+    X(Linearized, "Linearized")                                                                                                                                                                                                                \
+    X(Link, "Link")                                                                                                                                                                                                                            \
+    X(Luminosity, "Luminosity")                                                                                                                                                                                                                \
+    X(M, "M")                                                                                                                                                                                                                                  \
+    X(MK, "MK")                                                                                                                                                                                                                                \
+    X(ML, "ML")                                                                                                                                                                                                                                \
+    X(MacRomanEncoding, "MacRomanEncoding")                                                                                                                                                                                                    \
+    X(Mask, "Mask")                                                                                                                                                                                                                            \
+    X(Matrix, "Matrix")                                                                                                                                                                                                                        \
+    X(Matte, "Matte")                                                                                                                                                                                                                          \
+    X(MediaBox, "MediaBox")                                                                                                                                                                                                                    \
+    X(Metadata, "Metadata")                                                                                                                                                                                                                    \
+    X(MissingWidth, "MissingWidth")                                                                                                                                                                                                            \
+    X(N, "N")                                                                                                                                                                                                                                  \
+    X(Name, "Name")                                                                                                                                                                                                                            \
+    X(Names, "Names")                                                                                                                                                                                                                          \
+    X(NeedAppearances, "NeedAppearances")                                                                                                                                                                                                      \
+    X(O, "O")                                                                                                                                                                                                                                  \
+    X(OC, "OC")                                                                                                                                                                                                                                \
+    X(OCProperties, "OCProperties")                                                                                                                                                                                                            \
+    X(OP, "OP")                                                                                                                                                                                                                                \
+    X(OPM, "OPM")                                                                                                                                                                                                                              \
+    X(ObjStm, "ObjStm")                                                                                                                                                                                                                        \
+    X(OpenAction, "OpenAction")                                                                                                                                                                                                                \
+    X(Ordering, "Ordering")                                                                                                                                                                                                                    \
+    X(Outlines, "Outlines")                                                                                                                                                                                                                    \
+    X(P, "P")                                                                                                                                                                                                                                  \
+    X(Page, "Page")                                                                                                                                                                                                                            \
+    X(PageLabels, "PageLabels")                                                                                                                                                                                                                \
+    X(Pages, "Pages")                                                                                                                                                                                                                          \
+    X(PaintType, "PaintType")                                                                                                                                                                                                                  \
+    X(Parent, "Parent")                                                                                                                                                                                                                        \
+    X(Pattern, "Pattern")                                                                                                                                                                                                                      \
+    X(PatternType, "PatternType")                                                                                                                                                                                                              \
+    X(Predictor, "Predictor")                                                                                                                                                                                                                  \
+    X(Prev, "Prev")                                                                                                                                                                                                                            \
+    X(Producer, "Producer")                                                                                                                                                                                                                    \
+    X(Properties, "Properties")                                                                                                                                                                                                                \
+    X(R, "R")                                                                                                                                                                                                                                  \
+    X(RGB, "RGB")                                                                                                                                                                                                                              \
+    X(Range, "Range")                                                                                                                                                                                                                          \
+    X(Rect, "Rect")                                                                                                                                                                                                                            \
+    X(Registry, "Registry")                                                                                                                                                                                                                    \
+    X(Resources, "Resources")                                                                                                                                                                                                                  \
+    X(Root, "Root")                                                                                                                                                                                                                            \
+    X(Rotate, "Rotate")                                                                                                                                                                                                                        \
+    X(Rows, "Rows")                                                                                                                                                                                                                            \
+    X(S, "S")                                                                                                                                                                                                                                  \
+    X(SA, "SA")                                                                                                                                                                                                                                \
+    X(SM, "SM")                                                                                                                                                                                                                                \
+    X(SMask, "SMask")                                                                                                                                                                                                                          \
+    X(SMaskInData, "SMaskInData")                                                                                                                                                                                                              \
+    X(Separation, "Separation")                                                                                                                                                                                                                \
+    X(Shading, "Shading")                                                                                                                                                                                                                      \
+    X(ShadingType, "ShadingType")                                                                                                                                                                                                              \
+    X(Size, "Size")                                                                                                                                                                                                                            \
+    X(StandardEncoding, "StandardEncoding")                                                                                                                                                                                                    \
+    X(StemV, "StemV")                                                                                                                                                                                                                          \
+    X(StmF, "StmF")                                                                                                                                                                                                                            \
+    X(StrF, "StrF")                                                                                                                                                                                                                            \
+    X(StructParent, "StructParent")                                                                                                                                                                                                            \
+    X(StructParents, "StructParents")                                                                                                                                                                                                          \
+    X(StructTreeRoot, "StructTreeRoot")                                                                                                                                                                                                        \
+    X(Subtype, "Subtype")                                                                                                                                                                                                                      \
+    X(Supplement, "Supplement")                                                                                                                                                                                                                \
+    X(T, "T")                                                                                                                                                                                                                                  \
+    X(TR, "TR")                                                                                                                                                                                                                                \
+    X(TR2, "TR2")                                                                                                                                                                                                                              \
+    X(Text, "Text")                                                                                                                                                                                                                            \
+    X(TilingType, "TilingType")                                                                                                                                                                                                                \
+    X(Title, "Title")                                                                                                                                                                                                                          \
+    X(ToUnicode, "ToUnicode")                                                                                                                                                                                                                  \
+    X(TrimBox, "TrimBox")                                                                                                                                                                                                                      \
+    X(TrueType, "TrueType")                                                                                                                                                                                                                    \
+    X(Type, "Type")                                                                                                                                                                                                                            \
+    X(Type0, "Type0")                                                                                                                                                                                                                          \
+    X(Type1, "Type1")                                                                                                                                                                                                                          \
+    X(Type1C, "Type1C")                                                                                                                                                                                                                        \
+    X(Type3, "Type3")                                                                                                                                                                                                                          \
+    X(U, "U")                                                                                                                                                                                                                                  \
+    X(UCR, "UCR")                                                                                                                                                                                                                              \
+    X(UCR2, "UCR2")                                                                                                                                                                                                                            \
+    X(URI, "URI")                                                                                                                                                                                                                              \
+    X(V, "V")                                                                                                                                                                                                                                  \
+    X(W, "W")                                                                                                                                                                                                                                  \
+    X(W2, "W2")                                                                                                                                                                                                                                \
+    X(Widget, "Widget")                                                                                                                                                                                                                        \
+    X(Width, "Width")                                                                                                                                                                                                                          \
+    X(Widths, "Widths")                                                                                                                                                                                                                        \
+    X(WinAnsiEncoding, "WinAnsiEncoding")                                                                                                                                                                                                      \
+    X(XObject, "XObject")                                                                                                                                                                                                                      \
+    X(XRef, "XRef")                                                                                                                                                                                                                            \
+    X(XRefStm, "XRefStm")                                                                                                                                                                                                                      \
+    X(XStep, "XStep")                                                                                                                                                                                                                          \
+    X(YStep, "YStep")                                                                                                                                                                                                                          \
+    X(ca, "ca")                                                                                                                                                                                                                                \
+    X(op, "op")
+
+enum Atom : int
+{
+    atomNone = -1,
+#define POPPLER_ATOM_ENUM(id, name) atom##id,
+    POPPLER_NAMED_ATOMS(POPPLER_ATOM_ENUM)
+#undef POPPLER_ATOM_ENUM
+    numNamedAtoms
+};
+
+// Size of an entry in the atom table: the longest atom name, plus the
+// terminating nul.
+#define atomMaxLength 20
+
+// The atom table: the named atoms, followed by the operators and other
+// commands, which are not named.
+extern POPPLER_PRIVATE_EXPORT const char atomTable[][atomMaxLength];
+extern POPPLER_PRIVATE_EXPORT const int numAtoms;
+
+// Return the atom of <name>, or atomNone if it isn't in the table.
+extern POPPLER_PRIVATE_EXPORT Atom findAtom(const char *name);
+
+// Return true if <name> points into the atom table.
+inline bool isAtomName(const char *name)
+{
+    const uintptr_t p = reinterpret_cast<uintptr_t>(name);
+    const uintptr_t start = reinterpret_cast<uintptr_t>(atomTable[0]);
+    return p >= start && p < start + numAtoms * atomMaxLength;
+}
+
+// Return the atom of <name>, which must point into the atom table.
+inline Atom getAtom(const char *name)
+{
+    return static_cast<Atom>((reinterpret_cast<uintptr_t>(name) - reinterpret_cast<uintptr_t>(atomTable[0])) / atomMaxLength);
+}
+
+inline const char *getAtomName(Atom atom)
+{
+    return atomTable[atom];
+}
+
+#endif
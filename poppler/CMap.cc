@@ -38,18 +38,12 @@
 #include "GlobalParams.h"
 #include "PSTokenizer.h"
 #include "CMap.h"
+#include "CompiledMapFile.h"
 #include "Object.h"
 
 //------------------------------------------------------------------------
 
-struct CMapVectorEntry
-{
-    bool isVector;
-    union {
-        CMapVectorEntry *vector;
-        CID cid;
-    };
-};
+#define cMapTableFlag 0x80000000
 
 //------------------------------------------------------------------------
 
@@ -65,6 +59,32 @@ static int getCharFromStream(void *data)
 
 //------------------------------------------------------------------------
 
+// Open the compiled CMap <fileName>, if it is up to date with
+// <sourceFile> and valid: the tables only refer to tables after them, so
+// the lookups end.
+static CompiledMapFile *openCompiledCMap(const std::string &fileName, FILE *sourceFile)
+{
+    CompiledMapFile *file;
+
+    if (!(file = CompiledMapFile::open(fileName, CompiledMapFile::cMap, sourceFile))) {
+        return nullptr;
+    }
+    const size_t nTables = file->getLength() / 256;
+    bool ok = nTables > 0 && file->getLength() % 256 == 0 && file->getParam0() <= 1 && file->getParam1() <= 1;
+    for (size_t i = 0; ok && i < file->getLength(); ++i) {
+        const unsigned int entry = file->getData()[i];
+        if (entry & cMapTableFlag) {
+            const size_t table = entry & ~cMapTableFlag;
+            ok = table > i / 256 && table < nTables;
+        }
+    }
+    if (!ok) {
+        delete file;
+        return nullptr;
+    }
+    return file;
+}
+
 CMap *CMap::parse(CMapCache *cache, const GooString *collectionA, Object *obj)
 {
     CMap *cMap;
@@ -106,8 +126,25 @@ CMap *CMap::parse(CMapCache *cache, const GooString *collectionA, const GooStrin
         return nullptr;
     }
 
+    // use the compiled CMap if there is an up to date one, and compile
+    // it otherwise
+    const std::string compiledFileName = globalParams->getCompiledMapFileName("cmap", collectionA->toStr() + "-" + cMapNameA->toStr());
+    if (!compiledFileName.empty()) {
+        CompiledMapFile *file;
+        if ((file = openCompiledCMap(compiledFileName, f))) {
+            fclose(f);
+            return new CMap(collectionA->copy(), cMapNameA->copy(), file);
+        }
+    }
+
     cMap = new CMap(collectionA->copy(), cMapNameA->copy());
     cMap->parse2(cache, &getCharFromFile, f);
+    cMap->ownTables.shrink_to_fit();
+    cMap->tables = cMap->ownTables.data();
+
+    if (!compiledFileName.empty()) {
+        CompiledMapFile::write(compiledFileName, CompiledMapFile::cMap, f, cMap->wMode, cMap->isIdent ? 1 : 0, cMap->ownTables.data(), cMap->ownTables.size());
+    }
 
     fclose(f);
 
@@ -195,17 +232,13 @@ void CMap::parse2(CMapCache *cache, int (*getCharFunc)(void *), void *data)
 
 CMap::CMap(GooString *collectionA, GooString *cMapNameA)
 {
-    int i;
-
     collection = collectionA;
     cMapName = cMapNameA;
     isIdent = false;
     wMode = 0;
-    vector = (CMapVectorEntry *)gmallocn(256, sizeof(CMapVectorEntry));
-    for (i = 0; i < 256; ++i) {
-        vector[i].isVector = false;
-        vector[i].cid = 0;
-    }
+    ownTables.assign(256, 0);
+    tables = ownTables.data();
+    file = nullptr;
     refCnt = 1;
 }
 
@@ -215,7 +248,19 @@ CMap::CMap(GooString *collectionA, GooString *cMapNameA, int wModeA)
     cMapName = cMapNameA;
     isIdent = true;
     wMode = wModeA;
-    vector = nullptr;
+    tables = nullptr;
+    file = nullptr;
+    refCnt = 1;
+}
+
+CMap::CMap(GooString *collectionA, GooString *cMapNameA, CompiledMapFile *fileA)
+{
+    collection = collectionA;
+    cMapName = cMapNameA;
+    wMode = fileA->getParam0();
+    isIdent = fileA->getParam1() != 0;
+    tables = fileA->getData();
+    file = fileA;
     refCnt = 1;
 }
 
@@ -239,8 +284,8 @@ void CMap::useCMap(CMapCache *cache, const char *useName)
         return;
     }
     isIdent = subCMap->isIdent;
-    if (subCMap->vector) {
-        copyVector(vector, subCMap->vector);
+    if (subCMap->tables) {
+        copyTable(0, subCMap, 0);
     }
     subCMap->decRefCnt();
 }
@@ -254,32 +299,37 @@ void CMap::useCMap(CMapCache *cache, Object *obj)
         return;
     }
     isIdent = subCMap->isIdent;
-    if (subCMap->vector) {
-        copyVector(vector, subCMap->vector);
+    if (subCMap->tables) {
+        copyTable(0, subCMap, 0);
     }
     subCMap->decRefCnt();
 }
 
-void CMap::copyVector(CMapVectorEntry *dest, CMapVectorEntry *src)
+// Add an empty table, and return its index.  The CMap must be being
+// parsed.
+unsigned int CMap::addTable()
 {
-    int i, j;
+    const unsigned int table = ownTables.size() / 256;
+    ownTables.resize(ownTables.size() + 256, 0);
+    tables = ownTables.data();
+    return table;
+}
 
-    for (i = 0; i < 256; ++i) {
-        if (src[i].isVector) {
-            if (!dest[i].isVector) {
-                dest[i].isVector = true;
-                dest[i].vector = (CMapVectorEntry *)gmallocn(256, sizeof(CMapVectorEntry));
-                for (j = 0; j < 256; ++j) {
-                    dest[i].vector[j].isVector = false;
-                    dest[i].vector[j].cid = 0;
-                }
+void CMap::copyTable(unsigned int dest, const CMap *src, unsigned int srcTable)
+{
+    for (unsigned int i = 0; i < 256; ++i) {
+        const unsigned int srcEntry = src->tables[srcTable * 256 + i];
+        if (srcEntry & cMapTableFlag) {
+            if (!(ownTables[dest * 256 + i] & cMapTableFlag)) {
+                const unsigned int table = addTable();
+                ownTables[dest * 256 + i] = cMapTableFlag | table;
             }
-            copyVector(dest[i].vector, src[i].vector);
+            copyTable(ownTables[dest * 256 + i] & ~cMapTableFlag, src, srcEntry & ~cMapTableFlag);
         } else {
-            if (dest[i].isVector) {
+            if (ownTables[dest * 256 + i] & cMapTableFlag) {
                 error(errSyntaxError, -1, "Collision in usecmap");
             } else {
-                dest[i].cid = src[i].cid;
+                ownTables[dest * 256 + i] = srcEntry;
             }
         }
     }
@@ -295,26 +345,24 @@ void CMap::addCIDs(unsigned int start, unsigned int end, unsigned int nBytes, CI
     const unsigned int start1 = start & 0xffffff00;
     const unsigned int end1 = end & 0xffffff00;
     for (unsigned int i = start1; i <= end1; i += 0x100) {
-        CMapVectorEntry *vec = vector;
+        unsigned int table = 0;
         for (unsigned int j = nBytes - 1; j >= 1; --j) {
             const int byte = (i >> (8 * j)) & 0xff;
-            if (!vec[byte].isVector) {
-                vec[byte].isVector = true;
-                vec[byte].vector = (CMapVectorEntry *)gmallocn(256, sizeof(CMapVectorEntry));
-                for (unsigned int k = 0; k < 256; ++k) {
-                    vec[byte].vector[k].isVector = false;
-                    vec[byte].vector[k].cid = 0;
-                }
+            if (!(ownTables[table * 256 + byte] & cMapTableFlag)) {
+                const unsigned int newTable = addTable();
+                ownTables[table * 256 + byte] = cMapTableFlag | newTable;
             }
-            vec = vec[byte].vector;
+            table = ownTables[table * 256 + byte] & ~cMapTableFlag;
         }
         const int byte0 = (i < start) ? (start & 0xff) : 0;
         const int byte1 = (i + 0xff > end) ? (end & 0xff) : 0xff;
         for (int byte = byte0; byte <= byte1; ++byte) {
-            if (vec[byte].isVector) {
+            if (ownTables[table * 256 + byte] & cMapTableFlag) {
                 error(errSyntaxError, -1, "Invalid CID ({0:ux} [{1:ud} bytes]) in CMap", i, nBytes);
             } else {
-                vec[byte].cid = firstCID + ((i + byte) - start);
+                const CID cid = firstCID + ((i + byte) - start);
+                // CIDs are at most 65535, the larger ones can't be stored
+                ownTables[table * 256 + byte] = (cid & cMapTableFlag) ? 0 : cid;
             }
         }
     }
@@ -324,21 +372,7 @@ CMap::~CMap()
 {
     delete collection;
     delete cMapName;
-    if (vector) {
-        freeCMapVector(vector);
-    }
-}
-
-void CMap::freeCMapVector(CMapVectorEntry *vec)
-{
-    int i;
-
-    for (i = 0; i < 256; ++i) {
-        if (vec[i].isVector) {
-            freeCMapVector(vec[i].vector);
-        }
-    }
-    gfree(vec);
+    delete file;
 }
 
 void CMap::incRefCnt()
@@ -360,22 +394,22 @@ bool CMap::match(const GooString *collectionA, const GooString *cMapNameA)
 
 CID CMap::getCID(const char *s, int len, CharCode *c, int *nUsed)
 {
-    CMapVectorEntry *vec;
+    const unsigned int *table;
     CharCode cc;
     int n, i;
 
-    vec = vector;
+    table = tables;
     cc = 0;
     n = 0;
-    while (vec && n < len) {
+    while (table && n < len) {
         i = s[n++] & 0xff;
         cc = (cc << 8) | i;
-        if (!vec[i].isVector) {
+        if (!(table[i] & cMapTableFlag)) {
             *c = cc;
             *nUsed = n;
-            return vec[i].cid;
+            return table[i];
         }
-        vec = vec[i].vector;
+        table = tables + (size_t)(table[i] & ~cMapTableFlag) * 256;
     }
     if (isIdent && len >= 2) {
         // identity CMap
@@ -388,17 +422,16 @@ CID CMap::getCID(const char *s, int len, CharCode *c, int *nUsed)
     return 0;
 }
 
-void CMap::setReverseMapVector(unsigned int startCode, CMapVectorEntry *vec, unsigned int *rmap, unsigned int rmapSize, unsigned int ncand)
+void CMap::setReverseMapTable(unsigned int startCode, unsigned int table, unsigned int *rmap, unsigned int rmapSize, unsigned int ncand)
 {
     int i;
 
-    if (vec == nullptr)
-        return;
+    const unsigned int *entries = tables + (size_t)table * 256;
     for (i = 0; i < 256; i++) {
-        if (vec[i].isVector) {
-            setReverseMapVector((startCode + i) << 8, vec[i].vector, rmap, rmapSize, ncand);
+        if (entries[i] & cMapTableFlag) {
+            setReverseMapTable((startCode + i) << 8, entries[i] & ~cMapTableFlag, rmap, rmapSize, ncand);
         } else {
-            unsigned int cid = vec[i].cid;
+            unsigned int cid = entries[i];
 
             if (cid < rmapSize) {
                 unsigned int cand;
@@ -420,7 +453,9 @@ void CMap::setReverseMapVector(unsigned int startCode, CMapVectorEntry *vec, uns
 
 void CMap::setReverseMap(unsigned int *rmap, unsigned int rmapSize, unsigned int ncand)
 {
-    setReverseMapVector(0, vector, rmap, rmapSize, ncand);
+    if (tables) {
+        setReverseMapTable(0, 0, rmap, rmapSize, ncand);
+    }
 }
 
 //------------------------------------------------------------------------
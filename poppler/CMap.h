@@ -27,14 +27,15 @@
 #define CMAP_H
 
 #include <atomic>
+#include <vector>
 
 #include "poppler-config.h"
 #include "CharTypes.h"
 
 class GooString;
 class Object;
-struct CMapVectorEntry;
 class CMapCache;
+class CompiledMapFile;
 class Stream;
 
 //------------------------------------------------------------------------
@@ -85,20 +86,27 @@ private:
     void parse2(CMapCache *cache, int (*getCharFunc)(void *), void *data);
     CMap(GooString *collectionA, GooString *cMapNameA);
     CMap(GooString *collectionA, GooString *cMapNameA, int wModeA);
+    CMap(GooString *collectionA, GooString *cMapNameA, CompiledMapFile *fileA);
     void useCMap(CMapCache *cache, const char *useName);
     void useCMap(CMapCache *cache, Object *obj);
-    void copyVector(CMapVectorEntry *dest, CMapVectorEntry *src);
+    unsigned int addTable();
+    void copyTable(unsigned int dest, const CMap *src, unsigned int srcTable);
     void addCIDs(unsigned int start, unsigned int end, unsigned int nBytes, CID firstCID);
-    void freeCMapVector(CMapVectorEntry *vec);
-    void setReverseMapVector(unsigned int startCode, CMapVectorEntry *vec, unsigned int *rmap, unsigned int rmapSize, unsigned int ncand);
+    void setReverseMapTable(unsigned int startCode, unsigned int table, unsigned int *rmap, unsigned int rmapSize, unsigned int ncand);
 
     GooString *collection;
     GooString *cMapName;
     bool isIdent; // true if this CMap is an identity mapping,
                   //   or is based on one (via usecmap)
     int wMode; // writing mode (0=horizontal, 1=vertical)
-    CMapVectorEntry *vector; // vector for first byte (NULL for
-                             //   identity CMap)
+    // The mapping is stored as tables of 256 entries, one per prefix of
+    // the char codes, table 0 being for the first byte.  Each entry is a
+    // CID or, with cMapTableFlag set, the index of the table for the next
+    // byte.  This is also the format of the compiled CMap files.
+    const unsigned int *tables; // NULL for identity CMap
+    std::vector<unsigned int> ownTables; // tables, when they are parsed
+    CompiledMapFile *file; // tables, when they are read from a compiled
+                           //   file
     std::atomic_int refCnt;
 };
 
@@ -436,12 +436,11 @@ CairoFreeTypeFont *CairoFreeTypeFont::create(GfxFont *gfxFont, XRef *xref, FT_Li
                 codeToGID = (int *)gmallocn(n, sizeof(int));
                 memcpy(codeToGID, ((GfxCIDFont *)gfxFont)->getCIDToGID(), n * sizeof(int));
             }
+        } else if (font_data == nullptr) {
+            // the maps of the system fonts are cached
+            codeToGID = ((GfxCIDFont *)gfxFont)->getCodeToGIDMap(fileName, &n);
         } else {
-            if (font_data != nullptr) {
-                ff = FoFiTrueType::make(font_data, font_data_len);
-            } else {
-                ff = FoFiTrueType::load(fileNameC);
-            }
+            ff = FoFiTrueType::make(font_data, font_data_len);
             if (!ff)
                 goto err2;
             codeToGID = ((GfxCIDFont *)gfxFont)->getCodeToGIDMap(ff, &n);
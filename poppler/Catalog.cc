@@ -66,6 +66,7 @@
 #include "ViewerPreferences.h"
 #include "FileSpec.h"
 #include "StructTreeRoot.h"
+#include "Lexer.h"
 
 //------------------------------------------------------------------------
 // Catalog
@@ -73,7 +74,10 @@
 
 #define catalogLocker() std::unique_lock<std::recursive_mutex> locker(mutex)
 
-Catalog::Catalog(PDFDoc *docA)
+// memory used by the compiled content streams of a document
+#define compiledContentCacheSize (32 * 1024 * 1024)
+
+Catalog::Catalog(PDFDoc *docA) : compiledContents(compiledContentCacheSize)
 {
     ok = true;
     doc = docA;
@@ -1198,3 +1202,70 @@ std::unique_ptr<LinkAction> Catalog::getAdditionalAction(DocumentAdditionalActio
     }
     return nullptr;
 }
+
+bool Catalog::formHasText(const Ref formRef)
+{
+    catalogLocker();
+    return scanFormForText(formRef, 0);
+}
+
+bool Catalog::scanFormForText(const Ref formRef, int depth)
+{
+    const auto cached = formsHaveText.find(formRef);
+    if (cached != formsHaveText.end()) {
+        return cached->second;
+    }
+    if (depth > 16) {
+        return true;
+    }
+
+    Object formObj = xref->fetch(formRef);
+    if (!formObj.isStream()) {
+        return true;
+    }
+    Object resObj = formObj.streamGetDict()->lookup("Resources");
+    Object xObjects = resObj.isDict() ? resObj.dictLookup("XObject") : Object();
+
+    bool hasText = false;
+    Lexer lexer(xref, &formObj);
+    Object prevObj;
+    for (Object obj = lexer.getObj(); !hasText && !obj.isEOF(); obj = lexer.getObj()) {
+        if (obj.isError()) {
+            hasText = true;
+        } else if (obj.isCmd()) {
+            const char *cmd = obj.getCmd();
+            if (!strcmp(cmd, "Tj") || !strcmp(cmd, "TJ") || !strcmp(cmd, "'") || !strcmp(cmd, "\"")) {
+                hasText = true;
+            } else if (!strcmp(cmd, "ID")) {
+                // don't try to lex inline image data
+                hasText = true;
+            } else if (!strcmp(cmd, "Do")) {
+                // images can't show text, nested forms are checked too;
+                // anything else (e.g. names inherited from the page
+                // resources) is assumed to show text
+                Ref xObjRef = Ref::INVALID();
+                if (prevObj.isName() && xObjects.isDict()) {
+                    const Object &xObjRefObj = xObjects.dictLookupNF(prevObj.getName());
+                    if (xObjRefObj.isRef()) {
+                        xObjRef = xObjRefObj.getRef();
+                    }
+                }
+                if (xObjRef == Ref::INVALID()) {
+                    hasText = true;
+                } else {
+                    Object xObj = xref->fetch(xObjRef);
+                    Object subtype = xObj.isStream() ? xObj.streamGetDict()->lookup("Subtype") : Object();
+                    if (subtype.isName("Form")) {
+                        hasText = scanFormForText(xObjRef, depth + 1);
+                    } else if (!subtype.isName("Image")) {
+                        hasText = true;
+                    }
+                }
+            }
+        }
+        prevObj = std::move(obj);
+    }
+
+    formsHaveText[formRef] = hasText;
+    return hasText;
+}
@@ -45,7 +45,9 @@
 #include "poppler_private_export.h"
 #include "Object.h"
 #include "Link.h"
+#include "CompiledContent.h"
 
+#include <map>
 #include <vector>
 #include <memory>
 
@@ -266,6 +268,15 @@ public:
 
     std::unique_ptr<LinkAction> getAdditionalAction(DocumentAdditionalActionsType type);
 
+    // Does the form XObject <formRef> show any text?  This is a
+    // conservative scan of the content stream (true if unsure), done
+    // once per form and then cached.
+    bool formHasText(const Ref formRef);
+
+    // Compiled content streams, shared by all the Gfx objects drawing
+    // this document.
+    CompiledContentCache *getCompiledContents() { return &compiledContents; }
+
 private:
     // Get page label info.
     PageLabelInfo *getPageLabelInfo();
@@ -307,10 +318,14 @@ private:
     NameTree *getEmbeddedFileNameTree();
     NameTree *getJSNameTree();
     std::unique_ptr<LinkDest> createLinkDest(Object *obj);
+    bool scanFormForText(const Ref formRef, int depth);
 
     int catalogPdfMajorVersion = -1;
     int catalogPdfMinorVersion = -1;
 
+    std::map<Ref, bool> formsHaveText; // cached results of formHasText()
+    CompiledContentCache compiledContents;
+
     mutable std::recursive_mutex mutex;
 };
 
@@ -47,6 +47,7 @@
 #include "GlobalParams.h"
 #include "PSTokenizer.h"
 #include "CharCodeToUnicode.h"
+#include "CompiledMapFile.h"
 #include "UTF.h"
 
 //------------------------------------------------------------------------
@@ -143,6 +144,20 @@ CharCodeToUnicode *CharCodeToUnicode::parseCIDToUnicode(const char *fileName, co
         return nullptr;
     }
 
+    // use the compiled file if there is an up to date one, and compile
+    // the file otherwise
+    const std::string compiledFileName = globalParams->getCompiledMapFileName("cidToUnicode", fileName);
+    if (!compiledFileName.empty()) {
+        CompiledMapFile *file;
+        if ((file = CompiledMapFile::open(compiledFileName, CompiledMapFile::cidToUnicode, f))) {
+            if (file->getLength() > 0 && file->getLength() == file->getParam0()) {
+                fclose(f);
+                return new CharCodeToUnicode(collection->copy(), file);
+            }
+            delete file;
+        }
+    }
+
     size = 32768;
     mapA = (Unicode *)gmallocn(size, sizeof(Unicode));
     mapLenA = 0;
@@ -160,6 +175,9 @@ CharCodeToUnicode *CharCodeToUnicode::parseCIDToUnicode(const char *fileName, co
         }
         ++mapLenA;
     }
+    if (!compiledFileName.empty() && mapLenA > 0) {
+        CompiledMapFile::write(compiledFileName, CompiledMapFile::cidToUnicode, f, mapLenA, 0, mapA, mapLenA);
+    }
     fclose(f);
 
     ctu = new CharCodeToUnicode(collection->copy(), mapA, mapLenA, true, nullptr, 0, 0);
@@ -292,6 +310,7 @@ CharCodeToUnicode *CharCodeToUnicode::parseCMapFromFile(const GooString *fileNam
 
 void CharCodeToUnicode::mergeCMap(const GooString *buf, int nBits)
 {
+    copyMapFromFile();
     const char *p = buf->c_str();
     parseCMap1(&getCharFromString, &p, nBits);
 }
@@ -564,6 +583,7 @@ CharCodeToUnicode::CharCodeToUnicode()
     mapLen = 0;
     sMap = nullptr;
     sMapLen = sMapSize = 0;
+    file = nullptr;
     refCnt = 1;
     isIdentity = false;
 }
@@ -580,6 +600,7 @@ CharCodeToUnicode::CharCodeToUnicode(GooString *tagA)
     }
     sMap = nullptr;
     sMapLen = sMapSize = 0;
+    file = nullptr;
     refCnt = 1;
     isIdentity = false;
 }
@@ -597,16 +618,47 @@ CharCodeToUnicode::CharCodeToUnicode(GooString *tagA, Unicode *mapA, CharCode ma
     sMap = sMapA;
     sMapLen = sMapLenA;
     sMapSize = sMapSizeA;
+    file = nullptr;
+    refCnt = 1;
+    isIdentity = false;
+}
+
+CharCodeToUnicode::CharCodeToUnicode(GooString *tagA, CompiledMapFile *fileA)
+{
+    tag = tagA;
+    mapLen = fileA->getLength();
+    // the map is only read until copyMapFromFile() is called
+    map = const_cast<Unicode *>(fileA->getData());
+    file = fileA;
+    sMap = nullptr;
+    sMapLen = sMapSize = 0;
     refCnt = 1;
     isIdentity = false;
 }
 
+// Copy the map out of the compiled file, if it is read from one, before
+// it gets modified.
+void CharCodeToUnicode::copyMapFromFile()
+{
+    if (file) {
+        Unicode *mapA = (Unicode *)gmallocn(mapLen, sizeof(Unicode));
+        memcpy(mapA, map, mapLen * sizeof(Unicode));
+        map = mapA;
+        delete file;
+        file = nullptr;
+    }
+}
+
 CharCodeToUnicode::~CharCodeToUnicode()
 {
     if (tag) {
         delete tag;
     }
-    gfree(map);
+    if (file) {
+        delete file;
+    } else {
+        gfree(map);
+    }
     if (sMap) {
         for (int i = 0; i < sMapLen; ++i)
             gfree(sMap[i].u);
@@ -638,6 +690,7 @@ void CharCodeToUnicode::setMapping(CharCode c, Unicode *u, int len)
     if (!map || isIdentity) {
         return;
     }
+    copyMapFromFile();
     if (len == 1) {
         map[c] = u[0];
     } else {
@@ -38,6 +38,7 @@
 
 struct CharCodeToUnicodeString;
 class GooString;
+class CompiledMapFile;
 
 //------------------------------------------------------------------------
 
@@ -50,8 +51,9 @@ public:
     static CharCodeToUnicode *makeIdentityMapping();
 
     // Read the CID-to-Unicode mapping for <collection> from the file
-    // specified by <fileName>.  Sets the initial reference count to 1.
-    // Returns NULL on failure.
+    // specified by <fileName>, or from its compiled form if
+    // GlobalParams::setCMapCacheDir() is used.  Sets the initial
+    // reference count to 1.  Returns NULL on failure.
     static CharCodeToUnicode *parseCIDToUnicode(const char *fileName, const GooString *collection);
 
     // Create a Unicode-to-Unicode mapping from the file specified by
@@ -105,10 +107,13 @@ private:
     CharCodeToUnicode();
     explicit CharCodeToUnicode(GooString *tagA);
     CharCodeToUnicode(GooString *tagA, Unicode *mapA, CharCode mapLenA, bool copyMap, CharCodeToUnicodeString *sMapA, int sMapLenA, int sMapSizeA);
+    CharCodeToUnicode(GooString *tagA, CompiledMapFile *fileA);
+    void copyMapFromFile();
 
     GooString *tag;
     Unicode *map;
     CharCode mapLen;
+    CompiledMapFile *file; // read-only storage of map, if not NULL
     CharCodeToUnicodeString *sMap;
     int sMapLen, sMapSize;
     std::atomic_int refCnt;
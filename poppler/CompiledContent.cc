@@ -0,0 +1,147 @@
+//========================================================================
+//
+// CompiledContent.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstring>
+
+#include "Object.h"
+#include "Error.h"
+#include "Gfx.h"
+#include "Parser.h"
+#include "CompiledContent.h"
+
+//------------------------------------------------------------------------
+// CompiledContent
+//------------------------------------------------------------------------
+
+CompiledContent::CompiledContent() : restOp(0), size(0) { }
+
+CompiledContent::~CompiledContent() = default;
+
+std::unique_ptr<CompiledContent> CompiledContent::compile(XRef *xref, Object *obj, size_t maxSize)
+{
+    std::unique_ptr<CompiledContent> content(new CompiledContent());
+    std::unique_ptr<Parser> parser = std::make_unique<Parser>(xref, obj, false);
+    int numArgs = 0;
+
+    // report an error of the operand lists before the next operator
+    auto addError = [&content](ErrorCategory category, Goffset pos, const char *msg) {
+        content->size += sizeof(OpError) + strlen(msg);
+        content->errors.push_back(OpError { content->ops.size(), category, pos, msg });
+    };
+
+    // this follows Gfx::go
+    Object obj1 = parser->getObj();
+    while (!obj1.isEOF()) {
+        if (obj1.isCmd()) {
+            const char *name = obj1.getCmd();
+            Op op;
+            op.op = Gfx::findOp(name);
+            op.name = -1;
+            if (!op.op) {
+                op.name = content->unknownNames.size();
+                content->unknownNames.emplace_back(name);
+                content->size += strlen(name) + 1 + sizeof(std::string);
+            }
+            op.firstArg = content->args.size() - numArgs;
+            op.numArgs = numArgs;
+            op.pos = parser->getPos();
+            content->ops.push_back(op);
+            content->size += sizeof(Op);
+            numArgs = 0;
+
+            // the rest is interpreted from the parser
+            if (!strcmp(name, "BI")) {
+                content->restOp = content->ops.size() - 1;
+                content->rest = std::move(parser);
+                return content;
+            }
+            if (content->size > maxSize) {
+                content->restOp = content->ops.size();
+                content->rest = std::move(parser);
+                return content;
+            }
+        } else if (numArgs < maxArgs) {
+            content->size += obj1.getMemorySize();
+            content->args.push_back(std::move(obj1));
+            ++numArgs;
+        } else {
+            addError(errSyntaxError, parser->getPos(), "Too many args in content stream");
+        }
+        obj1 = parser->getObj();
+    }
+
+    if (numArgs > 0) {
+        addError(errSyntaxError, parser->getPos(), "Leftover args in content stream");
+    }
+
+    content->ops.shrink_to_fit();
+    content->args.shrink_to_fit();
+    content->errors.shrink_to_fit();
+    content->restOp = content->ops.size();
+    return content;
+}
+
+const char *CompiledContent::getName(const Op &op) const
+{
+    return op.op ? op.op->name : unknownNames[op.name].c_str();
+}
+
+//------------------------------------------------------------------------
+// CompiledContentCache
+//------------------------------------------------------------------------
+
+// size accounted for a content that couldn't be compiled
+#define compiledContentFailedSize 64
+
+CompiledContentCache::CompiledContentCache(size_t maxSizeA) : maxSize(maxSizeA), size(0) { }
+
+CompiledContentCache::~CompiledContentCache() = default;
+
+std::shared_ptr<CompiledContent> CompiledContentCache::get(const std::vector<Ref> &key, XRef *xref, Object *obj)
+{
+    {
+        std::lock_guard<std::mutex> lock { mutex };
+        const auto it = entries.find(key);
+        if (it != entries.end()) {
+            lru.splice(lru.begin(), lru, it->second.lruPos);
+            return it->second.content;
+        }
+    }
+
+    // compile without holding the lock; if another thread compiles the
+    // same content meanwhile, the first one to finish wins
+    std::shared_ptr<CompiledContent> content = CompiledContent::compile(xref, obj, maxSize / 4);
+    const bool complete = !content->getRest();
+    const size_t contentSize = complete ? content->getSize() : compiledContentFailedSize;
+
+    std::lock_guard<std::mutex> lock { mutex };
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        return complete ? it->second.content : content;
+    }
+    while (!lru.empty() && size + contentSize > maxSize) {
+        const auto last = entries.find(lru.back());
+        size -= last->second.size;
+        entries.erase(last);
+        lru.pop_back();
+    }
+    lru.push_front(key);
+    entries[key] = Entry { complete ? content : nullptr, contentSize, lru.begin() };
+    size += contentSize;
+    return content;
+}
+
+void CompiledContentCache::clear()
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    entries.clear();
+    lru.clear();
+    size = 0;
+}
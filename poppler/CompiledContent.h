@@ -0,0 +1,150 @@
+//========================================================================
+//
+// CompiledContent.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef COMPILEDCONTENT_H
+#define COMPILEDCONTENT_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "poppler-config.h"
+#include "poppler_private_export.h"
+#include "Error.h"
+#include "Object.h"
+
+struct Operator;
+class Parser;
+class XRef;
+
+//------------------------------------------------------------------------
+// CompiledContent
+//
+// A content stream (or array of content streams) parsed once into its
+// operators.  Each operator is resolved to its Gfx::opTab entry and its
+// operands are kept, in order, in a single array, so Gfx can run the
+// content again without going through the lexer and parser, and
+// without allocating anything per operator.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT CompiledContent
+{
+public:
+    struct Op
+    {
+        const Operator *op; // nullptr for an unknown operator
+        int name; // index in <unknownNames>, if <op> is nullptr
+        int firstArg; // index of the first operand in <args>
+        int numArgs; // number of operands
+        Goffset pos; // stream position, for error messages
+    };
+
+    // An error in the operand lists of the content ("too many args",
+    // "leftover args").  It is reported each time the content runs,
+    // before its operator <op>; an <op> equal to the number of operators
+    // means after the last one.
+    struct OpError
+    {
+        size_t op;
+        ErrorCategory category;
+        Goffset pos;
+        std::string msg;
+    };
+
+    // Parse <obj>, a stream or an array of streams.  Arrays and dicts
+    // in operands are created with <xref>, which must outlive the
+    // compiled content.  The errors of the lexer and parser are reported
+    // while compiling.  The compilation stops at an inline image (whose
+    // data has to be read straight from the stream), or once the content
+    // needs more than <maxSize> bytes: the content is then incomplete,
+    // and the rest of it must be interpreted with getRest().
+    static std::unique_ptr<CompiledContent> compile(XRef *xref, Object *obj, size_t maxSize);
+
+    ~CompiledContent();
+
+    CompiledContent(const CompiledContent &) = delete;
+    CompiledContent &operator=(const CompiledContent &) = delete;
+
+    const std::vector<Op> &getOps() const { return ops; }
+
+    // The operands of <op>.  They are shared by every run of the
+    // content, possibly on several threads.
+    const Object *getArgs(const Op &op) const { return args.data() + op.firstArg; }
+
+    const char *getName(const Op &op) const;
+
+    const std::vector<OpError> &getErrors() const { return errors; }
+
+    // For an incomplete content, the parser of the rest of the content,
+    // which must be used from the operator <getRestOp()> on (the inline
+    // image operator reads its data from it); nullptr if the content is
+    // complete.  An incomplete content can only run once.
+    Parser *getRest() const { return rest.get(); }
+    size_t getRestOp() const { return restOp; }
+
+    // Approximate memory used by the compiled content, in bytes.
+    size_t getSize() const { return size; }
+
+private:
+    CompiledContent();
+
+    std::vector<Op> ops;
+    std::vector<Object> args;
+    std::vector<std::string> unknownNames;
+    std::vector<OpError> errors;
+    std::unique_ptr<Parser> rest;
+    size_t restOp;
+    size_t size;
+};
+
+//------------------------------------------------------------------------
+// CompiledContentCache
+//
+// The compiled content of a document, keyed by the references of the
+// streams, and limited to a total size.  The least recently used
+// contents are dropped first.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT CompiledContentCache
+{
+public:
+    explicit CompiledContentCache(size_t maxSizeA);
+    ~CompiledContentCache();
+
+    CompiledContentCache(const CompiledContentCache &) = delete;
+    CompiledContentCache &operator=(const CompiledContentCache &) = delete;
+
+    // Return the compiled form of <obj>, which is the (fetched) content
+    // identified by <key>, compiling it with <xref> if needed.  An
+    // incomplete content is returned to be run once, and not cached:
+    // the next calls return nullptr.
+    std::shared_ptr<CompiledContent> get(const std::vector<Ref> &key, XRef *xref, Object *obj);
+
+    // Drop all the cached contents.
+    void clear();
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<CompiledContent> content;
+        size_t size;
+        std::list<std::vector<Ref>>::iterator lruPos;
+    };
+
+    size_t maxSize;
+    size_t size;
+    std::map<std::vector<Ref>, Entry> entries;
+    std::list<std::vector<Ref>> lru; // most recently used first
+    std::mutex mutex;
+};
+
+#endif
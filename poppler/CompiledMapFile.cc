@@ -0,0 +1,140 @@
+//========================================================================
+//
+// CompiledMapFile.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstring>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#    include <sys/mman.h>
+#endif
+#ifdef _WIN32
+#    include <process.h>
+#    define getpid _getpid
+#else
+#    include <unistd.h>
+#endif
+#include "goo/gfile.h"
+#include "CompiledMapFile.h"
+
+//------------------------------------------------------------------------
+
+struct CompiledMapHeader
+{
+    char magic[8];
+    unsigned int byteOrder; // compiledMapByteOrder, in native order
+    unsigned int kind;
+    long long sourceSize;
+    long long sourceTime;
+    unsigned int param0, param1;
+};
+
+static_assert(sizeof(CompiledMapHeader) % sizeof(unsigned int) == 0, "the map data must be aligned");
+
+static const char compiledMapMagic[8] = { 'P', 'O', 'P', 'M', 'A', 'P', '0', '1' };
+#define compiledMapByteOrder 0x01020304
+
+// Fill in the magic, kind and source file fields of <hdr>.
+static bool setHeader(CompiledMapHeader *hdr, CompiledMapFile::Kind kind, FILE *sourceFile)
+{
+    struct stat st;
+
+    if (fstat(fileno(sourceFile), &st) != 0) {
+        return false;
+    }
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, compiledMapMagic, sizeof(hdr->magic));
+    hdr->byteOrder = compiledMapByteOrder;
+    hdr->kind = kind;
+    hdr->sourceSize = st.st_size;
+    hdr->sourceTime = st.st_mtime;
+    return true;
+}
+
+//------------------------------------------------------------------------
+// CompiledMapFile
+//------------------------------------------------------------------------
+
+CompiledMapFile::CompiledMapFile() : mapping(nullptr), mappingSize(0), param0(0), param1(0), data(nullptr), length(0) { }
+
+CompiledMapFile::~CompiledMapFile()
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (mapping) {
+        munmap(mapping, mappingSize);
+    }
+#endif
+}
+
+CompiledMapFile *CompiledMapFile::open(const std::string &fileName, Kind kind, FILE *sourceFile)
+{
+    CompiledMapHeader expected, hdr;
+    struct stat st;
+    FILE *f;
+
+    if (!setHeader(&expected, kind, sourceFile)) {
+        return nullptr;
+    }
+    if (!(f = openFile(fileName.c_str(), "rb"))) {
+        return nullptr;
+    }
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 || memcmp(hdr.magic, expected.magic, sizeof(hdr.magic)) || hdr.byteOrder != expected.byteOrder || hdr.kind != expected.kind || hdr.sourceSize != expected.sourceSize
+        || hdr.sourceTime != expected.sourceTime || fstat(fileno(f), &st) != 0 || (size_t)st.st_size < sizeof(hdr) || (st.st_size - sizeof(hdr)) % sizeof(unsigned int) != 0) {
+        fclose(f);
+        return nullptr;
+    }
+
+    CompiledMapFile *file = new CompiledMapFile();
+    file->param0 = hdr.param0;
+    file->param1 = hdr.param1;
+    file->length = (st.st_size - sizeof(hdr)) / sizeof(unsigned int);
+#ifdef HAVE_SYS_MMAN_H
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (p != MAP_FAILED) {
+        file->mapping = p;
+        file->mappingSize = st.st_size;
+        file->data = (const unsigned int *)((const char *)p + sizeof(hdr));
+    }
+#endif
+    if (!file->mapping) {
+        file->buf.resize(file->length);
+        if (fread(file->buf.data(), sizeof(unsigned int), file->length, f) != file->length) {
+            fclose(f);
+            delete file;
+            return nullptr;
+        }
+        file->data = file->buf.data();
+    }
+    fclose(f);
+    return file;
+}
+
+bool CompiledMapFile::write(const std::string &fileName, Kind kind, FILE *sourceFile, unsigned int param0, unsigned int param1, const unsigned int *data, size_t len)
+{
+    CompiledMapHeader hdr;
+    FILE *f;
+
+    if (!setHeader(&hdr, kind, sourceFile)) {
+        return false;
+    }
+    hdr.param0 = param0;
+    hdr.param1 = param1;
+
+    // write a new file and move it in place, so other processes never
+    // map a partial file
+    const std::string tmpFileName = fileName + ".tmp" + std::to_string(getpid());
+    if (!(f = openFile(tmpFileName.c_str(), "wb"))) {
+        return false;
+    }
+    const bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1 && fwrite(data, sizeof(unsigned int), len, f) == len;
+    if (fclose(f) != 0 || !ok || rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        remove(tmpFileName.c_str());
+        return false;
+    }
+    return true;
+}
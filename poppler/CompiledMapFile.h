@@ -0,0 +1,72 @@
+//========================================================================
+//
+// CompiledMapFile.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef COMPILEDMAPFILE_H
+#define COMPILEDMAPFILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "poppler-config.h"
+#include "poppler_private_export.h"
+
+//------------------------------------------------------------------------
+// CompiledMapFile
+//
+// A CMap or cidToUnicode file compiled to the in-memory form of CMap or
+// CharCodeToUnicode: a header followed by an array of unsigned ints.
+// The file is mapped read-only when the platform allows it, so all the
+// processes using it share one copy.  It records the size and
+// modification time of the file it was compiled from, and is only used
+// while they match.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT CompiledMapFile
+{
+public:
+    enum Kind
+    {
+        cMap = 1,
+        cidToUnicode = 2
+    };
+
+    // Open the compiled file <fileName>, if it holds a map of <kind>
+    // compiled from <sourceFile> as it is now.  Returns nullptr
+    // otherwise.
+    static CompiledMapFile *open(const std::string &fileName, Kind kind, FILE *sourceFile);
+
+    // Write the map <data> (<len> ints), of <kind>, compiled from
+    // <sourceFile>, to <fileName>.  Returns false on error.
+    static bool write(const std::string &fileName, Kind kind, FILE *sourceFile, unsigned int param0, unsigned int param1, const unsigned int *data, size_t len);
+
+    ~CompiledMapFile();
+
+    CompiledMapFile(const CompiledMapFile &) = delete;
+    CompiledMapFile &operator=(const CompiledMapFile &) = delete;
+
+    // The two parameters of the map, specific to its kind.
+    unsigned int getParam0() const { return param0; }
+    unsigned int getParam1() const { return param1; }
+
+    const unsigned int *getData() const { return data; }
+    size_t getLength() const { return length; }
+
+private:
+    CompiledMapFile();
+
+    void *mapping; // the whole file, if it is mapped
+    size_t mappingSize;
+    std::vector<unsigned int> buf; // the data, if it isn't mapped
+    unsigned int param0, param1;
+    const unsigned int *data;
+    size_t length;
+};
+
+#endif
@@ -50,7 +50,6 @@ static void aes256KeyExpansion(DecryptAES256State *s, const unsigned char *objKe
 static void aes256EncryptBlock(DecryptAES256State *s, const unsigned char *in);
 static void aes256DecryptBlock(DecryptAES256State *s, const unsigned char *in, bool last);
 
-static void sha256(unsigned char *msg, int msgLen, unsigned char *hash);
 static void sha384(unsigned char *msg, int msgLen, unsigned char *hash);
 static void sha512(unsigned char *msg, int msgLen, unsigned char *hash);
 
@@ -1456,7 +1455,7 @@ static void sha256HashBlock(const unsigned char *blk, unsigned int *H)
     H[7] += h;
 }
 
-static void sha256(unsigned char *msg, int msgLen, unsigned char *hash)
+void sha256(const unsigned char *msg, int msgLen, unsigned char *hash)
 {
     unsigned char blk[64];
     unsigned int H[8];
@@ -1495,7 +1494,7 @@ static void sha256(unsigned char *msg, int msgLen, unsigned char *hash)
     blk[56] = 0;
     blk[57] = 0;
     blk[58] = 0;
-    blk[59] = 0;
+    blk[59] = (unsigned char)(msgLen >> 29);
     blk[60] = (unsigned char)(msgLen >> 21);
     blk[61] = (unsigned char)(msgLen >> 13);
     blk[62] = (unsigned char)(msgLen >> 5);
@@ -143,5 +143,6 @@ public:
 //------------------------------------------------------------------------
 
 extern void md5(const unsigned char *msg, int msgLen, unsigned char *digest);
+extern void sha256(const unsigned char *msg, int msgLen, unsigned char *hash);
 
 #endif
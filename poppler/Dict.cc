@@ -35,6 +35,7 @@
 
 #include "XRef.h"
 #include "Dict.h"
+#include "ObjectPool.h"
 
 //------------------------------------------------------------------------
 // Dict
@@ -46,11 +47,17 @@ constexpr int SORT_LENGTH_LOWER_LIMIT = 32;
 
 struct Dict::CmpDictEntry
 {
-    bool operator()(const DictEntry &lhs, const DictEntry &rhs) const { return lhs.first < rhs.first; }
-    bool operator()(const DictEntry &lhs, const char *rhs) const { return lhs.first < rhs; }
-    bool operator()(const char *lhs, const DictEntry &rhs) const { return lhs < rhs.first; }
+    bool operator()(const DictEntry &lhs, const DictEntry &rhs) const { return lhs.key < rhs.key; }
+    bool operator()(const DictEntry &lhs, const char *rhs) const { return lhs.key < rhs; }
+    bool operator()(const char *lhs, const DictEntry &rhs) const { return lhs < rhs.key; }
 };
 
+Dict::DictEntry::DictEntry(const char *keyA, Object &&valA) : key(keyA), val(std::move(valA))
+{
+    // keys read by the parser already point into the atom table
+    atom = isAtomName(keyA) ? getAtom(keyA) : findAtom(keyA);
+}
+
 Dict::Dict(XRef *xrefA)
 {
     xref = xrefA;
@@ -59,6 +66,23 @@ Dict::Dict(XRef *xrefA)
     sorted = false;
 }
 
+void *Dict::operator new(size_t size)
+{
+    if (size != sizeof(Dict)) {
+        return ::operator new(size);
+    }
+    return ObjectPool<Dict>::allocate();
+}
+
+void Dict::operator delete(void *p, size_t size)
+{
+    if (size != sizeof(Dict)) {
+        ::operator delete(p);
+        return;
+    }
+    ObjectPool<Dict>::release(p);
+}
+
 Dict::Dict(const Dict *dictA)
 {
     xref = dictA->xref;
@@ -66,7 +90,7 @@ Dict::Dict(const Dict *dictA)
 
     entries.reserve(dictA->entries.size());
     for (const auto &entry : dictA->entries) {
-        entries.emplace_back(entry.first, entry.second.copy());
+        entries.emplace_back(entry.key, entry.atom, entry.val.copy());
     }
 
     sorted = dictA->sorted.load();
@@ -78,8 +102,8 @@ Dict *Dict::copy(XRef *xrefA) const
     Dict *dictA = new Dict(this);
     dictA->xref = xrefA;
     for (auto &entry : dictA->entries) {
-        if (entry.second.getType() == objDict) {
-            entry.second = Object(entry.second.getDict()->copy(xrefA));
+        if (entry.val.getType() == objDict) {
+            entry.val = Object(entry.val.getDict()->copy(xrefA));
         }
     }
     return dictA;
@@ -92,7 +116,7 @@ Dict *Dict::deepCopy() const
 
     dictA->entries.reserve(entries.size());
     for (auto &entry : entries) {
-        dictA->entries.emplace_back(entry.first, entry.second.deepCopy());
+        dictA->entries.emplace_back(entry.key, entry.atom, entry.val.deepCopy());
     }
     return dictA;
 }
@@ -104,7 +128,13 @@ void Dict::add(const char *key, Object &&val)
     sorted = false;
 }
 
-inline const Dict::DictEntry *Dict::find(const char *key) const
+void Dict::reserve(int n)
+{
+    dictLocker();
+    entries.reserve(n);
+}
+
+inline const Dict::DictEntry *Dict::find(const char *key, Atom atom) const
 {
     if (entries.size() >= SORT_LENGTH_LOWER_LIMIT) {
         if (!sorted) {
@@ -120,11 +150,13 @@ inline const Dict::DictEntry *Dict::find(const char *key) const
 
     if (sorted) {
         const auto pos = std::lower_bound(entries.begin(), entries.end(), key, CmpDictEntry {});
-        if (pos != entries.end() && pos->first == key) {
+        if (pos != entries.end() && pos->key == key) {
             return &*pos;
         }
     } else {
-        const auto pos = std::find_if(entries.rbegin(), entries.rend(), [key](const DictEntry &entry) { return entry.first == key; });
+        // a key with an atom can only match an entry with the same atom
+        const auto pos = atom != atomNone ? std::find_if(entries.rbegin(), entries.rend(), [atom](const DictEntry &entry) { return entry.atom == atom; })
+                                          : std::find_if(entries.rbegin(), entries.rend(), [key](const DictEntry &entry) { return entry.atom == atomNone && entry.key == key; });
         if (pos != entries.rend()) {
             return &*pos;
         }
@@ -132,6 +164,11 @@ inline const Dict::DictEntry *Dict::find(const char *key) const
     return nullptr;
 }
 
+inline const Dict::DictEntry *Dict::find(const char *key) const
+{
+    return find(key, isAtomName(key) ? getAtom(key) : findAtom(key));
+}
+
 inline Dict::DictEntry *Dict::find(const char *key)
 {
     return const_cast<DictEntry *>(const_cast<const Dict *>(this)->find(key));
@@ -145,7 +182,7 @@ void Dict::remove(const char *key)
             const auto index = entry - &entries.front();
             entries.erase(entries.begin() + index);
         } else {
-            swap(*entry, entries.back());
+            std::swap(*entry, entries.back());
             entries.pop_back();
         }
     }
@@ -159,7 +196,7 @@ void Dict::set(const char *key, Object &&val)
     }
     dictLocker();
     if (auto *entry = find(key)) {
-        entry->second = std::move(val);
+        entry->val = std::move(val);
     } else {
         add(key, std::move(val));
     }
@@ -167,8 +204,8 @@ void Dict::set(const char *key, Object &&val)
 
 bool Dict::is(const char *type) const
 {
-    if (const auto *entry = find("Type")) {
-        return entry->second.isName(type);
+    if (const auto *entry = find(getAtomName(atomType), atomType)) {
+        return entry->val.isName(type);
     }
     return false;
 }
@@ -176,7 +213,15 @@ bool Dict::is(const char *type) const
 Object Dict::lookup(const char *key, int recursion) const
 {
     if (const auto *entry = find(key)) {
-        return entry->second.fetch(xref, recursion);
+        return entry->val.fetch(xref, recursion);
+    }
+    return Object(objNull);
+}
+
+Object Dict::lookup(Atom key, int recursion) const
+{
+    if (const auto *entry = find(getAtomName(key), key)) {
+        return entry->val.fetch(xref, recursion);
     }
     return Object(objNull);
 }
@@ -184,12 +229,12 @@ Object Dict::lookup(const char *key, int recursion) const
 Object Dict::lookup(const char *key, Ref *returnRef, int recursion) const
 {
     if (const auto *entry = find(key)) {
-        if (entry->second.getType() == objRef) {
-            *returnRef = entry->second.getRef();
+        if (entry->val.getType() == objRef) {
+            *returnRef = entry->val.getRef();
         } else {
             *returnRef = Ref::INVALID();
         }
-        return entry->second.fetch(xref, recursion);
+        return entry->val.fetch(xref, recursion);
     }
     *returnRef = Ref::INVALID();
     return Object(objNull);
@@ -201,18 +246,27 @@ Object Dict::lookupEnsureEncryptedIfNeeded(const char *key) const
     if (!entry)
         return Object(objNull);
 
-    if (entry->second.getType() == objRef && xref->isEncrypted() && !xref->isRefEncrypted(entry->second.getRef())) {
+    if (entry->val.getType() == objRef && xref->isEncrypted() && !xref->isRefEncrypted(entry->val.getRef())) {
         error(errSyntaxError, -1, "{0:s} is not encrypted and the document is. This may be a hacking attempt", key);
         return Object(objNull);
     }
 
-    return entry->second.fetch(xref);
+    return entry->val.fetch(xref);
 }
 
 const Object &Dict::lookupNF(const char *key) const
 {
     if (const auto *entry = find(key)) {
-        return entry->second;
+        return entry->val;
+    }
+    static Object nullObj(objNull);
+    return nullObj;
+}
+
+const Object &Dict::lookupNF(Atom key) const
+{
+    if (const auto *entry = find(getAtomName(key), key)) {
+        return entry->val;
     }
     static Object nullObj(objNull);
     return nullObj;
@@ -234,15 +288,20 @@ bool Dict::lookupInt(const char *key, const char *alt_key, int *value) const
 Object Dict::getVal(int i, Ref *returnRef) const
 {
     const DictEntry &entry = entries[i];
-    if (entry.second.getType() == objRef) {
-        *returnRef = entry.second.getRef();
+    if (entry.val.getType() == objRef) {
+        *returnRef = entry.val.getRef();
     } else {
         *returnRef = Ref::INVALID();
     }
-    return entry.second.fetch(xref);
+    return entry.val.fetch(xref);
 }
 
 bool Dict::hasKey(const char *key) const
 {
     return find(key) != nullptr;
 }
+
+bool Dict::hasKey(Atom key) const
+{
+    return find(getAtomName(key), key) != nullptr;
+}
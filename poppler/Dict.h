@@ -57,6 +57,10 @@ public:
     Dict(const Dict &) = delete;
     Dict &operator=(const Dict &) = delete;
 
+    // Dicts are allocated from a per-thread pool (see ObjectPool).
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
     // Get number of entries.
     int getLength() const { return static_cast<int>(entries.size()); }
 
@@ -67,6 +71,9 @@ public:
     // Add an entry. (Takes ownership of key.)
     void add(char *key, Object &&val) = delete;
 
+    // Make room for <n> entries.
+    void reserve(int n);
+
     // Update the value of an existing entry, otherwise create it
     // val becomes a dead object after the call
     void set(const char *key, Object &&val);
@@ -79,20 +86,22 @@ public:
     // Look up an entry and return the value.  Returns a null object
     // if <key> is not in the dictionary.
     Object lookup(const char *key, int recursion = 0) const;
+    Object lookup(Atom key, int recursion = 0) const;
     // Same as above but if the returned object is a fetched Ref returns such Ref in returnRef, otherwise returnRef is Ref::INVALID()
     Object lookup(const char *key, Ref *returnRef, int recursion = 0) const;
     // Look up an entry and return the value.  Returns a null object
     // if <key> is not in the dictionary or if it is a ref to a non encrypted object in a partially encrypted document
     Object lookupEnsureEncryptedIfNeeded(const char *key) const;
     const Object &lookupNF(const char *key) const;
+    const Object &lookupNF(Atom key) const;
     bool lookupInt(const char *key, const char *alt_key, int *value) const;
 
     // Iterative accessors.
-    const char *getKey(int i) const { return entries[i].first.c_str(); }
-    Object getVal(int i) const { return entries[i].second.fetch(xref); }
+    const char *getKey(int i) const { return entries[i].key.c_str(); }
+    Object getVal(int i) const { return entries[i].val.fetch(xref); }
     // Same as above but if the returned object is a fetched Ref returns such Ref in returnRef, otherwise returnRef is Ref::INVALID()
     Object getVal(int i, Ref *returnRef) const;
-    const Object &getValNF(int i) const { return entries[i].second; }
+    const Object &getValNF(int i) const { return entries[i].val; }
 
     // Set the xref pointer.  This is only used in one special case: the
     // trailer dictionary, which is read before the xref table is
@@ -102,6 +111,7 @@ public:
     XRef *getXRef() const { return xref; }
 
     bool hasKey(const char *key) const;
+    bool hasKey(Atom key) const;
 
 private:
     friend class Object; // for incRef/decRef
@@ -110,7 +120,15 @@ private:
     int incRef() { return ++ref; }
     int decRef() { return --ref; }
 
-    using DictEntry = std::pair<std::string, Object>;
+    struct DictEntry
+    {
+        DictEntry(const char *keyA, Object &&valA);
+        DictEntry(const std::string &keyA, Atom atomA, Object &&valA) : key(keyA), val(std::move(valA)), atom(atomA) { }
+
+        std::string key;
+        Object val;
+        Atom atom; // atom of <key>, or atomNone
+    };
     struct CmpDictEntry;
 
     XRef *xref; // the xref table for this PDF file
@@ -119,6 +137,7 @@ private:
     std::atomic_bool sorted;
     mutable std::recursive_mutex mutex;
 
+    const DictEntry *find(const char *key, Atom atom) const;
     const DictEntry *find(const char *key) const;
     DictEntry *find(const char *key);
 };
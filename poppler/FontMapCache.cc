@@ -0,0 +1,132 @@
+//========================================================================
+//
+// FontMapCache.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <climits>
+
+#include "goo/GooString.h"
+#include "CharCodeToUnicode.h"
+#include "Decrypt.h"
+#include "Stream.h"
+#include "FontMapCache.h"
+
+FontMapCache::FontMapCache(size_t maxSizeA) : maxSize(maxSizeA), size(0) { }
+
+FontMapCache::~FontMapCache() = default;
+
+std::shared_ptr<const std::vector<int>> FontMapCache::getCodeToGIDMap(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    const auto it = entries.find("g" + key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return it->second.map;
+}
+
+void FontMapCache::setCodeToGIDMap(const std::string &key, const int *map, int len)
+{
+    Entry entry;
+    entry.map = std::make_shared<const std::vector<int>>(map, map + len);
+    entry.size = key.size() + (size_t)len * sizeof(int);
+    add("g" + key, std::move(entry));
+}
+
+CharCodeToUnicode *FontMapCache::getToUnicode(Stream *str, int nBits)
+{
+    std::string buf;
+    CharCodeToUnicode *ctu;
+
+    str->fillString(buf);
+    str->close();
+    if (getMaxSize() == 0) {
+        GooString gbuf(std::move(buf));
+        return CharCodeToUnicode::parseCMap(&gbuf, nBits);
+    }
+    if (buf.size() > INT_MAX) {
+        return nullptr;
+    }
+
+    // the key is the digest of the decoded CMap, and
+    // the CMap itself is compared on a hit
+    unsigned char digest[32];
+    sha256((const unsigned char *)buf.data(), buf.size(), digest);
+    const std::string key = "u" + std::to_string(nBits) + ' ' + std::string((const char *)digest, sizeof(digest));
+
+    {
+        std::lock_guard<std::mutex> lock { mutex };
+        const auto it = entries.find(key);
+        if (it != entries.end() && it->second.source == buf) {
+            lru.splice(lru.begin(), lru, it->second.lruPos);
+            ctu = it->second.ctu.get();
+            ctu->incRefCnt();
+            return ctu;
+        }
+    }
+
+    GooString gbuf(buf);
+    if (!(ctu = CharCodeToUnicode::parseCMap(&gbuf, nBits))) {
+        return nullptr;
+    }
+
+    // the parsed CMap holds one Unicode per code, plus the strings of the
+    // multi-character mappings, which are bounded by the CMap size
+    Entry entry;
+    ctu->incRefCnt();
+    entry.ctu = std::shared_ptr<CharCodeToUnicode>(ctu, [](CharCodeToUnicode *c) { c->decRefCnt(); });
+    entry.size = key.size() + sizeof(CharCodeToUnicode) + (size_t)ctu->getLength() * sizeof(Unicode) + 2 * buf.size();
+    entry.source = std::move(buf);
+    add(key, std::move(entry));
+    return ctu;
+}
+
+void FontMapCache::setMaxSize(size_t maxSizeA)
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    maxSize = maxSizeA;
+    shrink(maxSize);
+}
+
+size_t FontMapCache::getMaxSize() const
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    return maxSize;
+}
+
+void FontMapCache::add(const std::string &key, Entry entry)
+{
+    // another thread may have added the same mapping in between, the
+    // newest one replaces it
+    std::lock_guard<std::mutex> lock { mutex };
+    if (entry.size > maxSize) {
+        return;
+    }
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        size -= it->second.size;
+        lru.erase(it->second.lruPos);
+        entries.erase(it);
+    }
+    shrink(maxSize - entry.size);
+    lru.push_front(key);
+    entry.lruPos = lru.begin();
+    size += entry.size;
+    entries[key] = std::move(entry);
+}
+
+void FontMapCache::shrink(size_t newSize)
+{
+    while (!lru.empty() && size > newSize) {
+        const auto last = entries.find(lru.back());
+        size -= last->second.size;
+        entries.erase(last);
+        lru.pop_back();
+    }
+}
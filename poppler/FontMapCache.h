@@ -0,0 +1,79 @@
+//========================================================================
+//
+// FontMapCache.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef FONTMAPCACHE_H
+#define FONTMAPCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "poppler-config.h"
+#include "poppler_private_export.h"
+
+class CharCodeToUnicode;
+class Stream;
+
+//------------------------------------------------------------------------
+// FontMapCache
+//
+// The character mappings which are expensive to build for a font, shared
+// by all the documents of the process: the code-to-GID maps of the CID
+// fonts substituted by system fonts, and the parsed ToUnicode CMaps.
+// Both are immutable once cached; the cache is limited to a total size,
+// and the least recently used mappings are dropped first.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT FontMapCache
+{
+public:
+    explicit FontMapCache(size_t maxSizeA);
+    ~FontMapCache();
+
+    FontMapCache(const FontMapCache &) = delete;
+    FontMapCache &operator=(const FontMapCache &) = delete;
+
+    // Get the code-to-GID map cached for <key> (a description of
+    // everything the map depends on, built by the caller), or nullptr.
+    std::shared_ptr<const std::vector<int>> getCodeToGIDMap(const std::string &key);
+    void setCodeToGIDMap(const std::string &key, const int *map, int len);
+
+    // Returns the ToUnicode CMap of <nBits> bit codes read from <str>,
+    // parsing and caching it if the same CMap isn't cached yet; nullptr
+    // if it can't be parsed.  The caller gets a new reference, and must not modify
+    // the mapping.
+    CharCodeToUnicode *getToUnicode(Stream *str, int nBits);
+
+    void setMaxSize(size_t maxSizeA);
+    size_t getMaxSize() const;
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const std::vector<int>> map;
+        std::shared_ptr<CharCodeToUnicode> ctu; // releases its reference
+        std::string source; // the decoded CMap ctu was parsed from
+        size_t size;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    void add(const std::string &key, Entry entry);
+    void shrink(size_t newSize);
+
+    size_t maxSize;
+    size_t size;
+    std::map<std::string, Entry> entries;
+    std::list<std::string> lru; // most recently used first
+    mutable std::mutex mutex;
+};
+
+#endif
@@ -60,6 +60,7 @@
 #include <cstring>
 #include <cmath>
 #include <memory>
+#include <algorithm>
 #include "goo/gmem.h"
 #include "goo/GooTimer.h"
 #include "GlobalParams.h"
@@ -81,6 +82,7 @@
 #include "Gfx.h"
 #include "ProfileData.h"
 #include "Catalog.h"
+#include "CompiledContent.h"
 #include "OptionalContent.h"
 
 // the MSVC math.h doesn't define this
@@ -132,6 +134,10 @@
 // fill.
 #define patchColorDelta (dblToCol((3. / 256.0)))
 
+// Pixels added around the boxes tested against the clip region, to
+// allow for antialiasing and minimum line widths.
+#define cullMargin 2
+
 //------------------------------------------------------------------------
 // Operator table
 //------------------------------------------------------------------------
@@ -245,7 +251,7 @@ GfxResources::GfxResources(XRef *xrefA, Dict *resDictA, GfxResources *nextA) : g
         // build font dictionary
         Dict *resDict = resDictA->copy(xref);
         fonts = nullptr;
-        const Object &obj1 = resDict->lookupNF("Font");
+        const Object &obj1 = resDict->lookupNF(atomFont);
         if (obj1.isRef()) {
             Object obj2 = obj1.fetch(xref);
             if (obj2.isDict()) {
@@ -257,22 +263,22 @@ GfxResources::GfxResources(XRef *xrefA, Dict *resDictA, GfxResources *nextA) : g
         }
 
         // get XObject dictionary
-        xObjDict = resDict->lookup("XObject");
+        xObjDict = resDict->lookup(atomXObject);
 
         // get color space dictionary
-        colorSpaceDict = resDict->lookup("ColorSpace");
+        colorSpaceDict = resDict->lookup(atomColorSpace);
 
         // get pattern dictionary
-        patternDict = resDict->lookup("Pattern");
+        patternDict = resDict->lookup(atomPattern);
 
         // get shading dictionary
-        shadingDict = resDict->lookup("Shading");
+        shadingDict = resDict->lookup(atomShading);
 
         // get graphics state parameter dictionary
-        gStateDict = resDict->lookup("ExtGState");
+        gStateDict = resDict->lookup(atomExtGState);
 
         // get properties dictionary
-        propertiesDict = resDict->lookup("Properties");
+        propertiesDict = resDict->lookup(atomProperties);
 
         delete resDict;
     } else {
@@ -485,7 +491,9 @@ Gfx::Gfx(PDFDoc *docA, OutputDev *outA, int pageNum, Dict *resDict, double hDPI,
     }
     displayDepth = 0;
     ocState = true;
+    regionCulling = out->useRegionCulling();
     parser = nullptr;
+    compiledPos = -1;
     abortCheckCbk = abortCheckCbkA;
     abortCheckCbkData = abortCheckCbkDataA;
 
@@ -545,7 +553,10 @@ Gfx::Gfx(PDFDoc *docA, OutputDev *outA, Dict *resDict, const PDFRectangle *box,
     }
     displayDepth = 0;
     ocState = true;
+    // the clip region of a sub-page isn't in the device space
+    regionCulling = false;
     parser = nullptr;
+    compiledPos = -1;
     abortCheckCbk = abortCheckCbkA;
     abortCheckCbkData = abortCheckCbkDataA;
 
@@ -644,17 +655,125 @@ void Gfx::display(Object *obj, bool topLevel)
     parser = nullptr;
 }
 
+void Gfx::display(Object *obj, const Object *objRef, bool topLevel)
+{
+    std::vector<Ref> key;
+
+    // the cache is only used with unmodified documents, as modified
+    // objects keep their references
+    if (doc && !doc->getXRef()->isModified() && (obj->isStream() || obj->isArray())) {
+        if (objRef->isRef()) {
+            key.push_back(objRef->getRef());
+        } else if (objRef->isArray()) {
+            for (int i = 0; i < objRef->arrayGetLength(); ++i) {
+                const Object &elem = objRef->arrayGetNF(i);
+                if (!elem.isRef()) {
+                    key.clear();
+                    break;
+                }
+                key.push_back(elem.getRef());
+            }
+        }
+    }
+    if (key.empty() || displayDepth > 100) {
+        display(obj, topLevel);
+        return;
+    }
+
+    // check the content (as display() does) before compiling it
+    if (obj->isArray()) {
+        for (int i = 0; i < obj->arrayGetLength(); ++i) {
+            Object obj2 = obj->arrayGet(i);
+            if (!obj2.isStream()) {
+                error(errSyntaxError, -1, "Weird page contents");
+                return;
+            }
+        }
+    }
+
+    // operands are created with the document's own xref, which, unlike
+    // <xref>, lives as long as the cache
+    const std::shared_ptr<CompiledContent> content = catalog->getCompiledContents()->get(key, doc->getXRef(), obj);
+    if (!content) {
+        display(obj, topLevel);
+        return;
+    }
+    parser = nullptr;
+    go(content.get(), topLevel);
+}
+
 void Gfx::go(bool topLevel)
 {
-    Object obj;
-    Object args[maxArgs];
-    int numArgs, i;
     int lastAbortCheck;
 
     // scan a sequence of objects
     pushStateGuard();
     updateLevel = 1; // make sure even empty pages trigger a call to dump()
     lastAbortCheck = 0;
+    runParser(&lastAbortCheck);
+    popStateGuard();
+
+    // update display
+    if (topLevel && updateLevel > 0) {
+        out->dump();
+    }
+}
+
+void Gfx::go(CompiledContent *content, bool topLevel)
+{
+    int lastAbortCheck;
+    const Goffset oldCompiledPos = compiledPos;
+    bool cont;
+
+    pushStateGuard();
+    updateLevel = 1; // make sure even empty pages trigger a call to dump()
+    lastAbortCheck = 0;
+    // report the operand errors at the point where Gfx::go(bool) would
+    const std::vector<CompiledContent::Op> &ops = content->getOps();
+    const std::vector<CompiledContent::OpError> &errors = content->getErrors();
+    size_t nextError = 0;
+    size_t i;
+    cont = true;
+    for (i = 0; cont && i < ops.size(); ++i) {
+        const CompiledContent::Op &op = ops[i];
+        for (; nextError < errors.size() && errors[nextError].op == i; ++nextError) {
+            error(errors[nextError].category, errors[nextError].pos, "{0:s}", errors[nextError].msg.c_str());
+        }
+        if (i == content->getRestOp()) {
+            parser = content->getRest();
+        }
+        commandAborted = false;
+        compiledPos = op.pos;
+        cont = runOp(content->getName(op), op.op, content->getArgs(op), op.numArgs, &lastAbortCheck);
+    }
+    if (cont) {
+        for (; nextError < errors.size(); ++nextError) {
+            error(errors[nextError].category, errors[nextError].pos, "{0:s}", errors[nextError].msg.c_str());
+        }
+        // an incomplete content goes on with its parser
+        if (content->getRest()) {
+            parser = content->getRest();
+            runParser(&lastAbortCheck);
+        }
+    }
+    parser = nullptr;
+    compiledPos = oldCompiledPos;
+
+    popStateGuard();
+
+    // update display
+    if (topLevel && updateLevel > 0) {
+        out->dump();
+    }
+}
+
+// Run the operators read from <parser>.
+void Gfx::runParser(int *lastAbortCheck)
+{
+    Object obj;
+    Object args[maxArgs];
+    int numArgs, i;
+
     numArgs = 0;
     obj = parser->getObj();
     while (!obj.isEOF()) {
@@ -662,61 +781,14 @@ void Gfx::go(bool topLevel)
 
         // got a command - execute it
         if (obj.isCmd()) {
-            if (printCommands) {
-                obj.print(stdout);
-                for (i = 0; i < numArgs; ++i) {
-                    printf(" ");
-                    args[i].print(stdout);
-                }
-                printf("\n");
-                fflush(stdout);
-            }
-            GooTimer *timer = nullptr;
-
-            if (unlikely(profileCommands)) {
-                timer = new GooTimer();
-            }
-
-            // Run the operation
-            execOp(&obj, args, numArgs);
-
-            // Update the profile information
-            if (unlikely(profileCommands)) {
-                if (auto *const hash = out->getProfileHash()) {
-                    auto &data = (*hash)[obj.getCmd()];
-                    data.addElement(timer->getElapsed());
-                }
-                delete timer;
-            }
+            const bool cont = runOp(obj.getCmd(), findOp(obj.getCmd()), args, numArgs, lastAbortCheck);
             for (i = 0; i < numArgs; ++i)
                 args[i].setToNull(); // Free memory early
             numArgs = 0;
-
-            // periodically update display
-            if (++updateLevel >= 20000) {
-                out->dump();
-                updateLevel = 0;
-                lastAbortCheck = 0;
-            }
-
-            // did the command throw an exception
-            if (commandAborted) {
-                // don't propogate; recursive drawing comes from Form XObjects which
-                // should probably be drawn in a separate context anyway for caching
-                commandAborted = false;
+            if (!cont) {
                 break;
             }
 
-            // check for an abort
-            if (abortCheckCbk) {
-                if (updateLevel - lastAbortCheck > 10) {
-                    if ((*abortCheckCbk)(abortCheckCbkData)) {
-                        break;
-                    }
-                    lastAbortCheck = updateLevel;
-                }
-            }
-
             // got an argument - save it
         } else if (numArgs < maxArgs) {
             args[numArgs++] = std::move(obj);
@@ -748,24 +820,75 @@ void Gfx::go(bool topLevel)
             fflush(stdout);
         }
     }
+}
 
-    popStateGuard();
+// Run one operator, with the periodic display updates and abort
+// checks.  Returns false if the content stream must not be run any
+// further.
+bool Gfx::runOp(const char *name, const Operator *op, const Object args[], int numArgs, int *lastAbortCheck)
+{
+    if (printCommands) {
+        printf("%s", name);
+        for (int i = 0; i < numArgs; ++i) {
+            printf(" ");
+            args[i].print(stdout);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    GooTimer *timer = nullptr;
 
-    // update display
-    if (topLevel && updateLevel > 0) {
+    if (unlikely(profileCommands)) {
+        timer = new GooTimer();
+    }
+
+    // Run the operation
+    execOp(name, op, args, numArgs);
+
+    // Update the profile information
+    if (unlikely(profileCommands)) {
+        if (auto *const hash = out->getProfileHash()) {
+            auto &data = (*hash)[name];
+            data.addElement(timer->getElapsed());
+        }
+        delete timer;
+    }
+
+    // periodically update display
+    if (++updateLevel >= 20000) {
         out->dump();
+        updateLevel = 0;
+        *lastAbortCheck = 0;
     }
+
+    // did the command throw an exception
+    if (commandAborted) {
+        // don't propogate; recursive drawing comes from Form XObjects which
+        // should probably be drawn in a separate context anyway for caching
+        commandAborted = false;
+        return false;
+    }
+
+    // check for an abort
+    if (abortCheckCbk) {
+        if (updateLevel - *lastAbortCheck > 10) {
+            if ((*abortCheckCbk)(abortCheckCbkData)) {
+                return false;
+            }
+            *lastAbortCheck = updateLevel;
+        }
+    }
+
+    return true;
 }
 
-void Gfx::execOp(Object *cmd, Object args[], int numArgs)
+void Gfx::execOp(const char *name, const Operator *op, const Object args[], int numArgs)
 {
-    const Operator *op;
-    Object *argPtr;
+    const Object *argPtr;
     int i;
 
-    // find operator
-    const char *name = cmd->getCmd();
-    if (!(op = findOp(name))) {
+    // unknown operator
+    if (!op) {
         if (ignoreUndef == 0)
             error(errSyntaxError, getPos(), "Unknown operator '{0:s}'", name);
         return;
@@ -827,7 +950,7 @@ const Operator *Gfx::findOp(const char *name)
     return &opTab[a];
 }
 
-bool Gfx::checkArg(Object *arg, TchkType type)
+bool Gfx::checkArg(const Object *arg, TchkType type)
 {
     switch (type) {
     case tchkBool:
@@ -854,31 +977,31 @@ bool Gfx::checkArg(Object *arg, TchkType type)
 
 Goffset Gfx::getPos()
 {
-    return parser ? parser->getPos() : -1;
+    return parser ? parser->getPos() : compiledPos;
 }
 
 //------------------------------------------------------------------------
 // graphics state operators
 //------------------------------------------------------------------------
 
-void Gfx::opSave(Object args[], int numArgs)
+void Gfx::opSave(const Object args[], int numArgs)
 {
     saveState();
 }
 
-void Gfx::opRestore(Object args[], int numArgs)
+void Gfx::opRestore(const Object args[], int numArgs)
 {
     restoreState();
 }
 
-void Gfx::opConcat(Object args[], int numArgs)
+void Gfx::opConcat(const Object args[], int numArgs)
 {
     state->concatCTM(args[0].getNum(), args[1].getNum(), args[2].getNum(), args[3].getNum(), args[4].getNum(), args[5].getNum());
     out->updateCTM(state, args[0].getNum(), args[1].getNum(), args[2].getNum(), args[3].getNum(), args[4].getNum(), args[5].getNum());
     fontChanged = true;
 }
 
-void Gfx::opSetDash(Object args[], int numArgs)
+void Gfx::opSetDash(const Object args[], int numArgs)
 {
     Array *a;
     int length;
@@ -899,37 +1022,37 @@ void Gfx::opSetDash(Object args[], int numArgs)
     out->updateLineDash(state);
 }
 
-void Gfx::opSetFlat(Object args[], int numArgs)
+void Gfx::opSetFlat(const Object args[], int numArgs)
 {
     state->setFlatness((int)args[0].getNum());
     out->updateFlatness(state);
 }
 
-void Gfx::opSetLineJoin(Object args[], int numArgs)
+void Gfx::opSetLineJoin(const Object args[], int numArgs)
 {
     state->setLineJoin(args[0].getInt());
     out->updateLineJoin(state);
 }
 
-void Gfx::opSetLineCap(Object args[], int numArgs)
+void Gfx::opSetLineCap(const Object args[], int numArgs)
 {
     state->setLineCap(args[0].getInt());
     out->updateLineCap(state);
 }
 
-void Gfx::opSetMiterLimit(Object args[], int numArgs)
+void Gfx::opSetMiterLimit(const Object args[], int numArgs)
 {
     state->setMiterLimit(args[0].getNum());
     out->updateMiterLimit(state);
 }
 
-void Gfx::opSetLineWidth(Object args[], int numArgs)
+void Gfx::opSetLineWidth(const Object args[], int numArgs)
 {
     state->setLineWidth(args[0].getNum());
     out->updateLineWidth(state);
 }
 
-void Gfx::opSetExtGState(Object args[], int numArgs)
+void Gfx::opSetExtGState(const Object args[], int numArgs)
 {
     Object obj1, obj2;
     GfxBlendMode mode;
@@ -1290,7 +1413,7 @@ void Gfx::doSoftMask(Object *str, bool alpha, GfxColorSpace *blendingColorSpace,
     drawForm(str, resDict, m, bbox, true, true, blendingColorSpace, isolated, knockout, alpha, transferFunc, backdropColor);
 }
 
-void Gfx::opSetRenderingIntent(Object args[], int numArgs)
+void Gfx::opSetRenderingIntent(const Object args[], int numArgs)
 {
     state->setRenderingIntent(args[0].getName());
 }
@@ -1299,7 +1422,7 @@ void Gfx::opSetRenderingIntent(Object args[], int numArgs)
 // color operators
 //------------------------------------------------------------------------
 
-void Gfx::opSetFillGray(Object args[], int numArgs)
+void Gfx::opSetFillGray(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxColorSpace *colorSpace = nullptr;
@@ -1320,7 +1443,7 @@ void Gfx::opSetFillGray(Object args[], int numArgs)
     out->updateFillColor(state);
 }
 
-void Gfx::opSetStrokeGray(Object args[], int numArgs)
+void Gfx::opSetStrokeGray(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxColorSpace *colorSpace = nullptr;
@@ -1340,7 +1463,7 @@ void Gfx::opSetStrokeGray(Object args[], int numArgs)
     out->updateStrokeColor(state);
 }
 
-void Gfx::opSetFillCMYKColor(Object args[], int numArgs)
+void Gfx::opSetFillCMYKColor(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxColorSpace *colorSpace = nullptr;
@@ -1363,7 +1486,7 @@ void Gfx::opSetFillCMYKColor(Object args[], int numArgs)
     out->updateFillColor(state);
 }
 
-void Gfx::opSetStrokeCMYKColor(Object args[], int numArgs)
+void Gfx::opSetStrokeCMYKColor(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxColorSpace *colorSpace = nullptr;
@@ -1386,7 +1509,7 @@ void Gfx::opSetStrokeCMYKColor(Object args[], int numArgs)
     out->updateStrokeColor(state);
 }
 
-void Gfx::opSetFillRGBColor(Object args[], int numArgs)
+void Gfx::opSetFillRGBColor(const Object args[], int numArgs)
 {
     GfxColorSpace *colorSpace = nullptr;
     GfxColor color;
@@ -1410,7 +1533,7 @@ void Gfx::opSetFillRGBColor(Object args[], int numArgs)
     out->updateFillColor(state);
 }
 
-void Gfx::opSetStrokeRGBColor(Object args[], int numArgs)
+void Gfx::opSetStrokeRGBColor(const Object args[], int numArgs)
 {
     GfxColorSpace *colorSpace = nullptr;
     GfxColor color;
@@ -1433,17 +1556,16 @@ void Gfx::opSetStrokeRGBColor(Object args[], int numArgs)
     out->updateStrokeColor(state);
 }
 
-void Gfx::opSetFillColorSpace(Object args[], int numArgs)
+void Gfx::opSetFillColorSpace(const Object args[], int numArgs)
 {
     GfxColorSpace *colorSpace;
     GfxColor color;
 
     Object obj = res->lookupColorSpace(args[0].getName());
     if (obj.isNull()) {
-        colorSpace = GfxColorSpace::parse(res, &args[0], out, state);
-    } else {
-        colorSpace = GfxColorSpace::parse(res, &obj, out, state);
+        obj = args[0].copy();
     }
+    colorSpace = GfxColorSpace::parse(res, &obj, out, state);
     if (colorSpace) {
         state->setFillPattern(nullptr);
         state->setFillColorSpace(colorSpace);
@@ -1456,7 +1578,7 @@ void Gfx::opSetFillColorSpace(Object args[], int numArgs)
     }
 }
 
-void Gfx::opSetStrokeColorSpace(Object args[], int numArgs)
+void Gfx::opSetStrokeColorSpace(const Object args[], int numArgs)
 {
     GfxColorSpace *colorSpace;
     GfxColor color;
@@ -1464,10 +1586,9 @@ void Gfx::opSetStrokeColorSpace(Object args[], int numArgs)
     state->setStrokePattern(nullptr);
     Object obj = res->lookupColorSpace(args[0].getName());
     if (obj.isNull()) {
-        colorSpace = GfxColorSpace::parse(res, &args[0], out, state);
-    } else {
-        colorSpace = GfxColorSpace::parse(res, &obj, out, state);
+        obj = args[0].copy();
     }
+    colorSpace = GfxColorSpace::parse(res, &obj, out, state);
     if (colorSpace) {
         state->setStrokeColorSpace(colorSpace);
         out->updateStrokeColorSpace(state);
@@ -1479,7 +1600,7 @@ void Gfx::opSetStrokeColorSpace(Object args[], int numArgs)
     }
 }
 
-void Gfx::opSetFillColor(Object args[], int numArgs)
+void Gfx::opSetFillColor(const Object args[], int numArgs)
 {
     GfxColor color;
     int i;
@@ -1496,7 +1617,7 @@ void Gfx::opSetFillColor(Object args[], int numArgs)
     out->updateFillColor(state);
 }
 
-void Gfx::opSetStrokeColor(Object args[], int numArgs)
+void Gfx::opSetStrokeColor(const Object args[], int numArgs)
 {
     GfxColor color;
     int i;
@@ -1513,7 +1634,7 @@ void Gfx::opSetStrokeColor(Object args[], int numArgs)
     out->updateStrokeColor(state);
 }
 
-void Gfx::opSetFillColorN(Object args[], int numArgs)
+void Gfx::opSetFillColorN(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxPattern *pattern;
@@ -1559,7 +1680,7 @@ void Gfx::opSetFillColorN(Object args[], int numArgs)
     }
 }
 
-void Gfx::opSetStrokeColorN(Object args[], int numArgs)
+void Gfx::opSetStrokeColorN(const Object args[], int numArgs)
 {
     GfxColor color;
     GfxPattern *pattern;
@@ -1611,13 +1732,19 @@ void Gfx::opSetStrokeColorN(Object args[], int numArgs)
 // path segment operators
 //------------------------------------------------------------------------
 
-void Gfx::opMoveTo(Object args[], int numArgs)
+void Gfx::opMoveTo(const Object args[], int numArgs)
 {
+    if (!out->needPaths()) {
+        return;
+    }
     state->moveTo(args[0].getNum(), args[1].getNum());
 }
 
-void Gfx::opLineTo(Object args[], int numArgs)
+void Gfx::opLineTo(const Object args[], int numArgs)
 {
+    if (!out->needPaths()) {
+        return;
+    }
     if (!state->isCurPt()) {
         error(errSyntaxError, getPos(), "No current point in lineto");
         return;
@@ -1625,10 +1752,13 @@ void Gfx::opLineTo(Object args[], int numArgs)
     state->lineTo(args[0].getNum(), args[1].getNum());
 }
 
-void Gfx::opCurveTo(Object args[], int numArgs)
+void Gfx::opCurveTo(const Object args[], int numArgs)
 {
     double x1, y1, x2, y2, x3, y3;
 
+    if (!out->needPaths()) {
+        return;
+    }
     if (!state->isCurPt()) {
         error(errSyntaxError, getPos(), "No current point in curveto");
         return;
@@ -1642,10 +1772,13 @@ void Gfx::opCurveTo(Object args[], int numArgs)
     state->curveTo(x1, y1, x2, y2, x3, y3);
 }
 
-void Gfx::opCurveTo1(Object args[], int numArgs)
+void Gfx::opCurveTo1(const Object args[], int numArgs)
 {
     double x1, y1, x2, y2, x3, y3;
 
+    if (!out->needPaths()) {
+        return;
+    }
     if (!state->isCurPt()) {
         error(errSyntaxError, getPos(), "No current point in curveto1");
         return;
@@ -1659,10 +1792,13 @@ void Gfx::opCurveTo1(Object args[], int numArgs)
     state->curveTo(x1, y1, x2, y2, x3, y3);
 }
 
-void Gfx::opCurveTo2(Object args[], int numArgs)
+void Gfx::opCurveTo2(const Object args[], int numArgs)
 {
     double x1, y1, x2, y2, x3, y3;
 
+    if (!out->needPaths()) {
+        return;
+    }
     if (!state->isCurPt()) {
         error(errSyntaxError, getPos(), "No current point in curveto2");
         return;
@@ -1676,10 +1812,13 @@ void Gfx::opCurveTo2(Object args[], int numArgs)
     state->curveTo(x1, y1, x2, y2, x3, y3);
 }
 
-void Gfx::opRectangle(Object args[], int numArgs)
+void Gfx::opRectangle(const Object args[], int numArgs)
 {
     double x, y, w, h;
 
+    if (!out->needPaths()) {
+        return;
+    }
     x = args[0].getNum();
     y = args[1].getNum();
     w = args[2].getNum();
@@ -1691,8 +1830,11 @@ void Gfx::opRectangle(Object args[], int numArgs)
     state->closePath();
 }
 
-void Gfx::opClosePath(Object args[], int numArgs)
+void Gfx::opClosePath(const Object args[], int numArgs)
 {
+    if (!out->needPaths()) {
+        return;
+    }
     if (!state->isCurPt()) {
         error(errSyntaxError, getPos(), "No current point in closepath");
         return;
@@ -1704,19 +1846,19 @@ void Gfx::opClosePath(Object args[], int numArgs)
 // path painting operators
 //------------------------------------------------------------------------
 
-void Gfx::opEndPath(Object args[], int numArgs)
+void Gfx::opEndPath(const Object args[], int numArgs)
 {
     doEndPath();
 }
 
-void Gfx::opStroke(Object args[], int numArgs)
+void Gfx::opStroke(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in stroke");
         return;
     }
     if (state->isPath()) {
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getStrokeColorSpace()->getMode() == csPattern) {
                 doPatternStroke();
             } else {
@@ -1727,7 +1869,7 @@ void Gfx::opStroke(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opCloseStroke(Object * /*args[]*/, int /*numArgs*/)
+void Gfx::opCloseStroke(const Object * /*args[]*/, int /*numArgs*/)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in closepath/stroke");
@@ -1735,7 +1877,7 @@ void Gfx::opCloseStroke(Object * /*args[]*/, int /*numArgs*/)
     }
     if (state->isPath()) {
         state->closePath();
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getStrokeColorSpace()->getMode() == csPattern) {
                 doPatternStroke();
             } else {
@@ -1746,14 +1888,14 @@ void Gfx::opCloseStroke(Object * /*args[]*/, int /*numArgs*/)
     doEndPath();
 }
 
-void Gfx::opFill(Object args[], int numArgs)
+void Gfx::opFill(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in fill");
         return;
     }
     if (state->isPath()) {
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(false)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(false);
             } else {
@@ -1764,14 +1906,14 @@ void Gfx::opFill(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opEOFill(Object args[], int numArgs)
+void Gfx::opEOFill(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in eofill");
         return;
     }
     if (state->isPath()) {
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(false)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(true);
             } else {
@@ -1782,14 +1924,14 @@ void Gfx::opEOFill(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opFillStroke(Object args[], int numArgs)
+void Gfx::opFillStroke(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in fill/stroke");
         return;
     }
     if (state->isPath()) {
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(false);
             } else {
@@ -1805,7 +1947,7 @@ void Gfx::opFillStroke(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opCloseFillStroke(Object args[], int numArgs)
+void Gfx::opCloseFillStroke(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in closepath/fill/stroke");
@@ -1813,7 +1955,7 @@ void Gfx::opCloseFillStroke(Object args[], int numArgs)
     }
     if (state->isPath()) {
         state->closePath();
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(false);
             } else {
@@ -1829,14 +1971,14 @@ void Gfx::opCloseFillStroke(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opEOFillStroke(Object args[], int numArgs)
+void Gfx::opEOFillStroke(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in eofill/stroke");
         return;
     }
     if (state->isPath()) {
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(true);
             } else {
@@ -1852,7 +1994,7 @@ void Gfx::opEOFillStroke(Object args[], int numArgs)
     doEndPath();
 }
 
-void Gfx::opCloseEOFillStroke(Object args[], int numArgs)
+void Gfx::opCloseEOFillStroke(const Object args[], int numArgs)
 {
     if (!state->isCurPt()) {
         // error(errSyntaxError, getPos(), "No path in closepath/eofill/stroke");
@@ -1860,7 +2002,7 @@ void Gfx::opCloseEOFillStroke(Object args[], int numArgs)
     }
     if (state->isPath()) {
         state->closePath();
-        if (ocState) {
+        if (ocState && !isPathOutsideClip(true)) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternFill(true);
             } else {
@@ -2333,13 +2475,13 @@ void Gfx::doShadingPatternFill(GfxShadingPattern *sPat, bool stroke, bool eoFill
     restoreStateStack(savedState);
 }
 
-void Gfx::opShFill(Object args[], int numArgs)
+void Gfx::opShFill(const Object args[], int numArgs)
 {
     GfxShading *shading;
     GfxState *savedState;
     double xMin, yMin, xMax, yMax;
 
-    if (!ocState) {
+    if (!ocState || !out->needNonText()) {
         return;
     }
 
@@ -3558,16 +3700,115 @@ void Gfx::doEndPath()
     state->clearPath();
 }
 
+// Returns true if the device space box (xMin, yMin, xMax, yMax) is
+// entirely outside the clip region, and region culling is enabled.
+bool Gfx::isOutsideClip(double xMin, double yMin, double xMax, double yMax) const
+{
+    double cxMin, cyMin, cxMax, cyMax;
+
+    if (!regionCulling) {
+        return false;
+    }
+    state->getClipBBox(&cxMin, &cyMin, &cxMax, &cyMax);
+    return xMax < cxMin - cullMargin || xMin > cxMax + cullMargin || yMax < cyMin - cullMargin || yMin > cyMax + cullMargin;
+}
+
+// Returns true if filling -- or stroking, if <stroke> is set -- the
+// current path can't draw inside the clip region.  Curves are within
+// the hull of their control points, so the bounding box of all the
+// points is enough.
+bool Gfx::isPathOutsideClip(bool stroke) const
+{
+    const GfxPath *path;
+    const GfxSubpath *subpath;
+    double xMin, yMin, xMax, yMax, x, y, w;
+    const double *ctm;
+    bool first;
+
+    if (!regionCulling) {
+        return false;
+    }
+    path = state->getPath();
+    xMin = yMin = xMax = yMax = 0;
+    first = true;
+    for (int i = 0; i < path->getNumSubpaths(); ++i) {
+        subpath = path->getSubpath(i);
+        for (int j = 0; j < subpath->getNumPoints(); ++j) {
+            state->transform(subpath->getX(j), subpath->getY(j), &x, &y);
+            if (first) {
+                xMin = xMax = x;
+                yMin = yMax = y;
+                first = false;
+            } else {
+                xMin = std::min(xMin, x);
+                xMax = std::max(xMax, x);
+                yMin = std::min(yMin, y);
+                yMax = std::max(yMax, y);
+            }
+        }
+    }
+    if (first) {
+        return false;
+    }
+    if (stroke) {
+        // a stroke extends by half the line width, and up to the miter
+        // limit times that at the joins; the norm of the CTM bounds its
+        // largest scaling
+        ctm = state->getCTM();
+        w = 0.5 * state->getLineWidth() * sqrt(ctm[0] * ctm[0] + ctm[1] * ctm[1] + ctm[2] * ctm[2] + ctm[3] * ctm[3]) * std::max(state->getMiterLimit(), 1.5);
+        xMin -= w;
+        yMin -= w;
+        xMax += w;
+        yMax += w;
+    }
+    return isOutsideClip(xMin, yMin, xMax, yMax);
+}
+
+// Returns true if the rectangle <rect> (x0, y0, x1, y1), transformed by
+// <mat> (if not null) and then by the CTM, is entirely outside the clip
+// region.
+bool Gfx::isRectOutsideClip(const double *mat, const double *rect) const
+{
+    double xMin, yMin, xMax, yMax, x, y, tx, ty;
+
+    if (!regionCulling) {
+        return false;
+    }
+    xMin = yMin = xMax = yMax = 0;
+    for (int i = 0; i < 4; ++i) {
+        x = rect[(i & 1) ? 2 : 0];
+        y = rect[(i & 2) ? 3 : 1];
+        if (mat) {
+            tx = mat[0] * x + mat[2] * y + mat[4];
+            ty = mat[1] * x + mat[3] * y + mat[5];
+        } else {
+            tx = x;
+            ty = y;
+        }
+        state->transform(tx, ty, &x, &y);
+        if (i == 0) {
+            xMin = xMax = x;
+            yMin = yMax = y;
+        } else {
+            xMin = std::min(xMin, x);
+            xMax = std::max(xMax, x);
+            yMin = std::min(yMin, y);
+            yMax = std::max(yMax, y);
+        }
+    }
+    return isOutsideClip(xMin, yMin, xMax, yMax);
+}
+
 //------------------------------------------------------------------------
 // path clipping operators
 //------------------------------------------------------------------------
 
-void Gfx::opClip(Object args[], int numArgs)
+void Gfx::opClip(const Object args[], int numArgs)
 {
     clip = clipNormal;
 }
 
-void Gfx::opEOClip(Object args[], int numArgs)
+void Gfx::opEOClip(const Object args[], int numArgs)
 {
     clip = clipEO;
 }
@@ -3576,7 +3817,7 @@ void Gfx::opEOClip(Object args[], int numArgs)
 // text object operators
 //------------------------------------------------------------------------
 
-void Gfx::opBeginText(Object args[], int numArgs)
+void Gfx::opBeginText(const Object args[], int numArgs)
 {
     out->beginTextObject(state);
     state->setTextMat(1, 0, 0, 1, 0, 0);
@@ -3586,7 +3827,7 @@ void Gfx::opBeginText(Object args[], int numArgs)
     fontChanged = true;
 }
 
-void Gfx::opEndText(Object args[], int numArgs)
+void Gfx::opEndText(const Object args[], int numArgs)
 {
     out->endTextObject(state);
 }
@@ -3595,13 +3836,13 @@ void Gfx::opEndText(Object args[], int numArgs)
 // text state operators
 //------------------------------------------------------------------------
 
-void Gfx::opSetCharSpacing(Object args[], int numArgs)
+void Gfx::opSetCharSpacing(const Object args[], int numArgs)
 {
     state->setCharSpace(args[0].getNum());
     out->updateCharSpace(state);
 }
 
-void Gfx::opSetFont(Object args[], int numArgs)
+void Gfx::opSetFont(const Object args[], int numArgs)
 {
     GfxFont *font;
 
@@ -3622,30 +3863,30 @@ void Gfx::opSetFont(Object args[], int numArgs)
     fontChanged = true;
 }
 
-void Gfx::opSetTextLeading(Object args[], int numArgs)
+void Gfx::opSetTextLeading(const Object args[], int numArgs)
 {
     state->setLeading(args[0].getNum());
 }
 
-void Gfx::opSetTextRender(Object args[], int numArgs)
+void Gfx::opSetTextRender(const Object args[], int numArgs)
 {
     state->setRender(args[0].getInt());
     out->updateRender(state);
 }
 
-void Gfx::opSetTextRise(Object args[], int numArgs)
+void Gfx::opSetTextRise(const Object args[], int numArgs)
 {
     state->setRise(args[0].getNum());
     out->updateRise(state);
 }
 
-void Gfx::opSetWordSpacing(Object args[], int numArgs)
+void Gfx::opSetWordSpacing(const Object args[], int numArgs)
 {
     state->setWordSpace(args[0].getNum());
     out->updateWordSpace(state);
 }
 
-void Gfx::opSetHorizScaling(Object args[], int numArgs)
+void Gfx::opSetHorizScaling(const Object args[], int numArgs)
 {
     state->setHorizScaling(args[0].getNum());
     out->updateHorizScaling(state);
@@ -3656,7 +3897,7 @@ void Gfx::opSetHorizScaling(Object args[], int numArgs)
 // text positioning operators
 //------------------------------------------------------------------------
 
-void Gfx::opTextMove(Object args[], int numArgs)
+void Gfx::opTextMove(const Object args[], int numArgs)
 {
     double tx, ty;
 
@@ -3666,7 +3907,7 @@ void Gfx::opTextMove(Object args[], int numArgs)
     out->updateTextPos(state);
 }
 
-void Gfx::opTextMoveSet(Object args[], int numArgs)
+void Gfx::opTextMoveSet(const Object args[], int numArgs)
 {
     double tx, ty;
 
@@ -3678,7 +3919,7 @@ void Gfx::opTextMoveSet(Object args[], int numArgs)
     out->updateTextPos(state);
 }
 
-void Gfx::opSetTextMatrix(Object args[], int numArgs)
+void Gfx::opSetTextMatrix(const Object args[], int numArgs)
 {
     state->setTextMat(args[0].getNum(), args[1].getNum(), args[2].getNum(), args[3].getNum(), args[4].getNum(), args[5].getNum());
     state->textMoveTo(0, 0);
@@ -3687,7 +3928,7 @@ void Gfx::opSetTextMatrix(Object args[], int numArgs)
     fontChanged = true;
 }
 
-void Gfx::opTextNextLine(Object args[], int numArgs)
+void Gfx::opTextNextLine(const Object args[], int numArgs)
 {
     double tx, ty;
 
@@ -3701,7 +3942,7 @@ void Gfx::opTextNextLine(Object args[], int numArgs)
 // text string operators
 //------------------------------------------------------------------------
 
-void Gfx::opShowText(Object args[], int numArgs)
+void Gfx::opShowText(const Object args[], int numArgs)
 {
     if (!state->getFont()) {
         error(errSyntaxError, getPos(), "No font in show");
@@ -3719,7 +3960,7 @@ void Gfx::opShowText(Object args[], int numArgs)
     }
 }
 
-void Gfx::opMoveShowText(Object args[], int numArgs)
+void Gfx::opMoveShowText(const Object args[], int numArgs)
 {
     double tx, ty;
 
@@ -3743,7 +3984,7 @@ void Gfx::opMoveShowText(Object args[], int numArgs)
     }
 }
 
-void Gfx::opMoveSetShowText(Object args[], int numArgs)
+void Gfx::opMoveSetShowText(const Object args[], int numArgs)
 {
     double tx, ty;
 
@@ -3771,7 +4012,7 @@ void Gfx::opMoveSetShowText(Object args[], int numArgs)
     }
 }
 
-void Gfx::opShowSpaceText(Object args[], int numArgs)
+void Gfx::opShowSpaceText(const Object args[], int numArgs)
 {
     Array *a;
     int wMode;
@@ -3827,7 +4068,7 @@ void Gfx::doShowText(const GooString *s)
     double x, y, dx, dy, dx2, dy2, curX, curY, tdx, tdy, ddx, ddy;
     double originX, originY, tOriginX, tOriginY;
     double x0, y0, x1, y1;
-    double tmp[4], newCTM[6];
+    double tmp[4], newCTM[6], cullRadius;
     const double *oldCTM, *mat;
     Dict *resDict;
     Parser *oldParser;
@@ -3930,9 +4171,14 @@ void Gfx::doShowText(const GooString *s)
                         }
                     }
                     if (displayCharProc) {
+                        // the output device can draw the glyph in its
+                        // own space, which the clip region doesn't match
+                        const bool savedRegionCulling = regionCulling;
+                        regionCulling = false;
                         ++displayDepth;
                         display(&charProc, false);
                         --displayDepth;
+                        regionCulling = savedRegionCulling;
 
                         if (refNum != -1) {
                             charProcDrawing.erase(charProcDrawingIt);
@@ -3965,6 +4211,25 @@ void Gfx::doShowText(const GooString *s)
         parser = oldParser;
 
     } else if (out->useDrawChar()) {
+        // skip the glyphs outside the clip region; only filled text is
+        // culled, as clipping to text needs all the glyphs.  Font
+        // bounding boxes are often wrong, so at least two ems around
+        // the origin are kept.
+        cullRadius = -1;
+        if (regionCulling && render == 0) {
+            mat = font->getFontBBox();
+            cullRadius = 1;
+            for (int i = 0; i < 4; ++i) {
+                cullRadius = std::max(cullRadius, fabs(mat[i]));
+            }
+            oldCTM = state->getCTM();
+            mat = state->getTextMat();
+            tmp[0] = mat[0] * oldCTM[0] + mat[1] * oldCTM[2];
+            tmp[1] = mat[0] * oldCTM[1] + mat[1] * oldCTM[3];
+            tmp[2] = mat[2] * oldCTM[0] + mat[3] * oldCTM[2];
+            tmp[3] = mat[2] * oldCTM[1] + mat[3] * oldCTM[3];
+            cullRadius *= 2 * fabs(state->getFontSize()) * std::max(fabs(state->getHorizScaling()), 1.0) * sqrt(tmp[0] * tmp[0] + tmp[1] * tmp[1] + tmp[2] * tmp[2] + tmp[3] * tmp[3]);
+        }
         p = s->c_str();
         len = s->getLength();
         while (len > 0) {
@@ -3987,8 +4252,14 @@ void Gfx::doShowText(const GooString *s)
             originX *= state->getFontSize();
             originY *= state->getFontSize();
             state->textTransformDelta(originX, originY, &tOriginX, &tOriginY);
-            if (ocState)
-                out->drawChar(state, state->getCurX() + riseX, state->getCurY() + riseY, tdx, tdy, tOriginX, tOriginY, code, n, u, uLen);
+            if (ocState) {
+                if (cullRadius >= 0) {
+                    state->transform(state->getCurX() + riseX - tOriginX, state->getCurY() + riseY - tOriginY, &x, &y);
+                }
+                if (cullRadius < 0 || !isOutsideClip(x - cullRadius, y - cullRadius, x + cullRadius, y + cullRadius)) {
+                    out->drawChar(state, state->getCurX() + riseX, state->getCurY() + riseY, tdx, tdy, tOriginX, tOriginY, code, n, u, uLen);
+                }
+            }
             state->shift(tdx, tdy);
             p += n;
             len -= n;
@@ -4082,7 +4353,7 @@ void Gfx::doIncCharCount(const GooString *s)
 // XObject operators
 //------------------------------------------------------------------------
 
-void Gfx::opXObject(Object args[], int numArgs)
+void Gfx::opXObject(const Object args[], int numArgs)
 {
     const char *name;
 
@@ -4105,7 +4376,7 @@ void Gfx::opXObject(Object args[], int numArgs)
         out->opiBegin(state, opiDict.getDict());
     }
 #endif
-    Object obj2 = obj1.streamGetDict()->lookup("Subtype");
+    Object obj2 = obj1.streamGetDict()->lookup(atomSubtype);
     if (obj2.isName("Image")) {
         if (out->needNonText()) {
             Object refObj = res->lookupXObjectNF(name);
@@ -4113,9 +4384,10 @@ void Gfx::opXObject(Object args[], int numArgs)
         }
     } else if (obj2.isName("Form")) {
         Object refObj = res->lookupXObjectNF(name);
-        bool shouldDoForm = true;
+        // devices that only want text can skip forms which show none
+        bool shouldDoForm = out->needNonText() || !refObj.isRef() || catalog->formHasText(refObj.getRef());
         std::set<int>::iterator drawingFormIt;
-        if (refObj.isRef()) {
+        if (refObj.isRef() && shouldDoForm) {
             const int num = refObj.getRef().num;
             if (formsDrawing.find(num) == formsDrawing.end()) {
                 drawingFormIt = formsDrawing.insert(num).first;
@@ -4129,7 +4401,7 @@ void Gfx::opXObject(Object args[], int numArgs)
             } else {
                 Ref ref = refObj.isRef() ? refObj.getRef() : Ref::INVALID();
                 out->beginForm(ref);
-                doForm(&obj1);
+                doForm(&obj1, ref);
                 out->endForm(ref);
             }
         }
@@ -4167,7 +4439,9 @@ void Gfx::doImage(Object *ref, Stream *str, bool inlineImg)
     bool maskInvert;
     bool maskInterpolate;
     Stream *maskStr;
+    bool culled;
     int i, n;
+    static const double unitSquare[4] = { 0, 0, 1, 1 };
 
     // get info from the stream
     bits = 0;
@@ -4177,6 +4451,10 @@ void Gfx::doImage(Object *ref, Stream *str, bool inlineImg)
     // get stream dict
     dict = str->getDict();
 
+    // images are drawn in the unit square; the ones entirely outside
+    // the clip region are not decoded at all
+    culled = isRectOutsideClip(nullptr, unitSquare);
+
     // check for optional content key
     if (ref) {
         const Object &objOC = dict->lookupNF("OC");
@@ -4270,16 +4548,14 @@ void Gfx::doImage(Object *ref, Stream *str, bool inlineImg)
         }
 
         // if drawing is disabled, skip over inline image data
-        if (!ocState || !out->needNonText()) {
+        if (!ocState || !out->needNonText() || (culled && inlineImg)) {
             str->reset();
             n = height * ((width + 7) / 8);
-            for (i = 0; i < n; ++i) {
-                str->getChar();
-            }
+            str->discardChars(n);
             str->close();
 
             // draw it
-        } else {
+        } else if (!culled) {
             if (state->getFillColorSpace()->getMode() == csPattern) {
                 doPatternImageMask(ref, str, width, height, invert, inlineImg);
             } else {
@@ -4555,16 +4831,14 @@ void Gfx::doImage(Object *ref, Stream *str, bool inlineImg)
         }
 
         // if drawing is disabled, skip over inline image data
-        if (!ocState || !out->needNonText()) {
+        if (!ocState || !out->needNonText() || (culled && inlineImg)) {
             str->reset();
             n = height * ((width * colorMap.getNumPixelComps() * colorMap.getBits() + 7) / 8);
-            for (i = 0; i < n; ++i) {
-                str->getChar();
-            }
+            str->discardChars(n);
             str->close();
 
             // draw it
-        } else {
+        } else if (!culled) {
             if (haveSoftMask) {
                 out->drawSoftMaskedImage(state, ref, str, width, height, &colorMap, interpolate, maskStr, maskWidth, maskHeight, maskColorMap.get(), maskInterpolate);
             } else if (haveExplicitMask) {
@@ -4646,7 +4920,7 @@ bool Gfx::checkTransparencyGroup(Dict *resDict)
     return transpGroup;
 }
 
-void Gfx::doForm(Object *str)
+void Gfx::doForm(Object *str, Ref strRef)
 {
     Dict *dict;
     bool transpGroup, isolated, knockout;
@@ -4713,6 +4987,13 @@ void Gfx::doForm(Object *str)
         m[5] = 0;
     }
 
+    // the form is clipped to its bounding box, skip it if that is
+    // outside the clip region
+    if (isRectOutsideClip(m, bbox)) {
+        ocState = ocSaved;
+        return;
+    }
+
     // get resources
     Object resObj = dict->lookup("Resources");
     resDict = resObj.isDict() ? resObj.getDict() : nullptr;
@@ -4741,7 +5022,7 @@ void Gfx::doForm(Object *str)
     }
 
     // draw it
-    drawForm(str, resDict, m, bbox, transpGroup, false, blendingColorSpace, isolated, knockout);
+    drawForm(str, resDict, m, bbox, transpGroup, false, blendingColorSpace, isolated, knockout, false, nullptr, nullptr, strRef);
 
     if (blendingColorSpace) {
         delete blendingColorSpace;
@@ -4751,7 +5032,7 @@ void Gfx::doForm(Object *str)
 }
 
 void Gfx::drawForm(Object *str, Dict *resDict, const double *matrix, const double *bbox, bool transpGroup, bool softMask, GfxColorSpace *blendingColorSpace, bool isolated, bool knockout, bool alpha, Function *transferFunc,
-                   GfxColor *backdropColor)
+                   GfxColor *backdropColor, Ref strRef)
 {
     Parser *oldParser;
     GfxState *savedState;
@@ -4811,7 +5092,12 @@ void Gfx::drawForm(Object *str, Dict *resDict, const double *matrix, const doubl
 
     // draw the form
     ++displayDepth;
-    display(str, false);
+    if (strRef != Ref::INVALID()) {
+        const Object strRefObj(strRef);
+        display(str, &strRefObj, false);
+    } else {
+        display(str, false);
+    }
     --displayDepth;
 
     if (stateBefore != state) {
@@ -4856,7 +5142,7 @@ void Gfx::drawForm(Object *str, Dict *resDict, const double *matrix, const doubl
 // in-line image operators
 //------------------------------------------------------------------------
 
-void Gfx::opBeginImage(Object args[], int numArgs)
+void Gfx::opBeginImage(const Object args[], int numArgs)
 {
     Stream *str;
     int c1, c2;
@@ -4917,12 +5203,12 @@ Stream *Gfx::buildImageStream()
     return str;
 }
 
-void Gfx::opImageData(Object args[], int numArgs)
+void Gfx::opImageData(const Object args[], int numArgs)
 {
     error(errInternal, getPos(), "Got 'ID' operator");
 }
 
-void Gfx::opEndImage(Object args[], int numArgs)
+void Gfx::opEndImage(const Object args[], int numArgs)
 {
     error(errInternal, getPos(), "Got 'EI' operator");
 }
@@ -4931,12 +5217,12 @@ void Gfx::opEndImage(Object args[], int numArgs)
 // type 3 font operators
 //------------------------------------------------------------------------
 
-void Gfx::opSetCharWidth(Object args[], int numArgs)
+void Gfx::opSetCharWidth(const Object args[], int numArgs)
 {
     out->type3D0(state, args[0].getNum(), args[1].getNum());
 }
 
-void Gfx::opSetCacheDevice(Object args[], int numArgs)
+void Gfx::opSetCacheDevice(const Object args[], int numArgs)
 {
     out->type3D1(state, args[0].getNum(), args[1].getNum(), args[2].getNum(), args[3].getNum(), args[4].getNum(), args[5].getNum());
 }
@@ -4945,12 +5231,12 @@ void Gfx::opSetCacheDevice(Object args[], int numArgs)
 // compatibility operators
 //------------------------------------------------------------------------
 
-void Gfx::opBeginIgnoreUndef(Object args[], int numArgs)
+void Gfx::opBeginIgnoreUndef(const Object args[], int numArgs)
 {
     ++ignoreUndef;
 }
 
-void Gfx::opEndIgnoreUndef(Object args[], int numArgs)
+void Gfx::opEndIgnoreUndef(const Object args[], int numArgs)
 {
     if (ignoreUndef > 0)
         --ignoreUndef;
@@ -5001,7 +5287,7 @@ bool Gfx::contentIsHidden()
     return hidden;
 }
 
-void Gfx::opBeginMarkedContent(Object args[], int numArgs)
+void Gfx::opBeginMarkedContent(const Object args[], int numArgs)
 {
     // push a new stack entry
     pushMarkedContent();
@@ -5052,7 +5338,7 @@ void Gfx::opBeginMarkedContent(Object args[], int numArgs)
     }
 }
 
-void Gfx::opEndMarkedContent(Object args[], int numArgs)
+void Gfx::opEndMarkedContent(const Object args[], int numArgs)
 {
     if (!mcStack) {
         error(errSyntaxWarning, getPos(), "Mismatched EMC operator");
@@ -5072,7 +5358,7 @@ void Gfx::opEndMarkedContent(Object args[], int numArgs)
     out->endMarkedContent(state);
 }
 
-void Gfx::opMarkPoint(Object args[], int numArgs)
+void Gfx::opMarkPoint(const Object args[], int numArgs)
 {
     if (printCommands) {
         printf("  mark point: %s ", args[0].getName());
@@ -72,6 +72,7 @@ class PDFRectangle;
 class AnnotBorder;
 class AnnotColor;
 class Catalog;
+class CompiledContent;
 struct MarkedContentStack;
 
 //------------------------------------------------------------------------
@@ -103,7 +104,7 @@ struct Operator
     char name[4];
     int numArgs;
     TchkType tchk[maxArgs];
-    void (Gfx::*func)(Object args[], int numArgs);
+    void (Gfx::*func)(const Object args[], int numArgs);
 };
 
 //------------------------------------------------------------------------
@@ -171,6 +172,12 @@ public:
     // Interpret a stream or array of streams.
     void display(Object *obj, bool topLevel = true);
 
+    // Same as above, for content that is known by reference: <objRef>
+    // is <obj> before it was fetched, i.e., a reference or an array of
+    // references.  The content is parsed once and its compiled form is
+    // kept by the Catalog for later runs.
+    void display(Object *obj, const Object *objRef, bool topLevel = true);
+
     // Display an annotation, given its appearance (a Form XObject),
     // border style, and bounding box (in default user space).
     void drawAnnot(Object *str, AnnotBorder *border, AnnotColor *aColor, double xMin, double yMin, double xMax, double yMax, int rotate);
@@ -192,8 +199,13 @@ public:
 
     bool checkTransparencyGroup(Dict *resDict);
 
+    // <strRef> is the reference of <str>, if known.
     void drawForm(Object *str, Dict *resDict, const double *matrix, const double *bbox, bool transpGroup = false, bool softMask = false, GfxColorSpace *blendingColorSpace = nullptr, bool isolated = false, bool knockout = false,
-                  bool alpha = false, Function *transferFunc = nullptr, GfxColor *backdropColor = nullptr);
+                  bool alpha = false, Function *transferFunc = nullptr, GfxColor *backdropColor = nullptr, Ref strRef = Ref::INVALID());
+
+    // Look up the operator <name> in the operator table.  Returns
+    // nullptr for unknown operators.
+    static const Operator *findOp(const char *name);
 
     void pushResources(Dict *resDict);
     void popResources();
@@ -221,10 +233,14 @@ private:
     int displayDepth;
     bool ocState; // true if drawing is enabled, false if
                   //   disabled
+    bool regionCulling; // true if the drawing operations outside
+                        //   the clip region are skipped
 
     MarkedContentStack *mcStack; // current BMC/EMC stack
 
     Parser *parser; // parser for page content stream(s)
+    Goffset compiledPos; // position of the current operator, when
+                         //   running compiled content
 
     std::set<int> formsDrawing; // the forms/patterns that are being drawn
     std::set<int> charProcDrawing; // the charProc that are being drawn
@@ -236,67 +252,69 @@ private:
     static const Operator opTab[]; // table of operators
 
     void go(bool topLevel);
-    void execOp(Object *cmd, Object args[], int numArgs);
-    const Operator *findOp(const char *name);
-    bool checkArg(Object *arg, TchkType type);
+    void go(CompiledContent *content, bool topLevel);
+    void runParser(int *lastAbortCheck);
+    bool runOp(const char *name, const Operator *op, const Object args[], int numArgs, int *lastAbortCheck);
+    void execOp(const char *name, const Operator *op, const Object args[], int numArgs);
+    bool checkArg(const Object *arg, TchkType type);
     Goffset getPos();
 
     int bottomGuard();
 
     // graphics state operators
-    void opSave(Object args[], int numArgs);
-    void opRestore(Object args[], int numArgs);
-    void opConcat(Object args[], int numArgs);
-    void opSetDash(Object args[], int numArgs);
-    void opSetFlat(Object args[], int numArgs);
-    void opSetLineJoin(Object args[], int numArgs);
-    void opSetLineCap(Object args[], int numArgs);
-    void opSetMiterLimit(Object args[], int numArgs);
-    void opSetLineWidth(Object args[], int numArgs);
-    void opSetExtGState(Object args[], int numArgs);
+    void opSave(const Object args[], int numArgs);
+    void opRestore(const Object args[], int numArgs);
+    void opConcat(const Object args[], int numArgs);
+    void opSetDash(const Object args[], int numArgs);
+    void opSetFlat(const Object args[], int numArgs);
+    void opSetLineJoin(const Object args[], int numArgs);
+    void opSetLineCap(const Object args[], int numArgs);
+    void opSetMiterLimit(const Object args[], int numArgs);
+    void opSetLineWidth(const Object args[], int numArgs);
+    void opSetExtGState(const Object args[], int numArgs);
     void doSoftMask(Object *str, bool alpha, GfxColorSpace *blendingColorSpace, bool isolated, bool knockout, Function *transferFunc, GfxColor *backdropColor);
-    void opSetRenderingIntent(Object args[], int numArgs);
+    void opSetRenderingIntent(const Object args[], int numArgs);
 
     // color operators
-    void opSetFillGray(Object args[], int numArgs);
-    void opSetStrokeGray(Object args[], int numArgs);
-    void opSetFillCMYKColor(Object args[], int numArgs);
-    void opSetStrokeCMYKColor(Object args[], int numArgs);
-    void opSetFillRGBColor(Object args[], int numArgs);
-    void opSetStrokeRGBColor(Object args[], int numArgs);
-    void opSetFillColorSpace(Object args[], int numArgs);
-    void opSetStrokeColorSpace(Object args[], int numArgs);
-    void opSetFillColor(Object args[], int numArgs);
-    void opSetStrokeColor(Object args[], int numArgs);
-    void opSetFillColorN(Object args[], int numArgs);
-    void opSetStrokeColorN(Object args[], int numArgs);
+    void opSetFillGray(const Object args[], int numArgs);
+    void opSetStrokeGray(const Object args[], int numArgs);
+    void opSetFillCMYKColor(const Object args[], int numArgs);
+    void opSetStrokeCMYKColor(const Object args[], int numArgs);
+    void opSetFillRGBColor(const Object args[], int numArgs);
+    void opSetStrokeRGBColor(const Object args[], int numArgs);
+    void opSetFillColorSpace(const Object args[], int numArgs);
+    void opSetStrokeColorSpace(const Object args[], int numArgs);
+    void opSetFillColor(const Object args[], int numArgs);
+    void opSetStrokeColor(const Object args[], int numArgs);
+    void opSetFillColorN(const Object args[], int numArgs);
+    void opSetStrokeColorN(const Object args[], int numArgs);
 
     // path segment operators
-    void opMoveTo(Object args[], int numArgs);
-    void opLineTo(Object args[], int numArgs);
-    void opCurveTo(Object args[], int numArgs);
-    void opCurveTo1(Object args[], int numArgs);
-    void opCurveTo2(Object args[], int numArgs);
-    void opRectangle(Object args[], int numArgs);
-    void opClosePath(Object args[], int numArgs);
+    void opMoveTo(const Object args[], int numArgs);
+    void opLineTo(const Object args[], int numArgs);
+    void opCurveTo(const Object args[], int numArgs);
+    void opCurveTo1(const Object args[], int numArgs);
+    void opCurveTo2(const Object args[], int numArgs);
+    void opRectangle(const Object args[], int numArgs);
+    void opClosePath(const Object args[], int numArgs);
 
     // path painting operators
-    void opEndPath(Object args[], int numArgs);
-    void opStroke(Object args[], int numArgs);
-    void opCloseStroke(Object args[], int numArgs);
-    void opFill(Object args[], int numArgs);
-    void opEOFill(Object args[], int numArgs);
-    void opFillStroke(Object args[], int numArgs);
-    void opCloseFillStroke(Object args[], int numArgs);
-    void opEOFillStroke(Object args[], int numArgs);
-    void opCloseEOFillStroke(Object args[], int numArgs);
+    void opEndPath(const Object args[], int numArgs);
+    void opStroke(const Object args[], int numArgs);
+    void opCloseStroke(const Object args[], int numArgs);
+    void opFill(const Object args[], int numArgs);
+    void opEOFill(const Object args[], int numArgs);
+    void opFillStroke(const Object args[], int numArgs);
+    void opCloseFillStroke(const Object args[], int numArgs);
+    void opEOFillStroke(const Object args[], int numArgs);
+    void opCloseEOFillStroke(const Object args[], int numArgs);
     void doPatternFill(bool eoFill);
     void doPatternStroke();
     void doPatternText();
     void doPatternImageMask(Object *ref, Stream *str, int width, int height, bool invert, bool inlineImg);
     void doTilingPatternFill(GfxTilingPattern *tPat, bool stroke, bool eoFill, bool text);
     void doShadingPatternFill(GfxShadingPattern *sPat, bool stroke, bool eoFill, bool text);
-    void opShFill(Object args[], int numArgs);
+    void opShFill(const Object args[], int numArgs);
     void doFunctionShFill(GfxFunctionShading *shading);
     void doFunctionShFill1(GfxFunctionShading *shading, double x0, double y0, double x1, double y1, GfxColor *colors, int depth);
     void doAxialShFill(GfxAxialShading *shading);
@@ -308,61 +326,64 @@ private:
     void doPatchMeshShFill(GfxPatchMeshShading *shading);
     void fillPatch(const GfxPatch *patch, int colorComps, int patchColorComps, double refineColorThreshold, int depth, const GfxPatchMeshShading *shading);
     void doEndPath();
+    bool isOutsideClip(double xMin, double yMin, double xMax, double yMax) const;
+    bool isPathOutsideClip(bool stroke) const;
+    bool isRectOutsideClip(const double *mat, const double *rect) const;
 
     // path clipping operators
-    void opClip(Object args[], int numArgs);
-    void opEOClip(Object args[], int numArgs);
+    void opClip(const Object args[], int numArgs);
+    void opEOClip(const Object args[], int numArgs);
 
     // text object operators
-    void opBeginText(Object args[], int numArgs);
-    void opEndText(Object args[], int numArgs);
+    void opBeginText(const Object args[], int numArgs);
+    void opEndText(const Object args[], int numArgs);
 
     // text state operators
-    void opSetCharSpacing(Object args[], int numArgs);
-    void opSetFont(Object args[], int numArgs);
-    void opSetTextLeading(Object args[], int numArgs);
-    void opSetTextRender(Object args[], int numArgs);
-    void opSetTextRise(Object args[], int numArgs);
-    void opSetWordSpacing(Object args[], int numArgs);
-    void opSetHorizScaling(Object args[], int numArgs);
+    void opSetCharSpacing(const Object args[], int numArgs);
+    void opSetFont(const Object args[], int numArgs);
+    void opSetTextLeading(const Object args[], int numArgs);
+    void opSetTextRender(const Object args[], int numArgs);
+    void opSetTextRise(const Object args[], int numArgs);
+    void opSetWordSpacing(const Object args[], int numArgs);
+    void opSetHorizScaling(const Object args[], int numArgs);
 
     // text positioning operators
-    void opTextMove(Object args[], int numArgs);
-    void opTextMoveSet(Object args[], int numArgs);
-    void opSetTextMatrix(Object args[], int numArgs);
-    void opTextNextLine(Object args[], int numArgs);
+    void opTextMove(const Object args[], int numArgs);
+    void opTextMoveSet(const Object args[], int numArgs);
+    void opSetTextMatrix(const Object args[], int numArgs);
+    void opTextNextLine(const Object args[], int numArgs);
 
     // text string operators
-    void opShowText(Object args[], int numArgs);
-    void opMoveShowText(Object args[], int numArgs);
-    void opMoveSetShowText(Object args[], int numArgs);
-    void opShowSpaceText(Object args[], int numArgs);
+    void opShowText(const Object args[], int numArgs);
+    void opMoveShowText(const Object args[], int numArgs);
+    void opMoveSetShowText(const Object args[], int numArgs);
+    void opShowSpaceText(const Object args[], int numArgs);
     void doShowText(const GooString *s);
     void doIncCharCount(const GooString *s);
 
     // XObject operators
-    void opXObject(Object args[], int numArgs);
+    void opXObject(const Object args[], int numArgs);
     void doImage(Object *ref, Stream *str, bool inlineImg);
-    void doForm(Object *str);
+    void doForm(Object *str, Ref strRef);
 
     // in-line image operators
-    void opBeginImage(Object args[], int numArgs);
+    void opBeginImage(const Object args[], int numArgs);
     Stream *buildImageStream();
-    void opImageData(Object args[], int numArgs);
-    void opEndImage(Object args[], int numArgs);
+    void opImageData(const Object args[], int numArgs);
+    void opEndImage(const Object args[], int numArgs);
 
     // type 3 font operators
-    void opSetCharWidth(Object args[], int numArgs);
-    void opSetCacheDevice(Object args[], int numArgs);
+    void opSetCharWidth(const Object args[], int numArgs);
+    void opSetCacheDevice(const Object args[], int numArgs);
 
     // compatibility operators
-    void opBeginIgnoreUndef(Object args[], int numArgs);
-    void opEndIgnoreUndef(Object args[], int numArgs);
+    void opBeginIgnoreUndef(const Object args[], int numArgs);
+    void opEndIgnoreUndef(const Object args[], int numArgs);
 
     // marked content operators
-    void opBeginMarkedContent(Object args[], int numArgs);
-    void opEndMarkedContent(Object args[], int numArgs);
-    void opMarkPoint(Object args[], int numArgs);
+    void opBeginMarkedContent(const Object args[], int numArgs);
+    void opEndMarkedContent(const Object args[], int numArgs);
+    void opMarkPoint(const Object args[], int numArgs);
     GfxState *saveStateStack();
     void restoreStateStack(GfxState *oldState);
     bool contentIsHidden();
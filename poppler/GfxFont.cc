@@ -59,6 +59,7 @@
 #include "CMap.h"
 #include "CharCodeToUnicode.h"
 #include "FontEncodingTables.h"
+#include "FontMapCache.h"
 #include "BuiltinFont.h"
 #include "UnicodeTypeTable.h"
 #include <fofi/FoFiIdentifier.h>
@@ -601,16 +602,17 @@ CharCodeToUnicode *GfxFont::readToUnicodeCMap(Dict *fontDict, int nBits, CharCod
     if (!obj1.isStream()) {
         return nullptr;
     }
-    buf = new GooString();
-    obj1.getStream()->fillGooString(buf);
-    obj1.streamClose();
     if (ctu) {
+        buf = new GooString();
+        obj1.getStream()->fillGooString(buf);
+        obj1.streamClose();
         ctu->mergeCMap(buf, nBits);
+        delete buf;
     } else {
-        ctu = CharCodeToUnicode::parseCMap(buf, nBits);
+        // a new mapping isn't modified afterwards, so it can be shared
+        ctu = globalParams->getFontMapCache()->getToUnicode(obj1.getStream(), nBits);
     }
     hasToUnicode = true;
-    delete buf;
     return ctu;
 }
 
@@ -2089,59 +2091,47 @@ int GfxCIDFont::mapCodeToGID(FoFiTrueType *ff, int cmapi, Unicode unicode, bool
     return gid;
 }
 
+// the Unicode CMaps of the character collections known to
+// GfxCIDFont::getCodeToGIDMap(), used to map the CIDs to Unicode
+static const char *adobe_cns1_cmaps[] = { "UniCNS-UTF32-V", "UniCNS-UCS2-V", "UniCNS-UTF32-H", "UniCNS-UCS2-H", nullptr };
+static const char *adobe_gb1_cmaps[] = { "UniGB-UTF32-V", "UniGB-UCS2-V", "UniGB-UTF32-H", "UniGB-UCS2-H", nullptr };
+static const char *adobe_japan1_cmaps[] = { "UniJIS-UTF32-V", "UniJIS-UCS2-V", "UniJIS-UTF32-H", "UniJIS-UCS2-H", nullptr };
+static const char *adobe_japan2_cmaps[] = { "UniHojo-UTF32-V", "UniHojo-UCS2-V", "UniHojo-UTF32-H", "UniHojo-UCS2-H", nullptr };
+static const char *adobe_korea1_cmaps[] = { "UniKS-UTF32-V", "UniKS-UCS2-V", "UniKS-UTF32-H", "UniKS-UCS2-H", nullptr };
+
+struct CMapListEntry
+{
+    const char *collection;
+    const char *scriptTag;
+    const char *languageTag;
+    const char *toUnicodeMap;
+    const char **CMaps;
+};
+
+static const CMapListEntry CMapList[] = { { "Adobe-CNS1", "hani", "CHN ", "Adobe-CNS1-UCS2", adobe_cns1_cmaps },
+                                          { "Adobe-GB1", "hani", "CHN ", "Adobe-GB1-UCS2", adobe_gb1_cmaps },
+                                          { "Adobe-Japan1", "kana", "JAN ", "Adobe-Japan1-UCS2", adobe_japan1_cmaps },
+                                          { "Adobe-Japan2", "kana", "JAN ", "Adobe-Japan2-UCS2", adobe_japan2_cmaps },
+                                          { "Adobe-Korea1", "hang", "KOR ", "Adobe-Korea1-UCS2", adobe_korea1_cmaps },
+                                          { nullptr, nullptr, nullptr, nullptr, nullptr } };
+
+// Returns the entry of CMapList for <collection>, or nullptr if it isn't
+// a known one.
+static const CMapListEntry *findCMapListEntry(const GooString *collection)
+{
+    for (const CMapListEntry *lp = CMapList; lp->collection != nullptr; lp++) {
+        if (strcmp(lp->collection, collection->c_str()) == 0) {
+            return lp;
+        }
+    }
+    return nullptr;
+}
+
 int *GfxCIDFont::getCodeToGIDMap(FoFiTrueType *ff, int *codeToGIDLen)
 {
 #define N_UCS_CANDIDATES 2
     /* space characters */
     static const unsigned long spaces[] = { 0x2000, 0x2001, 0x2002, 0x2003, 0x2004, 0x2005, 0x2006, 0x2007, 0x2008, 0x2009, 0x200A, 0x00A0, 0x200B, 0x2060, 0x3000, 0xFEFF, 0 };
-    static const char *adobe_cns1_cmaps[] = { "UniCNS-UTF32-V", "UniCNS-UCS2-V", "UniCNS-UTF32-H", "UniCNS-UCS2-H", nullptr };
-    static const char *adobe_gb1_cmaps[] = { "UniGB-UTF32-V", "UniGB-UCS2-V", "UniGB-UTF32-H", "UniGB-UCS2-H", nullptr };
-    static const char *adobe_japan1_cmaps[] = { "UniJIS-UTF32-V", "UniJIS-UCS2-V", "UniJIS-UTF32-H", "UniJIS-UCS2-H", nullptr };
-    static const char *adobe_japan2_cmaps[] = { "UniHojo-UTF32-V", "UniHojo-UCS2-V", "UniHojo-UTF32-H", "UniHojo-UCS2-H", nullptr };
-    static const char *adobe_korea1_cmaps[] = { "UniKS-UTF32-V", "UniKS-UCS2-V", "UniKS-UTF32-H", "UniKS-UCS2-H", nullptr };
-    static struct CMapListEntry
-    {
-        const char *collection;
-        const char *scriptTag;
-        const char *languageTag;
-        const char *toUnicodeMap;
-        const char **CMaps;
-    } CMapList[] = { {
-                             "Adobe-CNS1",
-                             "hani",
-                             "CHN ",
-                             "Adobe-CNS1-UCS2",
-                             adobe_cns1_cmaps,
-                     },
-                     {
-                             "Adobe-GB1",
-                             "hani",
-                             "CHN ",
-                             "Adobe-GB1-UCS2",
-                             adobe_gb1_cmaps,
-                     },
-                     {
-                             "Adobe-Japan1",
-                             "kana",
-                             "JAN ",
-                             "Adobe-Japan1-UCS2",
-                             adobe_japan1_cmaps,
-                     },
-                     {
-                             "Adobe-Japan2",
-                             "kana",
-                             "JAN ",
-                             "Adobe-Japan2-UCS2",
-                             adobe_japan2_cmaps,
-                     },
-                     {
-                             "Adobe-Korea1",
-                             "hang",
-                             "KOR ",
-                             "Adobe-Korea1-UCS2",
-                             adobe_korea1_cmaps,
-                     },
-                     { nullptr, nullptr, nullptr, nullptr, nullptr } };
     Unicode *humap = nullptr;
     Unicode *vumap = nullptr;
     Unicode *tumap = nullptr;
@@ -2150,7 +2140,7 @@ int *GfxCIDFont::getCodeToGIDMap(FoFiTrueType *ff, int *codeToGIDLen)
     unsigned long code;
     int wmode;
     const char **cmapName;
-    CMapListEntry *lp;
+    const CMapListEntry *lp;
     int cmap;
     int cmapPlatform, cmapEncoding;
     Ref embID;
@@ -2192,16 +2182,12 @@ int *GfxCIDFont::getCodeToGIDMap(FoFiTrueType *ff, int *codeToGIDLen)
         return nullptr;
 
     wmode = getWMode();
-    for (lp = CMapList; lp->collection != nullptr; lp++) {
-        if (strcmp(lp->collection, getCollection()->c_str()) == 0) {
-            break;
-        }
-    }
+    lp = findCMapListEntry(getCollection());
     const unsigned int n = 65536;
     tumap = new Unicode[n];
     humap = new Unicode[n * N_UCS_CANDIDATES];
     memset(humap, 0, sizeof(Unicode) * n * N_UCS_CANDIDATES);
-    if (lp->collection != nullptr) {
+    if (lp) {
         CharCodeToUnicode *tctu;
         GooString tname(lp->toUnicodeMap);
 
@@ -2316,6 +2302,44 @@ int *GfxCIDFont::getCodeToGIDMap(FoFiTrueType *ff, int *codeToGIDLen)
     return codeToGID;
 }
 
+int *GfxCIDFont::getCodeToGIDMap(const GooString *fileName, int *codeToGIDLen)
+{
+    FontMapCache *cache = globalParams->getFontMapCache();
+    std::string key;
+    std::shared_ptr<const std::vector<int>> cachedMap;
+    FoFiTrueType *ff;
+    int *map;
+    Ref embID;
+
+    // for the fonts which aren't embedded, the map only depends on the
+    // font file, the collection and the writing mode -- unless the
+    // collection is unknown, and the ToUnicode mapping is used instead
+    *codeToGIDLen = 0;
+    if (ctu && getCollection() && !getEmbeddedFontID(&embID) && findCMapListEntry(getCollection()) && cache->getMaxSize() > 0) {
+        key = fileName->toStr();
+        key.push_back('\0');
+        key.append(getCollection()->toStr());
+        key.push_back('\0');
+        key.push_back(getWMode() ? 'V' : 'H');
+        if ((cachedMap = cache->getCodeToGIDMap(key))) {
+            map = (int *)gmallocn(std::max((int)cachedMap->size(), 1), sizeof(int));
+            std::copy(cachedMap->begin(), cachedMap->end(), map);
+            *codeToGIDLen = cachedMap->size();
+            return map;
+        }
+    }
+
+    if (!(ff = FoFiTrueType::load(fileName->c_str()))) {
+        return nullptr;
+    }
+    map = getCodeToGIDMap(ff, codeToGIDLen);
+    delete ff;
+    if (map && !key.empty()) {
+        cache->setCodeToGIDMap(key, map, *codeToGIDLen);
+    }
+    return map;
+}
+
 double GfxCIDFont::getWidth(CID cid) const
 {
     double w;
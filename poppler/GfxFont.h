@@ -414,6 +414,9 @@ public:
     int getCIDToGIDLen() const { return cidToGIDLen; }
 
     int *getCodeToGIDMap(FoFiTrueType *ff, int *codeToGIDLen);
+    // Same as getCodeToGIDMap(FoFiTrueType *, int *) with the font file
+    // <fileName>, which is only read if the map isn't cached yet.
+    int *getCodeToGIDMap(const GooString *fileName, int *codeToGIDLen);
 
     double getWidth(char *s, int len) const;
 
@@ -69,11 +69,17 @@
 #include "CharCodeToUnicode.h"
 #include "UnicodeMap.h"
 #include "CMap.h"
+#include "FontMapCache.h"
 #include "FontEncodingTables.h"
 #include "GlobalParams.h"
 #include "GfxFont.h"
 
 #ifdef WITH_FONTCONFIGURATION_FONTCONFIG
+#    include <algorithm>
+#    include <shared_mutex>
+#    include <unordered_map>
+#    include <sys/stat.h>
+#    include <unistd.h>
 #    include <fontconfig/fontconfig.h>
 #endif
 
@@ -95,6 +101,7 @@
 
 #define cidToUnicodeCacheSize 4
 #define unicodeToUnicodeCacheSize 4
+#define fontMapCacheSize (16 << 20)
 
 //------------------------------------------------------------------------
 
@@ -390,6 +397,180 @@ const SysFontInfo *SysFontList::find(const GooString *name, bool fixedWidth, boo
     return fi;
 }
 
+#ifdef WITH_FONTCONFIGURATION_FONTCONFIG
+
+//------------------------------------------------------------------------
+// FontSubstCache
+//------------------------------------------------------------------------
+
+// The results of GlobalParams::findSystemFontFile(), including the fonts
+// which weren't found, keyed by everything the fontconfig lookup depends
+// on.  Lookups only take a shared lock, so threads looking up fonts don't
+// wait on each other, nor on the GlobalParams mutex.  The cache can be
+// saved to a file, so the lookups are shared by successive processes; the
+// file is ignored when the fontconfig configuration or font directories
+// changed after it was written.
+class FontSubstCache
+{
+public:
+    struct Subst
+    {
+        bool found;
+        std::string path;
+        SysFontType type;
+        int fontNum;
+        std::string substituteName;
+    };
+
+    FontSubstCache() : modified(false) { }
+
+    FontSubstCache(const FontSubstCache &) = delete;
+    FontSubstCache &operator=(const FontSubstCache &) = delete;
+
+    bool lookup(const std::string &key, Subst *subst) const;
+    void add(const std::string &key, const Subst &subst);
+
+    // Load the cache from <fileNameA>, and save it there from now on.
+    void setFile(const std::string &fileNameA);
+    // Write the cache to its file, if it was modified since it was
+    // loaded.
+    void save();
+
+private:
+    static long long getConfigTime();
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, Subst> substs;
+    std::string fileName;
+    bool modified;
+};
+
+#define fontSubstCacheHeader "poppler-font-subst-cache 1"
+
+bool FontSubstCache::lookup(const std::string &key, Subst *subst) const
+{
+    std::shared_lock<std::shared_mutex> lock { mutex };
+    const auto it = substs.find(key);
+    if (it == substs.end()) {
+        return false;
+    }
+    *subst = it->second;
+    return true;
+}
+
+void FontSubstCache::add(const std::string &key, const Subst &subst)
+{
+    std::unique_lock<std::shared_mutex> lock { mutex };
+    substs[key] = subst;
+    modified = true;
+}
+
+// The latest modification time of the fontconfig configuration files and
+// font directories, or -1 if it can't be found.
+long long FontSubstCache::getConfigTime()
+{
+    long long t = 0;
+    FcStrList *lists[2] = { FcConfigGetConfigFiles(nullptr), FcConfigGetFontDirs(nullptr) };
+    for (FcStrList *list : lists) {
+        if (!list) {
+            return -1;
+        }
+        FcChar8 *s;
+        while ((s = FcStrListNext(list))) {
+            struct stat st;
+            if (stat((const char *)s, &st) == 0) {
+                t = std::max(t, (long long)st.st_mtime);
+            }
+        }
+        FcStrListDone(list);
+    }
+    return t;
+}
+
+void FontSubstCache::setFile(const std::string &fileNameA)
+{
+    std::unique_lock<std::shared_mutex> lock { mutex };
+    fileName = fileNameA;
+
+    FILE *f = openFile(fileName.c_str(), "r");
+    if (!f) {
+        return;
+    }
+    const long long configTime = getConfigTime();
+    char buf[4096];
+    long long fileConfigTime;
+    if (configTime < 0 || !fgets(buf, sizeof(buf), f) || strcmp(buf, fontSubstCacheHeader "\n") || fscanf(f, "%lld\n", &fileConfigTime) != 1 || fileConfigTime != configTime) {
+        fclose(f);
+        return;
+    }
+
+    // one line per entry: key, found, type, font number, path and
+    // substitute name, separated by tabs
+    std::string line;
+    while (fgets(buf, sizeof(buf), f)) {
+        line.append(buf);
+        if (line.back() != '\n') {
+            continue;
+        }
+        line.pop_back();
+        std::vector<std::string> fields;
+        size_t start = 0, end;
+        while ((end = line.find('\t', start)) != std::string::npos) {
+            fields.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+        fields.push_back(line.substr(start));
+        line.clear();
+        if (fields.size() != 6) {
+            continue;
+        }
+        Subst subst;
+        subst.found = fields[1] == "1";
+        subst.type = (SysFontType)atoi(fields[2].c_str());
+        subst.fontNum = atoi(fields[3].c_str());
+        subst.path = fields[4];
+        subst.substituteName = fields[5];
+        substs.emplace(fields[0], subst);
+    }
+    fclose(f);
+}
+
+void FontSubstCache::save()
+{
+    std::unique_lock<std::shared_mutex> lock { mutex };
+    if (fileName.empty() || !modified) {
+        return;
+    }
+    const long long configTime = getConfigTime();
+    if (configTime < 0) {
+        return;
+    }
+
+    // write a new file and move it in place, so other processes never
+    // read a partial file
+    const std::string tmpFileName = fileName + ".tmp" + std::to_string(getpid());
+    FILE *f = openFile(tmpFileName.c_str(), "w");
+    if (!f) {
+        return;
+    }
+    fprintf(f, fontSubstCacheHeader "\n%lld\n", configTime);
+    for (const auto &entry : substs) {
+        const Subst &subst = entry.second;
+        const std::string fields = entry.first + subst.path + subst.substituteName;
+        if (fields.find_first_of("\t\n") != std::string::npos) {
+            continue;
+        }
+        fprintf(f, "%s\t%d\t%d\t%d\t%s\t%s\n", entry.first.c_str(), subst.found ? 1 : 0, (int)subst.type, subst.fontNum, subst.path.c_str(), subst.substituteName.c_str());
+    }
+    if (fclose(f) != 0 || rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        remove(tmpFileName.c_str());
+        return;
+    }
+    modified = false;
+}
+
+#endif
+
 #define globalParamsLocker() std::unique_lock<std::recursive_mutex> locker(mutex)
 #define unicodeMapCacheLocker() std::unique_lock<std::recursive_mutex> locker(unicodeMapCacheMutex)
 #define cMapCacheLocker() std::unique_lock<std::recursive_mutex> locker(cMapCacheMutex)
@@ -421,6 +602,18 @@ GlobalParams::GlobalParams(const char *customPopplerDataDir) : popplerDataDir(cu
     unicodeToUnicodeCache = new CharCodeToUnicodeCache(unicodeToUnicodeCacheSize);
     unicodeMapCache = new UnicodeMapCache();
     cMapCache = new CMapCache();
+    fontMapCache = new FontMapCache(fontMapCacheSize);
+    if (const char *dir = getenv("POPPLER_CMAP_CACHE_DIR")) {
+        cMapCacheDir = dir;
+    }
+#ifdef WITH_FONTCONFIGURATION_FONTCONFIG
+    fontSubstCache = new FontSubstCache();
+    if (const char *fontSubstCacheFile = getenv("POPPLER_FONT_SUBST_CACHE")) {
+        fontSubstCache->setFile(fontSubstCacheFile);
+    }
+#else
+    fontSubstCache = nullptr;
+#endif
 
     utf8Map = nullptr;
 
@@ -572,6 +765,11 @@ GlobalParams::~GlobalParams()
     delete unicodeToUnicodeCache;
     delete unicodeMapCache;
     delete cMapCache;
+    delete fontMapCache;
+#ifdef WITH_FONTCONFIGURATION_FONTCONFIG
+    fontSubstCache->save();
+    delete fontSubstCache;
+#endif
 }
 
 //------------------------------------------------------------------------
@@ -644,6 +842,23 @@ FILE *GlobalParams::findCMapFile(const GooString *collection, const GooString *c
     return file;
 }
 
+std::string GlobalParams::getCompiledMapFileName(const char *kind, const std::string &name)
+{
+    globalParamsLocker();
+    if (cMapCacheDir.empty()) {
+        return std::string();
+    }
+    std::string fileName = std::string(kind) + "-";
+    for (char c : name) {
+        fileName.push_back(isalnum(c & 0xff) || c == '-' || c == '_' || c == '.' ? c : '_');
+    }
+    fileName.append(".bin");
+    GooString *path = appendToPath(new GooString(cMapCacheDir), fileName.c_str());
+    const std::string result = path->toStr();
+    delete path;
+    return result;
+}
+
 FILE *GlobalParams::findToUnicodeFile(const GooString *name)
 {
     GooString *fileName;
@@ -889,7 +1104,68 @@ GooString *GlobalParams::findBase14FontFile(const GooString *base14Name, const G
     return findSystemFontFile(font, &type, &fontNum, nullptr, base14Name);
 }
 
+// The key of the font substitution cache: everything buildFcPattern()
+// and lookupSystemFontFile() look at.
+static std::string getFontSubstKey(const GfxFont *font, const GooString *base14Name)
+{
+    std::string key = font->getNameWithoutSubsetTag();
+    key.push_back('\x1f');
+    if (base14Name) {
+        key.append(base14Name->toStr());
+    }
+    key.push_back('\x1f');
+    if (font->getFamily()) {
+        key.append(font->getFamily()->toStr());
+    }
+    key.push_back('\x1f');
+    key.append(std::to_string(font->getWeight()));
+    key.push_back(' ');
+    key.append(std::to_string(font->getStretch()));
+    key.push_back(' ');
+    key.push_back(font->isFixedWidth() ? 'F' : '-');
+    key.push_back(font->isBold() ? 'B' : '-');
+    key.push_back(font->isItalic() ? 'I' : '-');
+    key.push_back(' ');
+    key.append(getFontLang(font));
+    return key;
+}
+
 GooString *GlobalParams::findSystemFontFile(const GfxFont *font, SysFontType *type, int *fontNum, GooString *substituteFontName, const GooString *base14Name)
+{
+    if (!font->getName()) {
+        return nullptr;
+    }
+
+    // the cache has its own lock, so threads finding fonts which were
+    // already looked up don't wait for the lookups of the others
+    const std::string key = getFontSubstKey(font, base14Name);
+    FontSubstCache::Subst subst;
+    if (!fontSubstCache->lookup(key, &subst)) {
+        GooString substituteName;
+        subst.type = sysFontPFA;
+        subst.fontNum = 0;
+        GooString *path = lookupSystemFontFile(font, &subst.type, &subst.fontNum, &substituteName, base14Name);
+        subst.found = path != nullptr;
+        if (path) {
+            subst.path = path->toStr();
+            subst.substituteName = substituteName.toStr();
+            delete path;
+        }
+        fontSubstCache->add(key, subst);
+    }
+
+    if (!subst.found) {
+        return nullptr;
+    }
+    *type = subst.type;
+    *fontNum = subst.fontNum;
+    if (substituteFontName) {
+        substituteFontName->Set(subst.substituteName.c_str());
+    }
+    return new GooString(subst.path);
+}
+
+GooString *GlobalParams::lookupSystemFontFile(const GfxFont *font, SysFontType *type, int *fontNum, GooString *substituteFontName, const GooString *base14Name)
 {
     const SysFontInfo *fi = nullptr;
     FcPattern *p = nullptr;
@@ -1260,6 +1536,25 @@ void GlobalParams::setErrQuiet(bool errQuietA)
     errQuiet = errQuietA;
 }
 
+void GlobalParams::setFontMapCacheSize(size_t size)
+{
+    fontMapCache->setMaxSize(size);
+}
+
+void GlobalParams::setCMapCacheDir(const char *dir)
+{
+    globalParamsLocker();
+    cMapCacheDir = dir ? dir : "";
+}
+
+void GlobalParams::setFontSubstCacheFile(const char *fileName)
+{
+#ifdef WITH_FONTCONFIGURATION_FONTCONFIG
+    fontSubstCache->save();
+    fontSubstCache->setFile(fileName);
+#endif
+}
+
 GlobalParamsIniter::GlobalParamsIniter(ErrorCallback errorCallback)
 {
     std::lock_guard<std::mutex> lock { mutex };
@@ -57,10 +57,12 @@ class CharCodeToUnicodeCache;
 class UnicodeMapCache;
 class CMap;
 class CMapCache;
+class FontMapCache;
 class GlobalParams;
 class GfxFont;
 class Stream;
 class SysFontList;
+class FontSubstCache;
 
 //------------------------------------------------------------------------
 
@@ -108,6 +110,10 @@ public:
     FILE *getUnicodeMapFile(const std::string &encodingName);
     FILE *findCMapFile(const GooString *collection, const GooString *cMapName);
     FILE *findToUnicodeFile(const GooString *name);
+    // Get the name of the file holding the compiled form of the <kind>
+    // ("cmap" or "cidToUnicode") file <name>, or an empty string if
+    // compiled files aren't used.
+    std::string getCompiledMapFileName(const char *kind, const std::string &name);
     GooString *findFontFile(const GooString *fontName);
     GooString *findBase14FontFile(const GooString *base14Name, const GfxFont *font);
     GooString *findSystemFontFile(const GfxFont *font, SysFontType *type, int *fontNum, GooString *substituteFontName = nullptr, const GooString *base14Name = nullptr);
@@ -121,6 +127,10 @@ public:
     CMap *getCMap(const GooString *collection, const GooString *cMapName);
     const UnicodeMap *getTextEncoding();
 
+    // Get the cache of the code-to-GID maps and ToUnicode CMaps shared by
+    // all the documents.
+    FontMapCache *getFontMapCache() { return fontMapCache; }
+
     const UnicodeMap *getUtf8Map();
 
     std::vector<std::string> getEncodingNames();
@@ -131,6 +141,21 @@ public:
     void setPrintCommands(bool printCommandsA);
     void setProfileCommands(bool profileCommandsA);
     void setErrQuiet(bool errQuietA);
+    // Set the size of the cache of code-to-GID maps and ToUnicode CMaps,
+    // in bytes; 0 disables it.
+    void setFontMapCacheSize(size_t size);
+    // Save the system font substitutions found to <fileName>, and use
+    // the ones already saved there, so they are shared by successive
+    // processes.  The file can also be set with the
+    // POPPLER_FONT_SUBST_CACHE environment variable.  Only supported
+    // with fontconfig.
+    void setFontSubstCacheFile(const char *fileName);
+    // Compile the CMap and cidToUnicode files to <dir> the first time
+    // they are used, and map the compiled files afterwards, so they are
+    // loaded quickly and shared by all the processes.  The directory can
+    // also be set with the POPPLER_CMAP_CACHE_DIR environment variable;
+    // compiled files aren't used if it isn't set.
+    void setCMapCacheDir(const char *dir);
 
     static bool parseYesNo2(const char *token, bool *flag);
 
@@ -141,6 +166,8 @@ private:
     void addCIDToUnicode(const GooString *collection, const GooString *fileName);
     void addUnicodeMap(const GooString *encodingName, const GooString *fileName);
     void addCMapDir(const GooString *collection, const GooString *dir);
+    // findSystemFontFile() without the substitution cache (fontconfig only)
+    GooString *lookupSystemFontFile(const GfxFont *font, SysFontType *type, int *fontNum, GooString *substituteFontName, const GooString *base14Name);
 
     //----- static tables
 
@@ -178,11 +205,15 @@ private:
     bool printCommands; // print the drawing commands
     bool profileCommands; // profile the drawing commands
     bool errQuiet; // suppress error messages?
+    std::string cMapCacheDir; // directory of the compiled CMap and
+                              //   cidToUnicode files
 
     CharCodeToUnicodeCache *cidToUnicodeCache;
     CharCodeToUnicodeCache *unicodeToUnicodeCache;
     UnicodeMapCache *unicodeMapCache;
     CMapCache *cMapCache;
+    FontMapCache *fontMapCache;
+    FontSubstCache *fontSubstCache; // results of findSystemFontFile()
 
     const UnicodeMap *utf8Map;
 
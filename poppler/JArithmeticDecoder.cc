@@ -172,7 +172,7 @@ void JArithmeticDecoder::cleanup()
     }
 }
 
-int JArithmeticDecoder::decodeBit(unsigned int context, JArithmeticDecoderStats *stats)
+int JArithmeticDecoder::decodeBitSlow(unsigned int context, JArithmeticDecoderStats *stats)
 {
     int bit;
     unsigned int qe;
@@ -92,8 +92,18 @@ public:
     // Read any leftover data in the stream.
     void cleanup();
 
-    // Decode one bit.
-    int decodeBit(unsigned int context, JArithmeticDecoderStats *stats);
+    // Decode one bit.  The common case, the more probable symbol without
+    // renormalization, is handled inline.
+    int decodeBit(unsigned int context, JArithmeticDecoderStats *stats)
+    {
+        const unsigned int entry = stats->cxTab[context];
+        const unsigned int aqe = a - qeTab[entry >> 1];
+        if (c < aqe && (aqe & 0x80000000)) {
+            a = aqe;
+            return entry & 1;
+        }
+        return decodeBitSlow(context, stats);
+    }
 
     // Decode eight bits.
     int decodeByte(unsigned int context, JArithmeticDecoderStats *stats);
@@ -108,6 +118,7 @@ public:
 
 private:
     unsigned int readByte();
+    int decodeBitSlow(unsigned int context, JArithmeticDecoderStats *stats);
     int decodeIntBit(JArithmeticDecoderStats *stats);
     void byteIn();
 
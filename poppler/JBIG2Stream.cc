@@ -897,7 +897,39 @@ void JBIG2Bitmap::combine(JBIG2Bitmap *bitmap, int x, int y, unsigned int combOp
                 xx = x0;
             }
 
-            // middle bytes
+            // middle bytes, four at a time: the source bits of the four
+            // bytes, and of the byte before them, are shifted together
+            for (; xx < x1 - 32; xx += 32) {
+                dest = ((unsigned int)destPtr[0] << 24) | (destPtr[1] << 16) | (destPtr[2] << 8) | destPtr[3];
+                src0 = src1;
+                src1 = srcPtr[3];
+                src = (unsigned int)((((unsigned long long)src0 << 32) | ((unsigned int)srcPtr[0] << 24) | (srcPtr[1] << 16) | (srcPtr[2] << 8) | src1) >> s1);
+                srcPtr += 4;
+                switch (combOp) {
+                case 0: // or
+                    dest |= src;
+                    break;
+                case 1: // and
+                    dest &= src;
+                    break;
+                case 2: // xor
+                    dest ^= src;
+                    break;
+                case 3: // xnor
+                    dest ^= ~src;
+                    break;
+                case 4: // replace
+                    dest = src;
+                    break;
+                }
+                destPtr[0] = (unsigned char)(dest >> 24);
+                destPtr[1] = (unsigned char)(dest >> 16);
+                destPtr[2] = (unsigned char)(dest >> 8);
+                destPtr[3] = (unsigned char)dest;
+                destPtr += 4;
+            }
+
+            // remaining middle bytes
             for (; xx < x1 - 8; xx += 8) {
                 dest = *destPtr;
                 src0 = src1;
@@ -1087,13 +1119,110 @@ JBIG2CodeTable::~JBIG2CodeTable()
     gfree(table);
 }
 
+//------------------------------------------------------------------------
+// JBIG2GlobalsCache
+//------------------------------------------------------------------------
+
+// Returns the approximate memory used by the global segments <segments>,
+// or 0 if they can't be shared between streams.
+static size_t getSharedSegmentsSize(const JBIG2GlobalsCache::Segments &segments)
+{
+    size_t segSize = 0;
+
+    for (const std::unique_ptr<JBIG2Segment> &seg : segments) {
+        segSize += sizeof(JBIG2Segment);
+        switch (seg->getType()) {
+        case jbig2SegSymbolDict: {
+            JBIG2SymbolDict *symbolDict = (JBIG2SymbolDict *)seg.get();
+            for (unsigned int i = 0; i < symbolDict->getSize(); ++i) {
+                if (symbolDict->getBitmap(i)) {
+                    segSize += sizeof(JBIG2Bitmap) + symbolDict->getBitmap(i)->getDataSize();
+                }
+            }
+            if (symbolDict->getGenericRegionStats()) {
+                segSize += symbolDict->getGenericRegionStats()->getContextSize();
+            }
+            if (symbolDict->getRefinementRegionStats()) {
+                segSize += symbolDict->getRefinementRegionStats()->getContextSize();
+            }
+            break;
+        }
+        case jbig2SegPatternDict: {
+            JBIG2PatternDict *patternDict = (JBIG2PatternDict *)seg.get();
+            for (unsigned int i = 0; i < patternDict->getSize(); ++i) {
+                if (patternDict->getBitmap(i)) {
+                    segSize += sizeof(JBIG2Bitmap) + patternDict->getBitmap(i)->getDataSize();
+                }
+            }
+            break;
+        }
+        case jbig2SegCodeTable: {
+            const JBIG2HuffmanTable *table = ((JBIG2CodeTable *)seg.get())->getHuffTable();
+            for (int i = 0; table[i].rangeLen != jbig2HuffmanEOT; ++i) {
+                segSize += sizeof(JBIG2HuffmanTable);
+            }
+            break;
+        }
+        default:
+            // region bitmaps can be discarded once they are used
+            return 0;
+        }
+    }
+    return segSize;
+}
+
+JBIG2GlobalsCache::JBIG2GlobalsCache(size_t maxSizeA) : maxSize(maxSizeA), size(0) { }
+
+JBIG2GlobalsCache::~JBIG2GlobalsCache() = default;
+
+std::shared_ptr<const JBIG2GlobalsCache::Segments> JBIG2GlobalsCache::get(Ref ref)
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    const auto it = entries.find(ref);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return it->second.segments;
+}
+
+void JBIG2GlobalsCache::add(Ref ref, const std::shared_ptr<const Segments> &segments, size_t segmentsSize)
+{
+    // another stream may have decoded the same globals in between, the
+    // newest segments replace them
+    std::lock_guard<std::mutex> lock { mutex };
+    if (segmentsSize > maxSize) {
+        return;
+    }
+    const auto it = entries.find(ref);
+    if (it != entries.end()) {
+        size -= it->second.size;
+        lru.erase(it->second.lruPos);
+        entries.erase(it);
+    }
+    while (!lru.empty() && size > maxSize - segmentsSize) {
+        const auto last = entries.find(lru.back());
+        size -= last->second.size;
+        entries.erase(last);
+        lru.pop_back();
+    }
+    lru.push_front(ref);
+    Entry &entry = entries[ref];
+    entry.segments = segments;
+    entry.size = segmentsSize;
+    entry.lruPos = lru.begin();
+    size += segmentsSize;
+}
+
 //------------------------------------------------------------------------
 // JBIG2Stream
 //------------------------------------------------------------------------
 
-JBIG2Stream::JBIG2Stream(Stream *strA, Object &&globalsStreamA, Object *globalsStreamRefA) : FilterStream(strA)
+JBIG2Stream::JBIG2Stream(Stream *strA, Object &&globalsStreamA, Object *globalsStreamRefA, JBIG2GlobalsCache *globalsCacheA) : FilterStream(strA)
 {
     pageBitmap = nullptr;
+    globalsStreamRef = Ref::INVALID();
+    globalsCache = globalsCacheA;
 
     arithDecoder = new JArithmeticDecoder();
     genericRegionStats = new JArithmeticDecoderStats(1 << 1);
@@ -1153,10 +1282,16 @@ JBIG2Stream::~JBIG2Stream()
 void JBIG2Stream::reset()
 {
     segments.resize(0);
-    globalSegments.resize(0);
+    globalSegments.reset();
+    delete pageBitmap;
+    pageBitmap = nullptr;
 
-    // read the globals stream
-    if (globalsStream.isStream()) {
+    // get the decoded globals from the cache, or read the globals stream
+    const bool useCache = globalsCache && globalsStreamRef != Ref::INVALID();
+    if (globalsStream.isStream() && useCache) {
+        globalSegments = globalsCache->get(globalsStreamRef);
+    }
+    if (globalsStream.isStream() && !globalSegments) {
         curStr = globalsStream.getStream();
         curStr->reset();
         arithDecoder->setStream(curStr);
@@ -1164,8 +1299,15 @@ void JBIG2Stream::reset()
         mmrDecoder->setStream(curStr);
         readSegments();
         curStr->close();
-        // swap the newly read segments list into globalSegments
-        std::swap(segments, globalSegments);
+        // move the newly read segments list into globalSegments
+        auto globals = std::make_shared<JBIG2GlobalsCache::Segments>(std::move(segments));
+        segments.clear();
+        // globals holding a page can't be shared
+        const size_t globalsSize = getSharedSegmentsSize(*globals);
+        if (useCache && !pageBitmap && globalsSize > 0) {
+            globalsCache->add(globalsStreamRef, globals, globalsSize);
+        }
+        globalSegments = std::move(globals);
     }
 
     // read the main stream
@@ -1191,7 +1333,7 @@ void JBIG2Stream::close()
         pageBitmap = nullptr;
     }
     segments.resize(0);
-    globalSegments.resize(0);
+    globalSegments.reset();
     dataPtr = dataEnd = nullptr;
     FilterStream::close();
 }
@@ -2799,6 +2941,28 @@ inline void JBIG2Stream::mmrAddPixelsNeg(int a1, int blackPixels, int *codingLin
     }
 }
 
+// Set the pixels <x0> <= x < <x1> of the bitmap row <line>.
+static inline void fillBitmapRun(unsigned char *line, int x0, int x1)
+{
+    unsigned char *p, *last;
+    unsigned char leftMask, rightMask;
+
+    if (x0 >= x1) {
+        return;
+    }
+    p = line + (x0 >> 3);
+    last = line + ((x1 - 1) >> 3);
+    leftMask = 0xff >> (x0 & 7);
+    rightMask = 0xff << (7 - ((x1 - 1) & 7));
+    if (p == last) {
+        *p |= leftMask & rightMask;
+        return;
+    }
+    *p++ |= leftMask;
+    memset(p, 0xff, last - p);
+    *last |= rightMask;
+}
+
 std::unique_ptr<JBIG2Bitmap> JBIG2Stream::readGenericBitmap(bool mmr, int w, int h, int templ, bool tpgdOn, bool useSkip, JBIG2Bitmap *skip, int *atx, int *aty, int mmrDataLength)
 {
     bool ltp;
@@ -3011,12 +3175,12 @@ std::unique_ptr<JBIG2Bitmap> JBIG2Stream::readGenericBitmap(bool mmr, int w, int
                 }
             }
 
-            // convert the run lengths to a bitmap line
+            // convert the run lengths to a bitmap line, filling whole
+            // bytes of each black run at once
+            pp = bitmap->getDataPtr() + y * bitmap->getLineSize();
             i = 0;
             while (true) {
-                for (x = codingLine[i]; x < codingLine[i + 1]; ++x) {
-                    bitmap->setPixel(x, y);
-                }
+                fillBitmapRun(pp, codingLine[i], codingLine[i + 1]);
                 if (codingLine[i + 1] >= w || codingLine[i + 2] >= w) {
                     break;
                 }
@@ -3095,7 +3259,40 @@ std::unique_ptr<JBIG2Bitmap> JBIG2Stream::readGenericBitmap(bool mmr, int w, int
                     buf1 = buf0 = 0;
                 }
 
-                if (atx[0] >= -8 && atx[0] <= 8 && atx[1] >= -8 && atx[1] <= 8 && atx[2] >= -8 && atx[2] <= 8 && atx[3] >= -8 && atx[3] <= 8) {
+                if (!useSkip && atx[0] == 3 && aty[0] == -1 && atx[1] == -3 && aty[1] == -1 && atx[2] == 2 && aty[2] == -2 && atx[3] == -2 && aty[3] == -2) {
+                    // the nominal AT pixels are in the two rows above, so the
+                    // whole context comes from buf0 and buf1
+                    for (x0 = 0, x = 0; x0 < w; x0 += 8, ++pp) {
+                        if (x0 + 8 < w) {
+                            if (p0) {
+                                buf0 |= *p0++;
+                            }
+                            if (p1) {
+                                buf1 |= *p1++;
+                            }
+                            buf2 |= *p2++;
+                        }
+                        for (x1 = 0, mask = 0x80; x1 < 8 && x < w; ++x1, ++x, mask >>= 1) {
+
+                            // build the context: the same bits as below, with
+                            // the AT pixels at x+3 and x-3 in buf1, x+2 and
+                            // x-2 in buf0
+                            cx = ((buf0 >> 1) & 0xe000) | ((buf1 >> 5) & 0x1f00) | ((buf2 >> 12) & 0x00f0) | ((buf1 >> 9) & 0x0008) | ((buf1 >> 16) & 0x0004) | ((buf0 >> 12) & 0x0002) | ((buf0 >> 17) & 0x0001);
+
+                            // decode the pixel
+                            if (arithDecoder->decodeBit(cx, genericRegionStats)) {
+                                *pp |= mask;
+                                buf2 |= 0x8000;
+                            }
+
+                            // update the context
+                            buf0 <<= 1;
+                            buf1 <<= 1;
+                            buf2 <<= 1;
+                        }
+                    }
+
+                } else if (atx[0] >= -8 && atx[0] <= 8 && atx[1] >= -8 && atx[1] <= 8 && atx[2] >= -8 && atx[2] <= 8 && atx[3] >= -8 && atx[3] <= 8) {
                     // set up the adaptive context
                     if (y + aty[0] >= 0 && y + aty[0] < bitmap->getHeight()) {
                         atP0 = bitmap->getDataPtr() + (y + aty[0]) * bitmap->getLineSize();
@@ -3972,9 +4169,11 @@ void JBIG2Stream::readExtensionSeg(unsigned int length)
 
 JBIG2Segment *JBIG2Stream::findSegment(unsigned int segNum)
 {
-    for (std::unique_ptr<JBIG2Segment> &seg : globalSegments) {
-        if (seg->getSegNum() == segNum) {
-            return seg.get();
+    if (globalSegments) {
+        for (const std::unique_ptr<JBIG2Segment> &seg : *globalSegments) {
+            if (seg->getSegNum() == segNum) {
+                return seg.get();
+            }
         }
     }
     for (std::unique_ptr<JBIG2Segment> &seg : segments) {
@@ -3985,14 +4184,10 @@ JBIG2Segment *JBIG2Stream::findSegment(unsigned int segNum)
     return nullptr;
 }
 
+// The global segments may be shared with other streams, so only the
+// segments of this stream are discarded.
 void JBIG2Stream::discardSegment(unsigned int segNum)
 {
-    for (auto it = globalSegments.begin(); it != globalSegments.end(); ++it) {
-        if ((*it)->getSegNum() == segNum) {
-            globalSegments.erase(it);
-            return;
-        }
-    }
     for (auto it = segments.begin(); it != segments.end(); ++it) {
         if ((*it)->getSegNum() == segNum) {
             segments.erase(it);
@@ -29,6 +29,12 @@
 #ifndef JBIG2STREAM_H
 #define JBIG2STREAM_H
 
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "Object.h"
 #include "Stream.h"
 
@@ -40,12 +46,61 @@ class JBIG2HuffmanDecoder;
 struct JBIG2HuffmanTable;
 class JBIG2MMRDecoder;
 
+//------------------------------------------------------------------------
+// JBIG2GlobalsCache
+//
+// The decoded segments of the JBIG2Globals streams of a document, keyed
+// by the references of the streams.  Scanned documents usually share
+// one globals stream between the images of all their pages, so its
+// symbol dictionaries are only decoded once.  Only globals made of
+// symbol dictionaries, pattern dictionaries and code tables, which are
+// not modified once decoded, are cached.  The cache is limited to a
+// total size; the least recently used globals are dropped first.
+//------------------------------------------------------------------------
+
+class JBIG2GlobalsCache
+{
+public:
+    typedef std::vector<std::unique_ptr<JBIG2Segment>> Segments;
+
+    explicit JBIG2GlobalsCache(size_t maxSizeA);
+    ~JBIG2GlobalsCache();
+
+    JBIG2GlobalsCache(const JBIG2GlobalsCache &) = delete;
+    JBIG2GlobalsCache &operator=(const JBIG2GlobalsCache &) = delete;
+
+    // Get the segments of the globals stream <ref>, or nullptr if they
+    // aren't cached.
+    std::shared_ptr<const Segments> get(Ref ref);
+
+    // Cache the segments of the globals stream <ref>, which use about
+    // <segmentsSize> bytes.
+    void add(Ref ref, const std::shared_ptr<const Segments> &segments, size_t segmentsSize);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<const Segments> segments;
+        size_t size;
+        std::list<Ref>::iterator lruPos;
+    };
+
+    size_t maxSize;
+    size_t size;
+    std::map<Ref, Entry> entries;
+    std::list<Ref> lru; // most recently used first
+    std::mutex mutex;
+};
+
 //------------------------------------------------------------------------
 
 class JBIG2Stream : public FilterStream
 {
 public:
-    JBIG2Stream(Stream *strA, Object &&globalsStreamA, Object *globalsStreamRefA);
+    // If <globalsCacheA> is set, the decoded segments of the globals
+    // stream are shared through it with the other streams using the
+    // same globals.
+    JBIG2Stream(Stream *strA, Object &&globalsStreamA, Object *globalsStreamRefA, JBIG2GlobalsCache *globalsCacheA = nullptr);
     ~JBIG2Stream() override;
     StreamKind getKind() const override { return strJBIG2; }
     void reset() override;
@@ -100,7 +155,8 @@ private:
     JBIG2Bitmap *pageBitmap;
     unsigned int defCombOp;
     std::vector<std::unique_ptr<JBIG2Segment>> segments;
-    std::vector<std::unique_ptr<JBIG2Segment>> globalSegments;
+    std::shared_ptr<const JBIG2GlobalsCache::Segments> globalSegments; // possibly shared with other streams
+    JBIG2GlobalsCache *globalsCache;
     Stream *curStr;
     unsigned char *dataPtr;
     unsigned char *dataEnd;
@@ -68,6 +68,8 @@ static const long long LongLongSafeLimit = (LLONG_MAX - 9) / 10;
 Lexer::Lexer(XRef *xrefA, Stream *str)
 {
     lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
+    bufStart = bufPtr = bufEnd = nullptr;
+    strHasBuffer = true;
     xref = xrefA;
 
     curStr = Object(str);
@@ -81,6 +83,8 @@ Lexer::Lexer(XRef *xrefA, Stream *str)
 Lexer::Lexer(XRef *xrefA, Object *obj)
 {
     lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
+    bufStart = bufPtr = bufEnd = nullptr;
+    strHasBuffer = true;
     xref = xrefA;
 
     if (obj->isStream()) {
@@ -102,6 +106,7 @@ Lexer::Lexer(XRef *xrefA, Object *obj)
 
 Lexer::~Lexer()
 {
+    releaseBuffer();
     if (curStr.isStream()) {
         curStr.streamClose();
     }
@@ -110,50 +115,48 @@ Lexer::~Lexer()
     }
 }
 
-int Lexer::getChar(bool comesFromLook)
+int Lexer::getCharFromStream(bool comesFromLook)
 {
-    int c;
-
-    if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
-        c = lookCharLastValueCached;
-        lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
-        return c;
-    }
-
-    c = EOF;
-    while (curStr.isStream() && (c = curStr.streamGetChar()) == EOF) {
+    int c = EOF;
+
+    while (curStr.isStream()) {
+        releaseBuffer();
+        if (strHasBuffer) {
+            int length;
+            const unsigned char *p = curStr.getStream()->getBuffer(&length);
+            if (p && length > 0) {
+                bufStart = p;
+                bufPtr = p + 1;
+                bufEnd = p + length;
+                return *p;
+            }
+            if (!p) {
+                strHasBuffer = false;
+                c = curStr.streamGetChar();
+            }
+        } else {
+            c = curStr.streamGetChar();
+        }
+        if (c != EOF) {
+            return c;
+        }
         if (comesFromLook == true) {
             return EOF;
-        } else {
-            curStr.streamClose();
-            curStr = Object();
-            ++strPtr;
-            if (strPtr < streams->getLength()) {
-                curStr = streams->get(strPtr);
-                if (curStr.isStream()) {
-                    curStr.streamReset();
-                }
+        }
+        curStr.streamClose();
+        curStr = Object();
+        strHasBuffer = true;
+        ++strPtr;
+        if (strPtr < streams->getLength()) {
+            curStr = streams->get(strPtr);
+            if (curStr.isStream()) {
+                curStr.streamReset();
             }
         }
     }
     return c;
 }
 
-int Lexer::lookChar()
-{
-
-    if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
-        return lookCharLastValueCached;
-    }
-    lookCharLastValueCached = getChar(true);
-    if (lookCharLastValueCached == EOF) {
-        lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
-        return EOF;
-    } else {
-        return lookCharLastValueCached;
-    }
-}
-
 Object Lexer::getObj(int objNum)
 {
     char *p;
@@ -68,15 +68,24 @@ public:
     void skipChar() { getChar(); }
 
     // Get stream.
-    Stream *getStream() { return curStr.isStream() ? curStr.getStream() : nullptr; }
+    Stream *getStream()
+    {
+        releaseBuffer();
+        return curStr.isStream() ? curStr.getStream() : nullptr;
+    }
 
     // Get current position in file.  This is only used for error
     // messages.
-    Goffset getPos() const { return curStr.isStream() ? curStr.getStream()->getPos() : -1; }
+    Goffset getPos() const
+    {
+        releaseBuffer();
+        return curStr.isStream() ? curStr.getStream()->getPos() : -1;
+    }
 
     // Set position in file.
     void setPos(Goffset pos)
     {
+        releaseBuffer();
         if (curStr.isStream())
             curStr.getStream()->setPos(pos);
     }
@@ -97,8 +106,53 @@ public:
     bool hasXRef() const { return xref != nullptr; }
 
 private:
-    int getChar(bool comesFromLook = false);
-    int lookChar();
+    int getChar(bool comesFromLook = false)
+    {
+        if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
+            const int c = lookCharLastValueCached;
+            lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
+            return c;
+        }
+        if (bufPtr < bufEnd) {
+            return *bufPtr++;
+        }
+        return getCharFromStream(comesFromLook);
+    }
+
+    int lookChar()
+    {
+        if (LOOK_VALUE_NOT_CACHED != lookCharLastValueCached) {
+            return lookCharLastValueCached;
+        }
+        lookCharLastValueCached = getChar(true);
+        if (lookCharLastValueCached == EOF) {
+            lookCharLastValueCached = LOOK_VALUE_NOT_CACHED;
+            return EOF;
+        } else {
+            return lookCharLastValueCached;
+        }
+    }
+
+    int getCharFromStream(bool comesFromLook);
+
+    // Tell the current stream how many chars were read from the buffer.
+    void releaseBuffer() const
+    {
+        if (bufPtr != bufStart) {
+            curStr.getStream()->skipBuffer(bufPtr - bufStart);
+        }
+        bufStart = bufPtr = bufEnd = nullptr;
+    }
+
+    // The chars of the current stream that are already in memory (see
+    // Stream::getBuffer) are read directly from the stream's buffer,
+    // without a virtual call for each of them.  The stream is only told
+    // how many were read (releaseBuffer) when it is used by somebody
+    // else, or asked for its position.
+    mutable const unsigned char *bufStart; // start of the buffer
+    mutable const unsigned char *bufPtr; // next char in the buffer
+    mutable const unsigned char *bufEnd; // end of the buffer
+    bool strHasBuffer; // does the current stream support getBuffer?
 
     Array *streams; // array of input streams
     int strPtr; // index of current stream
@@ -53,7 +53,9 @@ Object Object::copy() const
         break;
     case objName:
     case objCmd:
-        obj.cString = copyString(cString);
+        if (!isAtomName(cString)) {
+            obj.cString = copyString(cString);
+        }
         break;
     case objArray:
         array->incRef();
@@ -85,7 +87,9 @@ Object Object::deepCopy() const
         break;
     case objName:
     case objCmd:
-        obj.cString = copyString(cString);
+        if (!isAtomName(cString)) {
+            obj.cString = copyString(cString);
+        }
         break;
     case objArray:
         obj.array = array->deepCopy();
@@ -110,6 +114,60 @@ Object Object::fetch(XRef *xref, int recursion) const
     return (type == objRef && xref) ? xref->fetch(ref, recursion) : copy();
 }
 
+// arrays and dicts nested deeper than this are counted without their
+// contents
+#define objectMemorySizeMaxDepth 8
+
+static size_t getObjectMemorySize(const Object &obj, int depth)
+{
+    size_t n = sizeof(Object);
+    switch (obj.getType()) {
+    case objString:
+    case objHexString:
+        n += sizeof(GooString) + obj.getString()->getLength();
+        break;
+    case objName:
+        if (!isAtomName(obj.getName())) {
+            n += strlen(obj.getName()) + 1;
+        }
+        break;
+    case objArray:
+        if (depth < objectMemorySizeMaxDepth) {
+            for (int i = 0; i < obj.arrayGetLength(); ++i) {
+                n += getObjectMemorySize(obj.arrayGetNF(i), depth + 1);
+            }
+        } else {
+            n += obj.arrayGetLength() * sizeof(Object);
+        }
+        break;
+    case objDict:
+    case objStream: {
+        const Dict *dict = obj.isDict() ? obj.getDict() : obj.streamGetDict();
+        if (!dict) {
+            break;
+        }
+        if (depth < objectMemorySizeMaxDepth) {
+            for (int i = 0; i < dict->getLength(); ++i) {
+                n += strlen(dict->getKey(i)) + 1 + getObjectMemorySize(dict->getValNF(i), depth + 1);
+            }
+        } else {
+            n += dict->getLength() * 2 * sizeof(Object);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return n;
+}
+
+size_t Object::getMemorySize() const
+{
+    CHECK_NOT_DEAD;
+
+    return getObjectMemorySize(*this, 0);
+}
+
 void Object::free()
 {
     switch (type) {
@@ -120,7 +178,9 @@ void Object::free()
         break;
     case objName:
     case objCmd:
-        gfree(cString);
+        if (!isAtomName(cString)) {
+            gfree(const_cast<char *>(cString));
+        }
         break;
     case objArray:
         if (!array->decRef()) {
@@ -43,6 +43,7 @@
 #include "goo/GooString.h"
 #include "goo/GooLikely.h"
 #include "Error.h"
+#include "Atom.h"
 #include "poppler_private_export.h"
 
 #define OBJECT_TYPE_CHECK(wanted_type)                                                                                                                                                                                                         \
@@ -203,7 +204,12 @@ public:
         assert(typeA == objName || typeA == objCmd);
         assert(stringA);
         type = typeA;
-        cString = copyString(stringA);
+        if (isAtomName(stringA)) {
+            cString = stringA;
+        } else {
+            const Atom atom = findAtom(stringA);
+            cString = atom != atomNone ? getAtomName(atom) : copyString(stringA);
+        }
     }
     explicit Object(long long int64gA)
     {
@@ -275,6 +281,10 @@ public:
     // Otherwise, return a copy of the object.
     Object fetch(XRef *xref, int recursion = 0) const;
 
+    // Approximate memory used by the object and what it points to, in
+    // bytes.  Streams are counted without their data.
+    size_t getMemorySize() const;
+
     // Type checking.
     ObjType getType() const
     {
@@ -376,6 +386,10 @@ public:
     bool isName(const char *nameA) const { return type == objName && !strcmp(cString, nameA); }
     bool isDict(const char *dictType) const;
     bool isCmd(const char *cmdA) const { return type == objCmd && !strcmp(cString, cmdA); }
+    // Names with an atom always point into the atom table, so these
+    // only compare pointers.
+    bool isName(Atom atom) const { return type == objName && cString == getAtomName(atom); }
+    bool isCmd(Atom atom) const { return type == objCmd && cString == getAtomName(atom); }
 
     // Accessors.
     bool getBool() const
@@ -424,6 +438,12 @@ public:
         OBJECT_TYPE_CHECK(objName);
         return cString;
     }
+    // Returns atomNone if the name isn't in the atom table.
+    Atom getNameAtom() const
+    {
+        OBJECT_TYPE_CHECK(objName);
+        return isAtomName(cString) ? getAtom(cString) : atomNone;
+    }
     Array *getArray() const
     {
         OBJECT_TYPE_CHECK(objArray);
@@ -485,7 +505,9 @@ public:
     void dictRemove(const char *key);
     bool dictIs(const char *dictType) const;
     Object dictLookup(const char *key, int recursion = 0) const;
+    Object dictLookup(Atom key, int recursion = 0) const;
     const Object &dictLookupNF(const char *key) const;
+    const Object &dictLookupNF(Atom key) const;
     const char *dictGetKey(int i) const;
     Object dictGetVal(int i) const;
     const Object &dictGetValNF(int i) const;
@@ -523,7 +545,7 @@ private:
         long long int64g; //   64-bit integer
         double real; //   real
         GooString *string; // [hex] string
-        char *cString; //   name or command, depending on objType
+        const char *cString; //   name or command, depending on objType
         Array *array; //   array
         Dict *dict; //   dictionary
         Stream *stream; //   stream
@@ -614,12 +636,24 @@ inline Object Object::dictLookup(const char *key, int recursion) const
     return dict->lookup(key, recursion);
 }
 
+inline Object Object::dictLookup(Atom key, int recursion) const
+{
+    OBJECT_TYPE_CHECK(objDict);
+    return dict->lookup(key, recursion);
+}
+
 inline const Object &Object::dictLookupNF(const char *key) const
 {
     OBJECT_TYPE_CHECK(objDict);
     return dict->lookupNF(key);
 }
 
+inline const Object &Object::dictLookupNF(Atom key) const
+{
+    OBJECT_TYPE_CHECK(objDict);
+    return dict->lookupNF(key);
+}
+
 inline const char *Object::dictGetKey(int i) const
 {
     OBJECT_TYPE_CHECK(objDict);
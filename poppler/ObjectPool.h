@@ -0,0 +1,102 @@
+//========================================================================
+//
+// ObjectPool.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <new>
+
+//------------------------------------------------------------------------
+// ObjectPool
+//
+// Per-thread free lists for the memory of the small objects that are
+// created and destroyed in large numbers while parsing (Dict, Array).
+// A freed block is kept by the thread that frees it and reused by that
+// thread's next allocation, so render threads don't go to the shared
+// heap, and contend on it, for each of them.
+//------------------------------------------------------------------------
+
+template<class T>
+class ObjectPool
+{
+public:
+    static void *allocate()
+    {
+        FreeList *list = getFreeList();
+        if (list && list->head) {
+            Block *block = list->head;
+            list->head = block->next;
+            --list->length;
+            return block;
+        }
+        return ::operator new(sizeof(T));
+    }
+
+    static void release(void *p)
+    {
+        FreeList *list = getFreeList();
+        if (list && list->length < maxFreeBlocks) {
+            Block *block = static_cast<Block *>(p);
+            block->next = list->head;
+            list->head = block;
+            ++list->length;
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+private:
+    // blocks kept per thread; beyond that, they go back to the heap
+    static constexpr int maxFreeBlocks = 4096;
+
+    struct Block
+    {
+        Block *next;
+    };
+    static_assert(sizeof(T) >= sizeof(Block), "pooled objects must be able to hold a pointer");
+
+    struct FreeList
+    {
+        FreeList() { state = alive; }
+        ~FreeList()
+        {
+            while (head) {
+                Block *block = head;
+                head = block->next;
+                ::operator delete(block);
+            }
+            state = destroyed;
+        }
+
+        Block *head = nullptr;
+        int length = 0;
+    };
+
+    enum State : char
+    {
+        unused,
+        alive,
+        destroyed
+    };
+
+    // <state> is trivially destructible, so it can still be checked once
+    // the thread's free list is gone, when objects are freed by other
+    // thread-local or static destructors.
+    static thread_local State state;
+    static thread_local FreeList freeList;
+
+    static FreeList *getFreeList() { return state == destroyed ? nullptr : &freeList; }
+};
+
+template<class T>
+thread_local typename ObjectPool<T>::State ObjectPool<T>::state = ObjectPool<T>::unused;
+
+template<class T>
+thread_local typename ObjectPool<T>::FreeList ObjectPool<T>::freeList;
+
+#endif
@@ -103,6 +103,11 @@ public:
     // Does this device need non-text content?
     virtual bool needNonText() { return true; }
 
+    // Does this device need paths?  If this returns false, path
+    // construction operators are ignored, so nothing is stroked, filled
+    // or clipped.
+    virtual bool needPaths() { return true; }
+
     // Does this device require incCharCount to be called for text on
     // non-shown layers?
     virtual bool needCharCount() { return false; }
@@ -111,6 +116,11 @@ public:
     // box is the crop box?
     virtual bool needClipToCropBox() { return false; }
 
+    // Can the drawing operations lying entirely outside the clip region
+    // be skipped?  This requires the clip bounding box of the GfxState
+    // to cover all that the device draws.
+    virtual bool useRegionCulling() { return false; }
+
     //----- initialization and control
 
     // Set default transform matrix.
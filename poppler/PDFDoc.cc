@@ -113,6 +113,9 @@
     1024 // read this many bytes at end of file
          //   to look for 'startxref'
 
+#define objectStreamPreloadMaxSize (128 * 1024 * 1024) // keep at most this many
+                                                       //   bytes of preloaded objects
+
 //------------------------------------------------------------------------
 // PDFDoc
 //------------------------------------------------------------------------
@@ -736,6 +739,11 @@ bool PDFDoc::checkLinearization()
     return true;
 }
 
+void PDFDoc::preloadObjectStreams(bool background)
+{
+    xref->preloadObjectStreams(objectStreamPreloadMaxSize, background);
+}
+
 bool PDFDoc::isLinearized(bool tryingToReconstruct)
 {
     if ((str->getLength()) && (getLinearization()->getLength() == str->getLength()))
@@ -164,6 +164,10 @@ public:
     // Get the xref table.
     XRef *getXRef() const { return xref; }
 
+    // Decode all the object streams up front, for programs which go
+    // through the whole document.  See XRef::preloadObjectStreams.
+    void preloadObjectStreams(bool background = true);
+
     // Get catalog.
     Catalog *getCatalog() const { return catalog; }
 
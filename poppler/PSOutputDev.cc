@@ -100,6 +100,11 @@
 // Max size of a slice when rasterizing pages, in pixels.
 #define rasterizationSliceSize 20000000
 
+// Max size of the PostScript code rasterized by the worker threads ahead
+// of the output, in bytes, and size of the chunks they pass it on in.
+#define rasterMaxBuffered (32 * 1024 * 1024)
+#define rasterChunkSize (64 * 1024)
+
 //------------------------------------------------------------------------
 // PostScript prolog and setup
 //------------------------------------------------------------------------
@@ -989,6 +994,65 @@ struct PSOutPaperSize
     int w, h;
 };
 
+//------------------------------------------------------------------------
+
+// A page prepared by a raster worker thread: pre-scanned, and if needed
+// rasterized, with the parameters of the page it was queued for.
+struct PSRasterJob
+{
+    size_t idx; // index in the page list
+    int pg;
+    int rotate;
+    bool useMediaBox, crop, printing;
+    double hDPI, vDPI;
+    bool started; // set when a worker starts on the page
+    bool scanned; // set once ok and rasterize are known
+    bool done; // set when the worker is done with the page
+    bool abandoned; // set if the page won't be output, the worker deletes it
+    bool ok; // set if the page could be pre-scanned
+    bool rasterize; // set if the page must be rasterized
+    bool failed; // set if the page couldn't be rasterized
+    std::string ps; // the PostScript code rasterized and not output yet
+    int processColors; // the process colors it uses
+};
+
+// The output of a raster worker thread, passed on to its job in chunks.
+struct PSRasterOutput
+{
+    PSOutputDev *dev;
+    PSRasterJob *job;
+    std::string buf;
+};
+
+//------------------------------------------------------------------------
+
+// Writes the PostScript code of a rasterized page, to the output of the
+// PSOutputDev or to the buffer of a raster worker thread.
+class PSRasterWriter
+{
+public:
+    PSRasterWriter(PSOutputFunc outputFuncA, void *outputStreamA) : outputFunc(outputFuncA), outputStream(outputStreamA) { }
+
+    void writeChar(char c) { (*outputFunc)(outputStream, &c, 1); }
+    void write(const char *s) { (*outputFunc)(outputStream, s, strlen(s)); }
+    void writeBuf(const char *s, int len) { (*outputFunc)(outputStream, s, len); }
+    void writeFmt(const char *fmt, ...)
+    {
+        va_list args;
+        GooString *buf;
+
+        va_start(args, fmt);
+        buf = GooString::formatv((char *)fmt, args);
+        va_end(args);
+        (*outputFunc)(outputStream, buf->c_str(), buf->getLength());
+        delete buf;
+    }
+
+private:
+    PSOutputFunc outputFunc;
+    void *outputStream;
+};
+
 //------------------------------------------------------------------------
 // DeviceNRecoder
 //------------------------------------------------------------------------
@@ -1084,6 +1148,14 @@ static void outputToFile(void *stream, const char *data, int len)
     fwrite(data, 1, len, (FILE *)stream);
 }
 
+// Write <data> through <outputFuncA>, in pieces whose length fits in an int.
+static void outputToStream(PSOutputFunc outputFuncA, void *outputStreamA, const std::string &data)
+{
+    for (size_t i = 0; i < data.size(); i += INT_MAX) {
+        (*outputFuncA)(outputStreamA, data.data() + i, (int)std::min(data.size() - i, (size_t)INT_MAX));
+    }
+}
+
 PSOutputDev::PSOutputDev(const char *fileName, PDFDoc *docA, char *psTitleA, const std::vector<int> &pagesA, PSOutMode modeA, int paperWidthA, int paperHeightA, bool noCropA, bool duplexA, int imgLLXA, int imgLLYA, int imgURXA, int imgURYA,
                          PSForceRasterize forceRasterizeA, bool manualCtrlA, PSOutCustomCodeCbk customCodeCbkA, void *customCodeCbkDataA, PSLevel levelA)
 {
@@ -1110,6 +1182,14 @@ PSOutputDev::PSOutputDev(const char *fileName, PDFDoc *docA, char *psTitleA, con
     t3String = nullptr;
     forceRasterize = forceRasterizeA;
     psTitle = nullptr;
+    rasterThreads = 0;
+    rasterOwnerPW = nullptr;
+    rasterUserPW = nullptr;
+    rasterNextPage = 0;
+    rasterHead = 0;
+    rasterBuffered = 0;
+    rasterQuit = false;
+    rasterBandMemory = 0;
 
     // open file or pipe
     if (!strcmp(fileName, "-")) {
@@ -1169,6 +1249,14 @@ PSOutputDev::PSOutputDev(int fdA, PDFDoc *docA, char *psTitleA, const std::vecto
     t3String = nullptr;
     forceRasterize = forceRasterizeA;
     psTitle = nullptr;
+    rasterThreads = 0;
+    rasterOwnerPW = nullptr;
+    rasterUserPW = nullptr;
+    rasterNextPage = 0;
+    rasterHead = 0;
+    rasterBuffered = 0;
+    rasterQuit = false;
+    rasterBandMemory = 0;
 
     // open file or pipe
     if (fdA == fileno(stdout)) {
@@ -1209,6 +1297,14 @@ PSOutputDev::PSOutputDev(PSOutputFunc outputFuncA, void *outputStreamA, char *ps
     t3String = nullptr;
     forceRasterize = forceRasterizeA;
     psTitle = nullptr;
+    rasterThreads = 0;
+    rasterOwnerPW = nullptr;
+    rasterUserPW = nullptr;
+    rasterNextPage = 0;
+    rasterHead = 0;
+    rasterBuffered = 0;
+    rasterQuit = false;
+    rasterBandMemory = 0;
 
     init(outputFuncA, outputStreamA, psGeneric, psTitleA, docA, pagesA, modeA, imgLLXA, imgLLYA, imgURXA, imgURYA, manualCtrlA, paperWidthA, paperHeightA, noCropA, duplexA, levelA);
 }
@@ -1264,6 +1360,7 @@ void PSOutputDev::init(PSOutputFunc outputFuncA, void *outputStreamA, PSFileType
     enableFlate = true;
     rasterResolution = 300;
     uncompressPreloadedImages = false;
+    streamPages = false;
     psCenter = true;
     rasterAntialias = false;
     displayText = true;
@@ -1462,6 +1559,9 @@ void PSOutputDev::postInit()
               "Conflicting settings between LanguageLevel and/or overprint simulation, and processColorFormat."
               " Resetting processColorFormat to CMYK8.");
         processColorFormat = splashModeCMYK8;
+    } else if (processColorFormat != splashModeMono8 && processColorFormat != splashModeCMYK8 && processColorFormat != splashModeRGB8) {
+        error(errUnimplemented, -1, "Unsupported processColorMode. Falling back to RGB8.");
+        processColorFormat = splashModeRGB8;
     }
 #ifdef USE_CMS
     if (getDisplayProfile()) {
@@ -1516,6 +1616,21 @@ PSOutputDev::~PSOutputDev()
     PSOutCustomColor *cc;
     int i;
 
+    // stop the raster worker threads
+    {
+        std::lock_guard<std::mutex> lock { rasterMutex };
+        rasterQuit = true;
+    }
+    rasterCond.notify_all();
+    for (std::thread &worker : rasterWorkers) {
+        worker.join();
+    }
+    for (const auto &entry : rasterJobs) {
+        delete entry.second;
+    }
+    delete rasterOwnerPW;
+    delete rasterUserPW;
+
     if (ok) {
         if (!postInitDone) {
             postInit();
@@ -1722,8 +1837,6 @@ void PSOutputDev::writeXpdfProcset()
 void PSOutputDev::writeDocSetup(Catalog *catalog, const std::vector<int> &pageList, bool duplexA)
 {
     Page *page;
-    Dict *resDict;
-    Annots *annots;
     Object *acroForm;
     GooString *s;
 
@@ -1733,21 +1846,15 @@ void PSOutputDev::writeDocSetup(Catalog *catalog, const std::vector<int> &pageLi
     } else {
         writePS("xpdf begin\n");
     }
-    for (const int pg : pageList) {
-        page = doc->getPage(pg);
-        if (!page) {
-            error(errSyntaxError, -1, "Failed writing resources for page {0:d}", pg);
-            continue;
-        }
-        if ((resDict = page->getResourceDict())) {
-            setupResources(resDict);
-        }
-        annots = page->getAnnots();
-        for (int i = 0; i < annots->getNumAnnots(); ++i) {
-            Object obj1 = annots->getAnnot(i)->getAppearanceResDict();
-            if (obj1.isDict()) {
-                setupResources(obj1.getDict());
+    // when streaming, the resources of the pages are written by startPage
+    if (!streamPages || mode != psModePS) {
+        for (const int pg : pageList) {
+            page = doc->getPage(pg);
+            if (!page) {
+                error(errSyntaxError, -1, "Failed writing resources for page {0:d}", pg);
+                continue;
             }
+            setupPageResources(page);
         }
     }
     if ((acroForm = catalog->getAcroForm()) && acroForm->isDict()) {
@@ -1837,6 +1944,23 @@ void PSOutputDev::writeTrailer()
     }
 }
 
+void PSOutputDev::setupPageResources(Page *page)
+{
+    Dict *resDict;
+    Annots *annots;
+
+    if ((resDict = page->getResourceDict())) {
+        setupResources(resDict);
+    }
+    annots = page->getAnnots();
+    for (int i = 0; i < annots->getNumAnnots(); ++i) {
+        Object obj1 = annots->getAnnot(i)->getAppearanceResDict();
+        if (obj1.isDict()) {
+            setupResources(obj1.getDict());
+        }
+    }
+}
+
 void PSOutputDev::setupResources(Dict *resDict)
 {
     bool skip;
@@ -2553,7 +2677,7 @@ void PSOutputDev::setupExternalCIDTrueTypeFont(GfxFont *font, GooString *fileNam
                     memcpy(codeToGID, ((GfxCIDFont *)font)->getCIDToGID(), codeToGIDLen * sizeof(int));
                 }
             } else {
-                codeToGID = ((GfxCIDFont *)font)->getCodeToGIDMap(ffTT, &codeToGIDLen);
+                codeToGID = ((GfxCIDFont *)font)->getCodeToGIDMap(fileName, &codeToGIDLen);
             }
             if (ffTT->isOpenTypeCFF()) {
                 ffTT->convertToCIDType0(psName->c_str(), codeToGID, codeToGIDLen, outputFunc, outputStream);
@@ -3151,38 +3275,143 @@ void PSOutputDev::setupForm(Ref id, Object *strObj)
     writePS("} def\n");
 }
 
+// Returns true if the resources in <resDict>, or in the XObjects,
+// patterns and Type 3 fonts they contain, may produce what makes
+// PreScanOutputDev ask for rasterization: transparency, and at level 1,
+// image masks filled with a pattern.  Errs on the side of true.
+static bool resourcesMayNeedRasterization(Dict *resDict, PSLevel level, std::set<int> *visited)
+{
+    Object gsDict = resDict->lookup("ExtGState");
+    if (gsDict.isDict()) {
+        for (int i = 0; i < gsDict.dictGetLength(); ++i) {
+            Object gs = gsDict.dictGetVal(i);
+            if (!gs.isDict()) {
+                continue;
+            }
+            Object obj1 = gs.dictLookup("CA");
+            Object obj2 = gs.dictLookup("ca");
+            if ((obj1.isNum() && obj1.getNum() != 1) || (obj2.isNum() && obj2.getNum() != 1)) {
+                return true;
+            }
+            obj1 = gs.dictLookup("BM");
+            if (!obj1.isNull() && !obj1.isName("Normal") && !obj1.isName("Compatible")) {
+                return true;
+            }
+            obj1 = gs.dictLookup("SMask");
+            if (!obj1.isNull() && !obj1.isName("None")) {
+                return true;
+            }
+        }
+    }
+
+    Object patDict = resDict->lookup("Pattern");
+    if (patDict.isDict() && (level == psLevel1 || level == psLevel1Sep)) {
+        return true;
+    }
+
+    const char *kinds[3] = { "XObject", "Pattern", "Font" };
+    for (const char *kind : kinds) {
+        Object dict = resDict->lookup(kind);
+        if (!dict.isDict()) {
+            continue;
+        }
+        for (int i = 0; i < dict.dictGetLength(); ++i) {
+            const Object &ref = dict.dictGetValNF(i);
+            if (ref.isRef() && !visited->insert(ref.getRefNum()).second) {
+                continue;
+            }
+            Object obj1 = dict.dictGetVal(i);
+            Dict *objDict;
+            if (obj1.isStream()) {
+                objDict = obj1.streamGetDict();
+            } else if (obj1.isDict()) {
+                objDict = obj1.getDict();
+            } else {
+                continue;
+            }
+            if (obj1.isStream() && kind == kinds[0]) {
+                // soft masked images
+                Object obj2 = objDict->lookup("SMask");
+                if (obj2.isStream()) {
+                    return true;
+                }
+                obj2 = objDict->lookup("Mask");
+                if (obj2.isStream()) {
+                    Object obj3 = obj2.streamGetDict()->lookup("ImageMask");
+                    if (!obj3.isBool()) {
+                        return true;
+                    }
+                }
+            } else if (kind == kinds[1]) {
+                // shading patterns
+                if (objDict->hasKey("ExtGState")) {
+                    return true;
+                }
+            }
+            Object obj2 = objDict->lookup("Resources");
+            if (obj2.isDict() && resourcesMayNeedRasterization(obj2.getDict(), level, visited)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Returns true if <page> may need to be rasterized, i.e. if it must be
+// pre-scanned.
+static bool pageMayNeedRasterization(Page *page, PSLevel level)
+{
+    std::set<int> visited;
+    Dict *resDict;
+
+    if ((resDict = page->getResourceDict()) && resourcesMayNeedRasterization(resDict, level, &visited)) {
+        return true;
+    }
+    Annots *annots = page->getAnnots();
+    for (int i = 0; i < annots->getNumAnnots(); ++i) {
+        Annot *annot = annots->getAnnot(i);
+        // the appearances generated for markup annotations may be
+        // translucent
+        if (annot->getAppearance().isNull() && dynamic_cast<AnnotMarkup *>(annot)) {
+            return true;
+        }
+        Object obj1 = annot->getAppearanceResDict();
+        if (obj1.isDict() && resourcesMayNeedRasterization(obj1.getDict(), level, &visited)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, int rotateA, bool useMediaBox, bool crop, int sliceX, int sliceY, int sliceW, int sliceH, bool printing, bool (*abortCheckCbk)(void *data),
                                  void *abortCheckCbkData, bool (*annotDisplayDecideCbk)(Annot *annot, void *user_data), void *annotDisplayDecideCbkData)
 {
     PreScanOutputDev *scan;
+    PSRasterJob *job;
     bool rasterize;
-    bool useFlate, useLZW;
-    SplashOutputDev *splashOut;
-    SplashColor paperColor;
     PDFRectangle box;
     GfxState *state;
-    SplashBitmap *bitmap;
-    Stream *str0, *str;
-    unsigned char *p;
-    unsigned char col[4];
     double hDPI2, vDPI2;
-    double m0, m1, m2, m3, m4, m5;
-    int nStripes, stripeH, stripeY;
-    int c, w, h, x, y, comp, i;
-    int numComps, initialNumComps;
-    char hexBuf[32 * 2 + 2]; // 32 values X 2 chars/value + line ending + null
-    unsigned char digit;
-    bool isOptimizedGray;
-    bool overprint;
-    SplashColorMode internalColorFormat;
 
     if (!postInitDone) {
         postInit();
     }
+
+    // whole pages without callbacks may have been prepared by the raster
+    // worker threads
+    job = nullptr;
+    if (rasterThreads > 0 && forceRasterize != psNeverRasterize && sliceW < 0 && sliceH < 0 && !abortCheckCbk && !annotDisplayDecideCbk) {
+        job = takeRasterJob(page->getNum(), rotateA, useMediaBox, crop, printing);
+    }
+
     if (forceRasterize == psAlwaysRasterize) {
         rasterize = true;
     } else if (forceRasterize == psNeverRasterize) {
         rasterize = false;
+    } else if (job && job->ok) {
+        rasterize = job->rasterize;
+    } else if (streamPages && !pageMayNeedRasterization(page, level)) {
+        rasterize = false;
     } else {
         scan = new PreScanOutputDev(level);
         page->displaySlice(scan, 72, 72, rotateA, useMediaBox, crop, sliceX, sliceY, sliceW, sliceH, printing, abortCheckCbk, abortCheckCbkData, annotDisplayDecideCbk, annotDisplayDecideCbkData);
@@ -3190,12 +3419,10 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
         delete scan;
     }
     if (!rasterize) {
+        releaseRasterJob(job);
         return true;
     }
 
-    // get the rasterization parameters
-    useFlate = getEnableFlate() && level >= psLevel3;
-    useLZW = getEnableLZW();
     // start the PS page
     page->makeBox(rasterResolution, rasterResolution, rotateA, useMediaBox, false, sliceX, sliceY, sliceW, sliceH, &box, &crop);
     rotateA += page->getRotate();
@@ -3208,6 +3435,74 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
     startPage(page->getNum(), state, xref);
     delete state;
 
+    // rasterize the page, unless a worker thread does it at the same
+    // resolution
+    hDPI2 = xScale * rasterResolution;
+    vDPI2 = yScale * rasterResolution;
+    if (job && (!job->ok || job->hDPI != hDPI2 || job->vDPI != vDPI2)) {
+        releaseRasterJob(job);
+        job = nullptr;
+    }
+    if (!(job && writeRasterJob(job))
+        && !rasterizePage(doc, page, hDPI2, vDPI2, useMediaBox, printing, sliceX, sliceY, sliceW, sliceH, abortCheckCbk, abortCheckCbkData, annotDisplayDecideCbk, annotDisplayDecideCbkData, outputFunc, outputStream, &processColors)) {
+        return false;
+    }
+
+    // finish the PS page
+    endPage();
+
+    return false;
+}
+
+// Returns true if all the components of all the pixels of <bitmap> are
+// <paper> -- which is the case of the paper color in all the process
+// color formats.
+static bool bitmapIsBlank(SplashBitmap *bitmap, unsigned char paper)
+{
+    const int n = bitmap->getWidth() * splashColorModeNComps[bitmap->getMode()];
+    for (int y = 0; y < bitmap->getHeight(); ++y) {
+        const unsigned char *p = bitmap->getDataPtr() + y * bitmap->getRowSize();
+        for (int x = 0; x < n; ++x) {
+            if (p[x] != paper) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Rasterize <page> of <docA> at <hDPI> x <vDPI>, and write the
+// PostScript code drawing it through <outputFuncA>.  The process colors
+// used are added to <processColorsA>.  This only reads the settings of
+// the PSOutputDev, so it can run in a raster worker thread.  Returns
+// false if the page is too large.
+bool PSOutputDev::rasterizePage(PDFDoc *docA, Page *page, double hDPI, double vDPI, bool useMediaBox, bool printing, int sliceX, int sliceY, int sliceW, int sliceH, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData,
+                                bool (*annotDisplayDecideCbk)(Annot *annot, void *user_data), void *annotDisplayDecideCbkData, PSOutputFunc outputFuncA, void *outputStreamA, int *processColorsA)
+{
+    PSRasterWriter out(outputFuncA, outputStreamA);
+    bool useFlate, useLZW;
+    SplashOutputDev *splashOut;
+    SplashColor paperColor;
+    PDFRectangle box;
+    bool crop;
+    SplashBitmap *bitmap;
+    Stream *str0, *str;
+    unsigned char *p;
+    unsigned char col[4];
+    double m0, m1, m2, m3, m4, m5;
+    int nStripes, stripeH, stripeY;
+    int c, w, h, x, y, comp, i;
+    int numComps, initialNumComps;
+    char hexBuf[32 * 2 + 2]; // 32 values X 2 chars/value + line ending + null
+    unsigned char digit;
+    bool isOptimizedGray;
+    bool overprint;
+    SplashColorMode internalColorFormat;
+
+    // get the rasterization parameters
+    useFlate = getEnableFlate() && level >= psLevel3;
+    useLZW = getEnableLZW();
+
     // If we would not rasterize this page, we would emit the overprint code anyway for language level 2 and upwards.
     // As such it is safe to assume for a CMYK printer that it would respect the overprint operands.
     overprint = overprintPreview || (processColorFormat == splashModeCMYK8 && level >= psLevel2);
@@ -3227,13 +3522,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
         if (overprint) {
             internalColorFormat = splashModeDeviceN8;
         }
-    } else if (processColorFormat == splashModeRGB8) {
-        numComps = 3;
-        paperColor[0] = paperColor[1] = paperColor[2] = 0xff;
-    } else {
-        error(errUnimplemented, -1, "Unsupported processColorMode. Falling back to RGB8.");
-        processColorFormat = splashModeRGB8;
-        internalColorFormat = processColorFormat;
+    } else { // splashModeRGB8, checked by postInit
         numComps = 3;
         paperColor[0] = paperColor[1] = paperColor[2] = 0xff;
     }
@@ -3246,11 +3535,9 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
     splashOut->setDefaultRGBProfile(getDefaultRGBProfile());
     splashOut->setDefaultCMYKProfile(getDefaultCMYKProfile());
 #endif
-    splashOut->startDoc(doc);
+    splashOut->startDoc(docA);
 
     // break the page into stripes
-    hDPI2 = xScale * rasterResolution;
-    vDPI2 = yScale * rasterResolution;
     if (sliceW < 0 || sliceH < 0) {
         if (useMediaBox) {
             box = *page->getMediaBox();
@@ -3258,16 +3545,19 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
             box = *page->getCropBox();
         }
         sliceX = sliceY = 0;
-        sliceW = (int)((box.x2 - box.x1) * hDPI2 / 72.0);
-        sliceH = (int)((box.y2 - box.y1) * vDPI2 / 72.0);
-    }
-    int sliceArea;
-    if (checkedMultiply(sliceW, sliceH, &sliceArea)) {
-        delete splashOut;
-        return false;
+        sliceW = (int)((box.x2 - box.x1) * hDPI / 72.0);
+        sliceH = (int)((box.y2 - box.y1) * vDPI / 72.0);
+    }
+    // the bands are limited to rasterBandMemory bytes of bitmap if set,
+    // and to rasterizationSliceSize pixels otherwise, so pages too large
+    // for one bitmap are rasterized in as many bands as needed
+    const long long sliceArea = (long long)sliceW * sliceH;
+    if (rasterBandMemory > 0) {
+        nStripes = (int)std::min((double)sliceH, ceil((double)sliceArea * splashColorModeNComps[internalColorFormat] / (double)rasterBandMemory));
+    } else {
+        nStripes = (int)std::min((double)sliceH, ceil((double)sliceArea / (double)rasterizationSliceSize));
     }
-    nStripes = (int)ceil((double)(sliceArea) / (double)rasterizationSliceSize);
-    if (unlikely(nStripes == 0)) {
+    if (unlikely(nStripes <= 0)) {
         delete splashOut;
         return false;
     }
@@ -3278,25 +3568,29 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
     for (stripeY = sliceY; stripeY < sliceH; stripeY += stripeH) {
 
         // rasterize a stripe
-        page->makeBox(hDPI2, vDPI2, 0, useMediaBox, false, sliceX, stripeY, sliceW, stripeH, &box, &crop);
+        page->makeBox(hDPI, vDPI, 0, useMediaBox, false, sliceX, stripeY, sliceW, stripeH, &box, &crop);
         m0 = box.x2 - box.x1;
         m1 = 0;
         m2 = 0;
         m3 = box.y2 - box.y1;
         m4 = box.x1;
         m5 = box.y1;
-        page->displaySlice(splashOut, hDPI2, vDPI2, (360 - page->getRotate()) % 360, useMediaBox, crop, sliceX, stripeY, sliceW, stripeH, printing, abortCheckCbk, abortCheckCbkData, annotDisplayDecideCbk, annotDisplayDecideCbkData);
+        page->displaySlice(splashOut, hDPI, vDPI, (360 - page->getRotate()) % 360, useMediaBox, crop, sliceX, stripeY, sliceW, stripeH, printing, abortCheckCbk, abortCheckCbkData, annotDisplayDecideCbk, annotDisplayDecideCbkData);
 
-        // draw the rasterized image
+        // draw the rasterized image, unless it is blank: the page is
+        // blank under it, but for what an underlay callback may draw
         bitmap = splashOut->getBitmap();
+        if (mode == psModePS && !underlayCbk && bitmapIsBlank(bitmap, paperColor[0])) {
+            continue;
+        }
         numComps = initialNumComps;
         w = bitmap->getWidth();
         h = bitmap->getHeight();
-        writePS("gsave\n");
-        writePSFmt("[{0:.6g} {1:.6g} {2:.6g} {3:.6g} {4:.6g} {5:.6g}] concat\n", m0, m1, m2, m3, m4, m5);
+        out.write("gsave\n");
+        out.writeFmt("[{0:.6g} {1:.6g} {2:.6g} {3:.6g} {4:.6g} {5:.6g}] concat\n", m0, m1, m2, m3, m4, m5);
         switch (level) {
         case psLevel1:
-            writePSFmt("{0:d} {1:d} 8 [{2:d} 0 0 {3:d} 0 {4:d}] pdfIm1{5:s}\n", w, h, w, -h, h, useBinary ? "Bin" : "");
+            out.writeFmt("{0:d} {1:d} 8 [{2:d} 0 0 {3:d} 0 {4:d}] pdfIm1{5:s}\n", w, h, w, -h, h, useBinary ? "Bin" : "");
             p = bitmap->getDataPtr() + (h - 1) * bitmap->getRowSize();
             i = 0;
             if (useBinary) {
@@ -3304,7 +3598,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                     for (x = 0; x < w; ++x) {
                         hexBuf[i++] = *p++;
                         if (i >= 64) {
-                            writePSBuf(hexBuf, i);
+                            out.writeBuf(hexBuf, i);
                             i = 0;
                         }
                     }
@@ -3318,7 +3612,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                         hexBuf[i++] = digit + ((digit >= 10) ? 'a' - 10 : '0');
                         if (i >= 64) {
                             hexBuf[i++] = '\n';
-                            writePSBuf(hexBuf, i);
+                            out.writeBuf(hexBuf, i);
                             i = 0;
                         }
                     }
@@ -3328,7 +3622,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                 if (!useBinary) {
                     hexBuf[i++] = '\n';
                 }
-                writePSBuf(hexBuf, i);
+                out.writeBuf(hexBuf, i);
             }
             break;
         case psLevel1Sep:
@@ -3349,13 +3643,13 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
             } else {
                 isOptimizedGray = false;
             }
-            writePSFmt("{0:d} {1:d} 8 [{2:d} 0 0 {3:d} 0 {4:d}] pdfIm1{5:s}{6:s}\n", w, h, w, -h, h, isOptimizedGray ? "" : "Sep", useBinary ? "Bin" : "");
+            out.writeFmt("{0:d} {1:d} 8 [{2:d} 0 0 {3:d} 0 {4:d}] pdfIm1{5:s}{6:s}\n", w, h, w, -h, h, isOptimizedGray ? "" : "Sep", useBinary ? "Bin" : "");
             p = bitmap->getDataPtr() + (h - 1) * bitmap->getRowSize();
             i = 0;
             col[0] = col[1] = col[2] = col[3] = 0;
             if (isOptimizedGray) {
                 int g;
-                if ((psProcessBlack & processColors) == 0) {
+                if ((psProcessBlack & *processColorsA) == 0) {
                     // Check if the image uses black
                     for (y = 0; y < h; ++y) {
                         for (x = 0; x < w; ++x) {
@@ -3379,7 +3673,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                                 g = 0;
                             hexBuf[i++] = (unsigned char)g;
                             if (i >= 64) {
-                                writePSBuf(hexBuf, i);
+                                out.writeBuf(hexBuf, i);
                                 i = 0;
                             }
                         }
@@ -3396,14 +3690,14 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                             hexBuf[i++] = digit + ((digit >= 10) ? 'a' - 10 : '0');
                             if (i >= 64) {
                                 hexBuf[i++] = '\n';
-                                writePSBuf(hexBuf, i);
+                                out.writeBuf(hexBuf, i);
                                 i = 0;
                             }
                         }
                     }
                     p -= bitmap->getRowSize();
                 }
-            } else if (((psProcessCyan | psProcessMagenta | psProcessYellow | psProcessBlack) & ~processColors) != 0) {
+            } else if (((psProcessCyan | psProcessMagenta | psProcessYellow | psProcessBlack) & ~*processColorsA) != 0) {
                 // Color image, need to check color flags for each dot
                 for (y = 0; y < h; ++y) {
                     for (comp = 0; comp < 4; ++comp) {
@@ -3413,7 +3707,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                                 col[comp] |= p[4 * x + comp];
                                 hexBuf[i++] = p[4 * x + comp];
                                 if (i >= 64) {
-                                    writePSBuf(hexBuf, i);
+                                    out.writeBuf(hexBuf, i);
                                     i = 0;
                                 }
                             }
@@ -3427,7 +3721,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                                 hexBuf[i++] = digit + ((digit >= 10) ? 'a' - 10 : '0');
                                 if (i >= 64) {
                                     hexBuf[i++] = '\n';
-                                    writePSBuf(hexBuf, i);
+                                    out.writeBuf(hexBuf, i);
                                     i = 0;
                                 }
                             }
@@ -3444,7 +3738,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                             for (x = 0; x < w; ++x) {
                                 hexBuf[i++] = p[4 * x + comp];
                                 if (i >= 64) {
-                                    writePSBuf(hexBuf, i);
+                                    out.writeBuf(hexBuf, i);
                                     i = 0;
                                 }
                             }
@@ -3457,7 +3751,7 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                                 hexBuf[i++] = digit + ((digit >= 10) ? 'a' - 10 : '0');
                                 if (i >= 64) {
                                     hexBuf[i++] = '\n';
-                                    writePSBuf(hexBuf, i);
+                                    out.writeBuf(hexBuf, i);
                                     i = 0;
                                 }
                             }
@@ -3470,19 +3764,19 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                 if (!useBinary) {
                     hexBuf[i++] = '\n';
                 }
-                writePSBuf(hexBuf, i);
+                out.writeBuf(hexBuf, i);
             }
             if (col[0]) {
-                processColors |= psProcessCyan;
+                *processColorsA |= psProcessCyan;
             }
             if (col[1]) {
-                processColors |= psProcessMagenta;
+                *processColorsA |= psProcessMagenta;
             }
             if (col[2]) {
-                processColors |= psProcessYellow;
+                *processColorsA |= psProcessYellow;
             }
             if (col[3]) {
-                processColors |= psProcessBlack;
+                *processColorsA |= psProcessBlack;
             }
             break;
         case psLevel2:
@@ -3556,46 +3850,46 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                 }
             }
             if (numComps == 1) {
-                writePS("/DeviceGray setcolorspace\n");
+                out.write("/DeviceGray setcolorspace\n");
             } else if (numComps == 3) {
-                writePS("/DeviceRGB setcolorspace\n");
+                out.write("/DeviceRGB setcolorspace\n");
             } else {
-                writePS("/DeviceCMYK setcolorspace\n");
+                out.write("/DeviceCMYK setcolorspace\n");
             }
-            writePS("<<\n  /ImageType 1\n");
-            writePSFmt("  /Width {0:d}\n", bitmap->getWidth());
-            writePSFmt("  /Height {0:d}\n", bitmap->getHeight());
-            writePSFmt("  /ImageMatrix [{0:d} 0 0 {1:d} 0 {2:d}]\n", w, -h, h);
-            writePS("  /BitsPerComponent 8\n");
+            out.write("<<\n  /ImageType 1\n");
+            out.writeFmt("  /Width {0:d}\n", bitmap->getWidth());
+            out.writeFmt("  /Height {0:d}\n", bitmap->getHeight());
+            out.writeFmt("  /ImageMatrix [{0:d} 0 0 {1:d} 0 {2:d}]\n", w, -h, h);
+            out.write("  /BitsPerComponent 8\n");
             if (numComps == 1) {
                 // the optimized gray variants are implemented as a subtractive color space,
                 // such that the range is flipped for them
                 if (isOptimizedGray) {
-                    writePS("  /Decode [1 0]\n");
+                    out.write("  /Decode [1 0]\n");
                 } else {
-                    writePS("  /Decode [0 1]\n");
+                    out.write("  /Decode [0 1]\n");
                 }
             } else if (numComps == 3) {
-                writePS("  /Decode [0 1 0 1 0 1]\n");
+                out.write("  /Decode [0 1 0 1 0 1]\n");
             } else {
-                writePS("  /Decode [0 1 0 1 0 1 0 1]\n");
+                out.write("  /Decode [0 1 0 1 0 1 0 1]\n");
             }
-            writePS("  /DataSource currentfile\n");
+            out.write("  /DataSource currentfile\n");
             if (useBinary) {
                 /* nothing to do */;
             } else if (useASCIIHex) {
-                writePS("    /ASCIIHexDecode filter\n");
+                out.write("    /ASCIIHexDecode filter\n");
             } else {
-                writePS("    /ASCII85Decode filter\n");
+                out.write("    /ASCII85Decode filter\n");
             }
             if (useFlate) {
-                writePS("    /FlateDecode filter\n");
+                out.write("    /FlateDecode filter\n");
             } else if (useLZW) {
-                writePS("    /LZWDecode filter\n");
+                out.write("    /LZWDecode filter\n");
             } else {
-                writePS("    /RunLengthDecode filter\n");
+                out.write("    /RunLengthDecode filter\n");
             }
-            writePS(">>\n");
+            out.write(">>\n");
             if (useBinary) {
                 /* nothing to do */;
             } else if (useASCIIHex) {
@@ -3611,31 +3905,280 @@ bool PSOutputDev::checkPageSlice(Page *page, double /*hDPI*/, double /*vDPI*/, i
                     len++;
                 }
                 str->reset();
-                writePSFmt("%%BeginData: {0:d} Binary Bytes\n", len + 6 + 1);
+                out.writeFmt("%%BeginData: {0:d} Binary Bytes\n", len + 6 + 1);
             }
-            writePS("image\n");
+            out.write("image\n");
             while ((c = str->getChar()) != EOF) {
-                writePSChar(c);
+                out.writeChar(c);
             }
             str->close();
             delete str;
             delete str0;
-            writePSChar('\n');
+            out.writeChar('\n');
             if (useBinary) {
-                writePS("%%EndData\n");
+                out.write("%%EndData\n");
             }
-            processColors |= (numComps == 1) ? psProcessBlack : psProcessCMYK;
+            *processColorsA |= (numComps == 1) ? psProcessBlack : psProcessCMYK;
             break;
         }
-        writePS("grestore\n");
+        out.write("grestore\n");
     }
 
     delete splashOut;
 
-    // finish the PS page
-    endPage();
+    return true;
+}
 
-    return false;
+void PSOutputDev::setRasterThreads(int nThreads, const GooString *ownerPassword, const GooString *userPassword)
+{
+    if (!rasterWorkers.empty()) {
+        return;
+    }
+    rasterThreads = doc->getFileName() ? nThreads : 0;
+    delete rasterOwnerPW;
+    delete rasterUserPW;
+    rasterOwnerPW = ownerPassword ? ownerPassword->copy() : nullptr;
+    rasterUserPW = userPassword ? userPassword->copy() : nullptr;
+}
+
+// Queue the pages following <pg> in the page list for the worker
+// threads, and return the job of <pg> once it is pre-scanned -- or
+// nullptr if there is none, or if it was queued with other parameters.
+// The job must then be passed to writeRasterJob or releaseRasterJob.
+PSRasterJob *PSOutputDev::takeRasterJob(int pg, int rotateA, bool useMediaBox, bool crop, bool printing)
+{
+    PSRasterJob *job;
+
+    std::unique_lock<std::mutex> lock { rasterMutex };
+    if (rasterWorkers.empty()) {
+        for (size_t i = 0; i < pages.size(); ++i) {
+            rasterPageIdx[pages[i]].push_back(i);
+        }
+        for (int i = 0; i < rasterThreads; ++i) {
+            rasterWorkers.emplace_back(&PSOutputDev::rasterThreadMain, this);
+        }
+    }
+
+    // a page listed more than once is looked for from the page output
+    // last on
+    const auto pos = rasterPageIdx.find(pg);
+    if (pos == rasterPageIdx.end()) {
+        return nullptr;
+    }
+    const auto idxPos = std::lower_bound(pos->second.begin(), pos->second.end(), rasterHead);
+    const size_t idx = idxPos != pos->second.end() ? *idxPos : pos->second.front();
+    rasterHead = idx;
+
+    // drop the pages skipped by the caller, they are first in the queue
+    while (!rasterQueue.empty() && rasterQueue.front()->idx < idx) {
+        rasterQueue.pop_front();
+    }
+    for (auto it = rasterJobs.begin(); it != rasterJobs.end() && it->first < idx;) {
+        dropRasterJob(it->second);
+        it = rasterJobs.erase(it);
+    }
+
+    // keep two pages per thread queued or ready
+    rasterNextPage = std::max(rasterNextPage, idx);
+    while (rasterNextPage < pages.size() && rasterNextPage <= idx + 2 * rasterThreads) {
+        job = new PSRasterJob();
+        job->idx = rasterNextPage++;
+        job->pg = pages[job->idx];
+        job->rotate = rotateA;
+        job->useMediaBox = useMediaBox;
+        job->crop = crop;
+        job->printing = printing;
+        // pages scaled to fit the paper aren't prepared at the right
+        // resolution, and are rasterized again by the caller
+        job->hDPI = rasterResolution * (xScale0 > 0 ? xScale0 : 1);
+        job->vDPI = rasterResolution * (yScale0 > 0 ? yScale0 : 1);
+        job->started = false;
+        job->scanned = false;
+        job->done = false;
+        job->abandoned = false;
+        job->ok = false;
+        job->rasterize = false;
+        job->failed = false;
+        job->processColors = 0;
+        rasterJobs[job->idx] = job;
+        rasterQueue.push_back(job);
+    }
+    rasterCond.notify_all();
+
+    const auto it = rasterJobs.find(idx);
+    if (it == rasterJobs.end()) {
+        return nullptr;
+    }
+    job = it->second;
+    rasterJobs.erase(it);
+    rasterCond.wait(lock, [job] { return job->scanned; });
+    if (job->rotate != rotateA || job->useMediaBox != useMediaBox || job->crop != crop || job->printing != printing) {
+        dropRasterJob(job);
+        return nullptr;
+    }
+    return job;
+}
+
+// Output the PostScript code of the page rasterized by <job> as the
+// worker thread passes it on, and delete the job.  Returns false if the
+// worker couldn't rasterize the page, in which case nothing was output.
+bool PSOutputDev::writeRasterJob(PSRasterJob *job)
+{
+    std::string chunk;
+    bool rasterized;
+
+    std::unique_lock<std::mutex> lock { rasterMutex };
+    while (true) {
+        rasterCond.wait(lock, [job] { return job->done || !job->ps.empty(); });
+        if (job->ps.empty()) {
+            break;
+        }
+        chunk.swap(job->ps);
+        rasterBuffered -= chunk.size();
+        lock.unlock();
+        rasterCond.notify_all();
+        outputToStream(outputFunc, outputStream, chunk);
+        chunk.clear();
+        lock.lock();
+    }
+    rasterized = !job->failed;
+    processColors |= job->processColors;
+    delete job;
+    return rasterized;
+}
+
+void PSOutputDev::releaseRasterJob(PSRasterJob *job)
+{
+    if (job) {
+        std::lock_guard<std::mutex> lock { rasterMutex };
+        dropRasterJob(job);
+    }
+}
+
+// Delete <job>, or have its worker delete it if it is busy with it.
+// rasterMutex must be locked.
+void PSOutputDev::dropRasterJob(PSRasterJob *job)
+{
+    if (job->started && !job->done) {
+        job->abandoned = true;
+        rasterCond.notify_all();
+    } else {
+        rasterBuffered -= job->ps.size();
+        delete job;
+    }
+}
+
+void PSOutputDev::rasterThreadMain()
+{
+    PSRasterJob *job;
+
+    // each worker renders from its own copy of the document
+    PDFDoc *workerDoc = new PDFDoc(doc->getFileName()->copy(), rasterOwnerPW, rasterUserPW);
+
+    std::unique_lock<std::mutex> lock { rasterMutex };
+    while (true) {
+        rasterCond.wait(lock, [this] { return rasterQuit || !rasterQueue.empty(); });
+        if (rasterQuit) {
+            break;
+        }
+        job = rasterQueue.front();
+        rasterQueue.pop_front();
+        job->started = true;
+        lock.unlock();
+        prepareRasterJob(workerDoc, job);
+        lock.lock();
+        if (job->abandoned) {
+            rasterBuffered -= job->ps.size();
+            delete job;
+        } else {
+            job->scanned = true;
+            job->done = true;
+        }
+        rasterCond.notify_all();
+    }
+    lock.unlock();
+
+    delete workerDoc;
+}
+
+void PSOutputDev::prepareRasterJob(PDFDoc *workerDoc, PSRasterJob *job)
+{
+    PreScanOutputDev *scan;
+    Page *page;
+    bool rasterize;
+    int processColorsA;
+
+    if (!workerDoc->isOk() || !(page = workerDoc->getPage(job->pg))) {
+        return;
+    }
+    if (forceRasterize == psAlwaysRasterize) {
+        rasterize = true;
+    } else if (streamPages && !pageMayNeedRasterization(page, level)) {
+        rasterize = false;
+    } else {
+        scan = new PreScanOutputDev(level);
+        page->displaySlice(scan, 72, 72, job->rotate, job->useMediaBox, job->crop, -1, -1, -1, -1, job->printing);
+        rasterize = scan->usesTransparency() || scan->usesPatternImageMask();
+        delete scan;
+    }
+    {
+        std::lock_guard<std::mutex> lock { rasterMutex };
+        job->ok = true;
+        job->rasterize = rasterize;
+        job->scanned = true;
+    }
+    rasterCond.notify_all();
+    if (!rasterize) {
+        return;
+    }
+
+    PSRasterOutput out { this, job, std::string() };
+    processColorsA = 0;
+    if (!rasterizePage(workerDoc, page, job->hDPI, job->vDPI, job->useMediaBox, job->printing, -1, -1, -1, -1, &rasterJobAborted, &out, nullptr, nullptr, &outputToRasterJob, &out, &processColorsA)) {
+        std::lock_guard<std::mutex> lock { rasterMutex };
+        job->failed = true;
+        return;
+    }
+    flushRasterOutput(&out);
+    std::lock_guard<std::mutex> lock { rasterMutex };
+    job->processColors = processColorsA;
+}
+
+// Pass the output buffered by a worker thread on to its job.  The page
+// being output takes it as soon as the previous chunk was output, the
+// pages ahead of it wait until the writer made room for it.
+void PSOutputDev::flushRasterOutput(PSRasterOutput *out)
+{
+    PSRasterJob *job = out->job;
+
+    std::unique_lock<std::mutex> lock { rasterMutex };
+    rasterCond.wait(lock, [this, out, job] { return job->abandoned || rasterQuit || (job->idx == rasterHead && job->ps.empty()) || rasterBuffered + out->buf.size() <= rasterMaxBuffered; });
+    if (!job->abandoned && !rasterQuit) {
+        job->ps.append(out->buf);
+        rasterBuffered += out->buf.size();
+    }
+    out->buf.clear();
+    lock.unlock();
+    rasterCond.notify_all();
+}
+
+void PSOutputDev::outputToRasterJob(void *stream, const char *data, int len)
+{
+    PSRasterOutput *out = (PSRasterOutput *)stream;
+
+    out->buf.append(data, len);
+    if (out->buf.size() >= rasterChunkSize) {
+        out->dev->flushRasterOutput(out);
+    }
+}
+
+// Stops the rasterization of pages which won't be output.
+bool PSOutputDev::rasterJobAborted(void *data)
+{
+    PSRasterOutput *out = (PSRasterOutput *)data;
+
+    std::lock_guard<std::mutex> lock { out->dev->rasterMutex };
+    return out->job->abandoned || out->dev->rasterQuit;
 }
 
 void PSOutputDev::startPage(int pageNum, GfxState *state, XRef *xrefA)
@@ -3829,6 +4372,14 @@ void PSOutputDev::startPage(int pageNum, GfxState *state, XRef *xrefA)
 
         writePSFmt("%%PageOrientation: {0:s}\n", landscape ? "Landscape" : "Portrait");
         writePS("%%BeginPageSetup\n");
+        if (streamPages) {
+            // the fonts already set up by the previous pages are skipped,
+            // the others are defined in the xpdf dictionary, as in the
+            // document setup
+            if ((page = doc->getPage(pageNum))) {
+                setupPageResources(page);
+            }
+        }
         if (paperMatch) {
             writePSFmt("{0:d} {1:d} pdfSetupPaper\n", imgURX, imgURY);
         }
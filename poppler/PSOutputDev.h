@@ -52,6 +52,10 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <string>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include "splash/Splash.h"
 
@@ -68,6 +72,8 @@ struct PSFont8Info;
 struct PSFont16Enc;
 class PSOutCustomColor;
 struct PSOutPaperSize;
+struct PSRasterJob;
+struct PSRasterOutput;
 class PSOutputDev;
 
 //------------------------------------------------------------------------
@@ -314,6 +320,9 @@ public:
     void setRasterAntialias(bool a) { rasterAntialias = a; }
     void setForceRasterize(PSForceRasterize f) { forceRasterize = f; }
     void setRasterResolution(double r) { rasterResolution = r; }
+    // Limit the bitmap of each band of the rasterized pages to about
+    // <bytes> bytes, 0 for the default limit of 20 million pixels.
+    void setRasterBandMemory(size_t bytes) { rasterBandMemory = bytes; }
     void setRasterMono(bool b)
     {
         processColorFormat = splashModeMono8;
@@ -322,6 +331,23 @@ public:
 
     void setUncompressPreloadedImages(bool b) { uncompressPreloadedImages = b; }
 
+    // Write the resources (fonts, preloaded images and forms) of each page
+    // in its page setup, instead of writing those of all the pages in the
+    // document setup, and only pre-scan the pages whose resources may use
+    // transparency.  The output then starts without a pass over the whole
+    // document.  Only applies to psModePS; must be set before the first
+    // page is output.
+    void setStreamPages(bool b) { streamPages = b; }
+
+    // Pre-scan and rasterize the pages ahead of the one being output in
+    // <nThreads> worker threads, which open their own copy of the
+    // document, with the given passwords.  The pages are still written in
+    // order, by the thread calling displayPage, and the PostScript code
+    // rasterized ahead of them is limited in size.  Only applies to
+    // documents read from a file, and to whole pages displayed without
+    // callbacks; must be set before the first page is output.
+    void setRasterThreads(int nThreads, const GooString *ownerPassword = nullptr, const GooString *userPassword = nullptr);
+
     bool getEmbedType1() const { return embedType1; }
     bool getEmbedTrueType() const { return embedTrueType; }
     bool getEmbedCIDPostScript() const { return embedCIDPostScript; }
@@ -365,6 +391,7 @@ private:
               int paperWidthA, int paperHeightA, bool noCropA, bool duplexA, PSLevel levelA);
     void postInit();
     void setupResources(Dict *resDict);
+    void setupPageResources(Page *page);
     void setupFonts(Dict *resDict);
     void setupFont(GfxFont *font, Dict *parentResDict);
     void setupEmbeddedType1Font(Ref *id, GooString *psName);
@@ -384,6 +411,17 @@ private:
     void setupImage(Ref id, Stream *str, bool mask);
     void setupForms(Dict *resDict);
     void setupForm(Ref id, Object *strObj);
+    bool rasterizePage(PDFDoc *docA, Page *page, double hDPI, double vDPI, bool useMediaBox, bool printing, int sliceX, int sliceY, int sliceW, int sliceH, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData,
+                       bool (*annotDisplayDecideCbk)(Annot *annot, void *user_data), void *annotDisplayDecideCbkData, PSOutputFunc outputFuncA, void *outputStreamA, int *processColorsA);
+    PSRasterJob *takeRasterJob(int pg, int rotateA, bool useMediaBox, bool crop, bool printing);
+    bool writeRasterJob(PSRasterJob *job);
+    void releaseRasterJob(PSRasterJob *job);
+    void dropRasterJob(PSRasterJob *job);
+    void rasterThreadMain();
+    void prepareRasterJob(PDFDoc *workerDoc, PSRasterJob *job);
+    void flushRasterOutput(PSRasterOutput *out);
+    static void outputToRasterJob(void *stream, const char *data, int len);
+    static bool rasterJobAborted(void *data);
     void addProcessColor(double c, double m, double y, double k);
     void addCustomColor(GfxSeparationColorSpace *sepCS);
     void doPath(const GfxPath *path);
@@ -511,7 +549,9 @@ private:
     bool overprintPreview = false; // enable overprint preview
     bool rasterAntialias; // antialias on rasterize
     bool uncompressPreloadedImages;
+    bool streamPages; // write each page's resources in its page setup
     double rasterResolution; // PostScript rasterization resolution (dpi)
+    size_t rasterBandMemory; // size limit of the bitmap of a rasterized band, 0 for the default
     bool embedType1; // embed Type 1 fonts?
     bool embedTrueType; // embed TrueType fonts?
     bool embedCIDPostScript; // embed CID PostScript fonts?
@@ -540,6 +580,19 @@ private:
     int opi20Nest; // nesting level of OPI 2.0 objects
 #endif
 
+    int rasterThreads; // number of raster worker threads
+    GooString *rasterOwnerPW, *rasterUserPW; // passwords of the document
+    std::vector<std::thread> rasterWorkers;
+    std::unordered_map<int, std::vector<size_t>> rasterPageIdx; // indices in pages of each page
+    std::map<size_t, PSRasterJob *> rasterJobs; // the queued or prepared pages, by index in pages
+    std::deque<PSRasterJob *> rasterQueue; // the pages waiting for a worker
+    size_t rasterNextPage; // index in pages of the next page to queue
+    size_t rasterHead; // index in pages of the page being output
+    size_t rasterBuffered; // bytes of PostScript code prepared but not output yet
+    bool rasterQuit; // set to stop the workers
+    std::mutex rasterMutex;
+    std::condition_variable rasterCond;
+
     bool ok; // set up ok?
     std::set<int> patternsBeingTiled; // the patterns that are being tiled
 
@@ -573,7 +573,7 @@ void Page::displaySlice(OutputDev *out, double hDPI, double vDPI, int rotate, bo
     Object obj = contents.fetch(localXRef);
     if (!obj.isNull()) {
         gfx->saveState();
-        gfx->display(&obj);
+        gfx->display(&obj, &contents);
         gfx->restoreState();
     } else {
         // empty pages need to call dump to do any setup required by the
@@ -609,7 +609,7 @@ void Page::display(Gfx *gfx)
     Object obj = contents.fetch(xref);
     if (!obj.isNull()) {
         gfx->saveState();
-        gfx->display(&obj);
+        gfx->display(&obj, &contents);
         gfx->restoreState();
     }
 }
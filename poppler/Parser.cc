@@ -31,6 +31,7 @@
 #include <config.h>
 
 #include <cstddef>
+#include <vector>
 #include "Object.h"
 #include "Array.h"
 #include "Dict.h"
@@ -62,6 +63,35 @@ Parser::Parser(XRef *xrefA, Object *objectA, bool allowStreamsA) : lexer { xrefA
 
 Parser::~Parser() = default;
 
+// The elements of the arrays and dictionaries being parsed (keys and
+// values alternate for dictionaries).  They are collected here and
+// moved to the Array or Dict once it is complete, so that its storage
+// is allocated once, at the right size.  Nested arrays and dictionaries,
+// and nested parsers, use it as a stack.
+static thread_local std::vector<Object> parseStack;
+
+namespace {
+
+// Marks the start of the elements of an array or dictionary on the
+// parse stack, and drops them on the way out.
+class ParseStackMark
+{
+public:
+    ParseStackMark() : base(parseStack.size()) { }
+    ~ParseStackMark() { parseStack.erase(parseStack.begin() + base, parseStack.end()); }
+
+    ParseStackMark(const ParseStackMark &) = delete;
+    ParseStackMark &operator=(const ParseStackMark &) = delete;
+
+    int getLength() const { return static_cast<int>(parseStack.size() - base); }
+    Object &operator[](int i) const { return parseStack[base + i]; }
+
+private:
+    const size_t base;
+};
+
+}
+
 Object Parser::getObj(int recursion)
 {
     return getObj(false, nullptr, cryptRC4, 0, 0, 0, recursion);
@@ -98,11 +128,16 @@ Object Parser::getObj(bool simpleOnly, const unsigned char *fileKey, CryptAlgori
     // array
     if (!simpleOnly && buf1.isCmd("[")) {
         shift();
-        obj = Object(new Array(lexer.getXRef()));
+        const ParseStackMark elems;
         while (!buf1.isCmd("]") && !buf1.isEOF() && recursion + 1 < recursionLimit) {
-            Object obj2 = getObj(false, fileKey, encAlgorithm, keyLength, objNum, objGen, recursion + 1);
-            obj.arrayAdd(std::move(obj2));
+            parseStack.push_back(getObj(false, fileKey, encAlgorithm, keyLength, objNum, objGen, recursion + 1));
         }
+        Array *array = new Array(lexer.getXRef());
+        array->reserve(elems.getLength());
+        for (int i = 0; i < elems.getLength(); ++i) {
+            array->add(std::move(elems[i]));
+        }
+        obj = Object(array);
         if (recursion + 1 >= recursionLimit && strict)
             goto err;
         if (buf1.isEOF()) {
@@ -115,7 +150,7 @@ Object Parser::getObj(bool simpleOnly, const unsigned char *fileKey, CryptAlgori
         // dictionary or stream
     } else if (!simpleOnly && buf1.isCmd("<<")) {
         shift(objNum);
-        obj = Object(new Dict(lexer.getXRef()));
+        const ParseStackMark entries;
         bool hasContentsEntry = false;
         while (!buf1.isCmd(">>") && !buf1.isEOF()) {
             if (!buf1.isName()) {
@@ -125,7 +160,7 @@ Object Parser::getObj(bool simpleOnly, const unsigned char *fileKey, CryptAlgori
                 shift();
             } else {
                 // buf1 will go away in shift(), so keep the key
-                const auto key = std::move(buf1);
+                Object key = std::move(buf1);
                 shift();
                 if (buf1.isEOF() || buf1.isError()) {
                     if (strict && buf1.isError())
@@ -141,16 +176,22 @@ Object Parser::getObj(bool simpleOnly, const unsigned char *fileKey, CryptAlgori
                 if (unlikely(obj2.isError() && recursion + 1 >= recursionLimit)) {
                     break;
                 }
-                obj.dictAdd(key.getName(), std::move(obj2));
+                parseStack.push_back(std::move(key));
+                parseStack.push_back(std::move(obj2));
             }
         }
+        Dict *dict = new Dict(lexer.getXRef());
+        dict->reserve(entries.getLength() / 2);
+        for (int i = 0; i < entries.getLength(); i += 2) {
+            dict->add(entries[i].getName(), std::move(entries[i + 1]));
+        }
+        obj = Object(dict);
         if (buf1.isEOF()) {
             error(errSyntaxError, getPos(), "End of file inside dictionary");
             if (strict)
                 goto err;
         }
         if (fileKey && hasContentsEntry) {
-            Dict *dict = obj.getDict();
             const bool isSigDict = dict->is("Sig");
             if (!isSigDict) {
                 const Object &contentsObj = dict->lookupNF("Contents");
@@ -241,7 +282,7 @@ Stream *Parser::makeStream(Object &&dict, const unsigned char *fileKey, CryptAlg
     pos = str->getPos();
 
     // get length
-    Object obj = dict.dictLookup("Length", recursion);
+    Object obj = dict.dictLookup(atomLength, recursion);
     if (obj.isInt()) {
         length = obj.getInt();
     } else if (obj.isInt64()) {
@@ -1998,11 +1998,11 @@ reload:
                     codeToGID = (int *)gmallocn(n, sizeof(int));
                     memcpy(codeToGID, ((GfxCIDFont *)gfxFont)->getCIDToGID(), n * sizeof(int));
                 }
+            } else if (fileName) {
+                // the maps of the system fonts are cached
+                codeToGID = ((GfxCIDFont *)gfxFont)->getCodeToGIDMap(fileName, &n);
             } else {
-                if (fileName)
-                    ff = FoFiTrueType::load(fileName->c_str());
-                else
-                    ff = FoFiTrueType::make(tmpBuf, tmpBufLen);
+                ff = FoFiTrueType::make(tmpBuf, tmpBufLen);
                 if (!ff) {
                     error(errSyntaxError, -1, "Couldn't create a font for '{0:s}'", gfxFont->getName() ? gfxFont->getName()->c_str() : "(unnamed)");
                     goto err2;
@@ -2623,6 +2623,30 @@ bool SplashOutputDev::imageMaskSrc(void *data, SplashColorPtr line)
     return true;
 }
 
+bool SplashOutputDev::imageMaskPackedSrc(void *data, unsigned char *line)
+{
+    SplashOutImageMaskData *imgMaskData = (SplashOutImageMaskData *)data;
+    unsigned char *p;
+    int n, i;
+
+    if (imgMaskData->y == imgMaskData->height) {
+        return false;
+    }
+    if (!(p = imgMaskData->imgStr->getPackedLine())) {
+        return false;
+    }
+    n = (imgMaskData->width + 7) >> 3;
+    if (imgMaskData->invert) {
+        for (i = 0; i < n; ++i) {
+            line[i] = p[i] ^ 0xff;
+        }
+    } else {
+        memcpy(line, p, n);
+    }
+    ++imgMaskData->y;
+    return true;
+}
+
 void SplashOutputDev::drawImageMask(GfxState *state, Object *ref, Stream *str, int width, int height, bool invert, bool interpolate, bool inlineImg)
 {
     SplashCoord mat[6];
@@ -2652,7 +2676,7 @@ void SplashOutputDev::drawImageMask(GfxState *state, Object *ref, Stream *str, i
     imgMaskData.height = height;
     imgMaskData.y = 0;
 
-    splash->fillImageMask(&imageMaskSrc, &imgMaskData, width, height, mat, t3GlyphStack != nullptr);
+    splash->fillImageMask(&imageMaskSrc, &imgMaskData, width, height, mat, t3GlyphStack != nullptr, &imageMaskPackedSrc);
     if (inlineImg) {
         while (imgMaskData.y < height) {
             imgMaskData.imgStr->getLine();
@@ -2707,7 +2731,7 @@ void SplashOutputDev::setSoftMaskFromImageMask(GfxState *state, Object *ref, Str
     maskSplash->clear(maskColor);
     maskColor[0] = 0xff;
     maskSplash->setFillPattern(new SplashSolidColor(maskColor));
-    maskSplash->fillImageMask(&imageMaskSrc, &imgMaskData, width, height, mat, t3GlyphStack != nullptr);
+    maskSplash->fillImageMask(&imageMaskSrc, &imgMaskData, width, height, mat, t3GlyphStack != nullptr, &imageMaskPackedSrc);
     delete maskSplash;
     delete imgMaskData.imgStr;
     str->close();
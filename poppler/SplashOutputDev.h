@@ -222,6 +222,10 @@ public:
     // text in Type 3 fonts will be drawn with drawChar/drawString.
     bool interpretType3Chars() override { return true; }
 
+    // Can the drawing operations lying entirely outside the clip region
+    // be skipped?
+    bool useRegionCulling() override { return true; }
+
     //----- initialization and control
 
     // Start a page.
@@ -368,6 +372,7 @@ private:
     static bool iccImageSrc(void *data, SplashColorPtr colorLine, unsigned char *alphaLine);
 #endif
     static bool imageMaskSrc(void *data, SplashColorPtr line);
+    static bool imageMaskPackedSrc(void *data, unsigned char *line);
     static bool imageSrc(void *data, SplashColorPtr colorLine, unsigned char *alphaLine);
     static bool alphaImageSrc(void *data, SplashColorPtr line, unsigned char *alphaLine);
     static bool maskedImageSrc(void *data, SplashColorPtr line, unsigned char *alphaLine);
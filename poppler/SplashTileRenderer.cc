@@ -0,0 +1,241 @@
+//========================================================================
+//
+// SplashTileRenderer.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+
+#include "PDFDoc.h"
+#include "SplashOutputDev.h"
+#include "splash/SplashBitmap.h"
+#include "SplashTileRenderer.h"
+
+//------------------------------------------------------------------------
+// SplashTileCache
+//------------------------------------------------------------------------
+
+bool SplashTileCache::Key::operator<(const Key &other) const
+{
+    if (page != other.page) {
+        return page < other.page;
+    }
+    if (dpi != other.dpi) {
+        return dpi < other.dpi;
+    }
+    if (rotate != other.rotate) {
+        return rotate < other.rotate;
+    }
+    if (row != other.row) {
+        return row < other.row;
+    }
+    return col < other.col;
+}
+
+static size_t getTileMemorySize(const SplashBitmap *tile)
+{
+    size_t n = sizeof(SplashBitmap) + (size_t)std::abs(tile->getRowSize()) * tile->getHeight();
+    if (tile->getAlphaPtr()) {
+        n += (size_t)tile->getWidth() * tile->getHeight();
+    }
+    return n;
+}
+
+SplashTileCache::SplashTileCache(size_t maxSizeA) : maxSize(maxSizeA), size(0) { }
+
+SplashTileCache::~SplashTileCache() = default;
+
+std::shared_ptr<SplashBitmap> SplashTileCache::lookup(const Key &key)
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second.lruPos);
+    return it->second.tile;
+}
+
+void SplashTileCache::put(const Key &key, const std::shared_ptr<SplashBitmap> &tile)
+{
+    const size_t tileSize = getTileMemorySize(tile.get());
+
+    std::lock_guard<std::mutex> lock { mutex };
+    if (tileSize > maxSize) {
+        return;
+    }
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        size -= it->second.size;
+        lru.erase(it->second.lruPos);
+        entries.erase(it);
+    }
+    shrink(maxSize - tileSize);
+    lru.push_front(key);
+    entries[key] = Entry { tile, tileSize, lru.begin() };
+    size += tileSize;
+}
+
+void SplashTileCache::setMaxSize(size_t maxSizeA)
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    maxSize = maxSizeA;
+    shrink(maxSize);
+}
+
+void SplashTileCache::clear()
+{
+    std::lock_guard<std::mutex> lock { mutex };
+    shrink(0);
+}
+
+void SplashTileCache::shrink(size_t newSize)
+{
+    while (!lru.empty() && size > newSize) {
+        const auto last = entries.find(lru.back());
+        size -= last->second.size;
+        entries.erase(last);
+        lru.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------
+// SplashTileRenderer
+//------------------------------------------------------------------------
+
+namespace {
+
+struct AbortCheck
+{
+    bool (*cbk)(void *data);
+    void *data;
+    bool aborted;
+};
+
+}
+
+static bool tileAbortCheck(void *data)
+{
+    AbortCheck *check = static_cast<AbortCheck *>(data);
+    if ((*check->cbk)(check->data)) {
+        check->aborted = true;
+    }
+    return check->aborted;
+}
+
+SplashTileRenderer::SplashTileRenderer(PDFDoc *docA, std::unique_ptr<SplashOutputDev> outA, int tileSizeA, size_t cacheSize)
+    : doc(docA), out(std::move(outA)), tileSize(std::max(tileSizeA, 1)), annotDisplayDecideCbk(nullptr), annotDisplayDecideCbkData(nullptr), cache(cacheSize)
+{
+}
+
+SplashTileRenderer::~SplashTileRenderer() = default;
+
+void SplashTileRenderer::getPageSize(int page, double dpi, int rotate, int *width, int *height)
+{
+    // same rounding as SplashOutputDev::startPage
+    const double w = doc->getPageCropWidth(page) * dpi / 72;
+    const double h = doc->getPageCropHeight(page) * dpi / 72;
+    rotate = (rotate + doc->getPageRotate(page)) % 360;
+    if (rotate < 0) {
+        rotate += 360;
+    }
+    const bool swap = rotate == 90 || rotate == 270;
+    *width = (int)((swap ? h : w) + 0.5);
+    *height = (int)((swap ? w : h) + 0.5);
+}
+
+std::vector<std::shared_ptr<SplashBitmap>> SplashTileRenderer::renderTiles(int page, double dpi, int rotate, const std::vector<std::pair<int, int>> &tiles, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData)
+{
+    std::vector<std::shared_ptr<SplashBitmap>> result(tiles.size());
+    if (page < 1 || page > doc->getNumPages() || dpi <= 0) {
+        return result;
+    }
+
+    int pageWidth, pageHeight;
+    getPageSize(page, dpi, rotate, &pageWidth, &pageHeight);
+    const int nCols = (pageWidth + tileSize - 1) / tileSize;
+    const int nRows = (pageHeight + tileSize - 1) / tileSize;
+
+    // look the tiles up, and get the bounding box of the missing ones
+    std::vector<int> missing;
+    int col0 = INT_MAX, row0 = INT_MAX, col1 = -1, row1 = -1;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const int col = tiles[i].first;
+        const int row = tiles[i].second;
+        if (col < 0 || col >= nCols || row < 0 || row >= nRows) {
+            continue;
+        }
+        result[i] = cache.lookup(SplashTileCache::Key { page, dpi, rotate, col, row });
+        if (!result[i]) {
+            missing.push_back(i);
+            col0 = std::min(col0, col);
+            row0 = std::min(row0, row);
+            col1 = std::max(col1, col);
+            row1 = std::max(row1, row);
+        }
+    }
+    if (missing.empty()) {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock { mutex };
+
+    // render all the missing tiles at once, unless they are so scattered
+    // that most of their bounding box wouldn't be used
+    if ((size_t)(col1 - col0 + 1) * (row1 - row0 + 1) <= 2 * missing.size()) {
+        const int x = col0 * tileSize;
+        const int y = row0 * tileSize;
+        const int w = std::min((col1 + 1) * tileSize, pageWidth) - x;
+        const int h = std::min((row1 + 1) * tileSize, pageHeight) - y;
+        renderRect(page, dpi, rotate, x, y, w, h, missing, tiles, pageWidth, pageHeight, &result, abortCheckCbk, abortCheckCbkData);
+    } else {
+        for (int i : missing) {
+            const int x = tiles[i].first * tileSize;
+            const int y = tiles[i].second * tileSize;
+            const int w = std::min(x + tileSize, pageWidth) - x;
+            const int h = std::min(y + tileSize, pageHeight) - y;
+            if (!renderRect(page, dpi, rotate, x, y, w, h, std::vector<int> { i }, tiles, pageWidth, pageHeight, &result, abortCheckCbk, abortCheckCbkData)) {
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+bool SplashTileRenderer::renderRect(int page, double dpi, int rotate, int x, int y, int w, int h, const std::vector<int> &tiles, const std::vector<std::pair<int, int>> &tilePos, int pageWidth, int pageHeight,
+                                    std::vector<std::shared_ptr<SplashBitmap>> *result, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData)
+{
+    AbortCheck check { abortCheckCbk, abortCheckCbkData, false };
+    // no clipping to the crop box, as when rendering the whole page: the
+    // pixels partly covered by it on the right and bottom edges must be
+    // the same in the tiles
+    doc->displayPageSlice(out.get(), page, dpi, dpi, rotate, false, false, false, x, y, w, h, abortCheckCbk ? &tileAbortCheck : nullptr, &check, annotDisplayDecideCbk, annotDisplayDecideCbkData, true);
+    if (check.aborted) {
+        return false;
+    }
+
+    const SplashBitmap *bitmap = out->getBitmap();
+    for (int i : tiles) {
+        const int tileX = tilePos[i].first * tileSize;
+        const int tileY = tilePos[i].second * tileSize;
+        // the rendered bitmap can be a pixel short because of rounding
+        const int tileW = std::min({ tileSize, pageWidth - tileX, bitmap->getWidth() - (tileX - x) });
+        const int tileH = std::min({ tileSize, pageHeight - tileY, bitmap->getHeight() - (tileY - y) });
+        if (tileW <= 0 || tileH <= 0) {
+            continue;
+        }
+        std::shared_ptr<SplashBitmap> tile { SplashBitmap::copyRect(bitmap, tileX - x, tileY - y, tileW, tileH) };
+        if (!tile->getDataPtr()) {
+            continue;
+        }
+        cache.put(SplashTileCache::Key { page, dpi, rotate, tilePos[i].first, tilePos[i].second }, tile);
+        (*result)[i] = std::move(tile);
+    }
+    return true;
+}
@@ -0,0 +1,140 @@
+//========================================================================
+//
+// SplashTileRenderer.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef SPLASHTILERENDERER_H
+#define SPLASHTILERENDERER_H
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "poppler-config.h"
+#include "poppler_private_export.h"
+
+class Annot;
+class PDFDoc;
+class SplashBitmap;
+class SplashOutputDev;
+
+//------------------------------------------------------------------------
+// SplashTileCache
+//
+// Rendered tiles, keyed by page, resolution, rotation and position, and
+// limited to a total size.  The least recently used tiles are dropped
+// first.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT SplashTileCache
+{
+public:
+    struct Key
+    {
+        int page; // 1-based page number
+        double dpi;
+        int rotate;
+        int col, row; // tile position, in tiles
+
+        bool operator<(const Key &other) const;
+    };
+
+    explicit SplashTileCache(size_t maxSizeA);
+    ~SplashTileCache();
+
+    SplashTileCache(const SplashTileCache &) = delete;
+    SplashTileCache &operator=(const SplashTileCache &) = delete;
+
+    // Returns nullptr if the tile isn't cached.
+    std::shared_ptr<SplashBitmap> lookup(const Key &key);
+    void put(const Key &key, const std::shared_ptr<SplashBitmap> &tile);
+
+    void setMaxSize(size_t maxSizeA);
+    size_t getMaxSize() const { return maxSize; }
+
+    // Drop all the cached tiles.
+    void clear();
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<SplashBitmap> tile;
+        size_t size;
+        std::list<Key>::iterator lruPos;
+    };
+
+    void shrink(size_t newSize);
+
+    size_t maxSize;
+    size_t size;
+    std::map<Key, Entry> entries;
+    std::list<Key> lru; // most recently used first
+    std::mutex mutex;
+};
+
+//------------------------------------------------------------------------
+// SplashTileRenderer
+//
+// Renders the pages of a document as square tiles of <tileSize>
+// pixels, tile (col, row) covering the pixels from (col * tileSize,
+// row * tileSize); the tiles on the right and bottom edges of the page
+// are cut to the page size.  The tiles missing from the cache are
+// rendered together, with one pass over the page content.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT SplashTileRenderer
+{
+public:
+    // <outA> must be set up, and started on <docA>, by the caller; it is
+    // owned by the renderer.  Its settings (paper color, antialiasing,
+    // color profile...) are not part of the cache keys: they must not be
+    // changed afterwards, use a new renderer instead.
+    SplashTileRenderer(PDFDoc *docA, std::unique_ptr<SplashOutputDev> outA, int tileSizeA, size_t cacheSize);
+    ~SplashTileRenderer();
+
+    SplashTileRenderer(const SplashTileRenderer &) = delete;
+    SplashTileRenderer &operator=(const SplashTileRenderer &) = delete;
+
+    // Called to decide which annotations are drawn, as with
+    // PDFDoc::displayPageSlice.
+    void setAnnotDisplayDecideCbk(bool (*cbk)(Annot *annot, void *user_data), void *data)
+    {
+        annotDisplayDecideCbk = cbk;
+        annotDisplayDecideCbkData = data;
+    }
+
+    int getTileSize() const { return tileSize; }
+    SplashTileCache *getCache() { return &cache; }
+
+    // Size of page <page> (1-based), in pixels, at <dpi> and with the
+    // extra rotation <rotate>.
+    void getPageSize(int page, double dpi, int rotate, int *width, int *height);
+
+    // Returns the tiles <tiles> (columns and rows) of page <page>, in
+    // the same order; the tiles outside the page are nullptr.  If the
+    // rendering is stopped by <abortCheckCbk>, the tiles it was busy
+    // with are nullptr too.
+    std::vector<std::shared_ptr<SplashBitmap>> renderTiles(int page, double dpi, int rotate, const std::vector<std::pair<int, int>> &tiles, bool (*abortCheckCbk)(void *data) = nullptr, void *abortCheckCbkData = nullptr);
+
+private:
+    // renders the pixels (x, y, w, h) and cuts them into <tiles>; returns
+    // false if the rendering was aborted
+    bool renderRect(int page, double dpi, int rotate, int x, int y, int w, int h, const std::vector<int> &tiles, const std::vector<std::pair<int, int>> &tilePos, int pageWidth, int pageHeight,
+                    std::vector<std::shared_ptr<SplashBitmap>> *result, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData);
+
+    PDFDoc *doc;
+    std::unique_ptr<SplashOutputDev> out;
+    int tileSize;
+    bool (*annotDisplayDecideCbk)(Annot *annot, void *user_data);
+    void *annotDisplayDecideCbkData;
+    SplashTileCache cache;
+    std::mutex mutex; // out can render one slice at a time
+};
+
+#endif
@@ -128,7 +128,38 @@ char *Stream::getLine(char *buf, int size)
 
     if (lookChar() == EOF || size < 0)
         return nullptr;
-    for (i = 0; i < size - 1; ++i) {
+    i = 0;
+
+    // look for the end of line in the stream's buffer, if it has one
+    const unsigned char *p = nullptr;
+    int n;
+    while (i < size - 1 && (p = getBuffer(&n)) && n > 0) {
+        const int m = std::min(n, size - 1 - i);
+        const unsigned char *eol = (const unsigned char *)memchr(p, '\n', m);
+        int lineLength = eol ? eol - p : m;
+        if (const unsigned char *cr = (const unsigned char *)memchr(p, '\r', lineLength)) {
+            lineLength = cr - p;
+        }
+        memcpy(buf + i, p, lineLength);
+        i += lineLength;
+        if (lineLength < m) {
+            c = p[lineLength];
+            skipBuffer(lineLength + 1);
+            if (c == '\r' && lookChar() == '\n') {
+                getChar();
+            }
+            buf[i] = '\0';
+            return buf;
+        }
+        skipBuffer(m);
+    }
+    if (p && i < size - 1) {
+        // end of stream
+        buf[i] = '\0';
+        return buf;
+    }
+
+    for (; i < size - 1; ++i) {
         c = getChar();
         if (c == EOF || c == '\n')
             break;
@@ -185,13 +216,13 @@ Stream *Stream::addFilters(Dict *dict, int recursion)
     int i;
 
     str = this;
-    obj = dict->lookup("Filter", recursion);
+    obj = dict->lookup(atomFilter, recursion);
     if (obj.isNull()) {
-        obj = dict->lookup("F", recursion);
+        obj = dict->lookup(atomF, recursion);
     }
-    params = dict->lookup("DecodeParms", recursion);
+    params = dict->lookup(atomDecodeParms, recursion);
     if (params.isNull()) {
-        params = dict->lookup("DP", recursion);
+        params = dict->lookup(atomDP, recursion);
     }
     if (obj.isName()) {
         str = makeFilter(obj.getName(), str, &params, recursion, dict);
@@ -372,12 +403,17 @@ Stream *Stream::makeFilter(const char *name, Stream *str, Object *params, int re
         str = new FlateStream(str, pred, columns, colors, bits);
     } else if (!strcmp(name, "JBIG2Decode")) {
         Object globals;
+        JBIG2GlobalsCache *globalsCache = nullptr;
         if (params->isDict()) {
             XRef *xref = params->getDict()->getXRef();
             obj = params->dictLookupNF("JBIG2Globals").copy();
             globals = obj.fetch(xref, recursion);
+            // the globals of a modified document may change
+            if (xref && !xref->isModified()) {
+                globalsCache = xref->getJBIG2GlobalsCache();
+            }
         }
-        str = new JBIG2Stream(str, std::move(globals), &obj);
+        str = new JBIG2Stream(str, std::move(globals), &obj, globalsCache);
     } else if (!strcmp(name, "JPXDecode")) {
 #ifdef HAVE_JPX_DECODER
         str = new JPXStream(str);
@@ -692,6 +728,21 @@ unsigned char *ImageStream::getLine()
     return imgLine;
 }
 
+unsigned char *ImageStream::getPackedLine()
+{
+    if (unlikely(inputLine == nullptr)) {
+        return nullptr;
+    }
+
+    int readChars = str->doGetChars(inputLineSize, inputLine);
+    if (unlikely(readChars == -1)) {
+        readChars = 0;
+    }
+    for (; readChars < inputLineSize; readChars++)
+        inputLine[readChars] = EOF;
+    return inputLine;
+}
+
 void ImageStream::skipLine()
 {
     str->doGetChars(inputLineSize, inputLine);
@@ -2341,6 +2392,20 @@ int CCITTFaxStream::lookChar()
     return buf;
 }
 
+int CCITTFaxStream::getChars(int nChars, unsigned char *buffer)
+{
+    int n, c;
+
+    for (n = 0; n < nChars; ++n) {
+        if ((c = CCITTFaxStream::lookChar()) == EOF) {
+            break;
+        }
+        buffer[n] = (unsigned char)c;
+        buf = EOF;
+    }
+    return n;
+}
+
 short CCITTFaxStream::getTwoDimCode()
 {
     int code;
@@ -4224,6 +4289,43 @@ int FlateStream::lookChar()
     return c;
 }
 
+const unsigned char *FlateStream::getBuffer(int *nChars)
+{
+    if (pred) {
+        *nChars = 0;
+        return nullptr;
+    }
+    // readSome() produces at most one code word's worth of output (258
+    // bytes), often a single byte: decode ahead, after the pending data,
+    // until a good part of the window is filled
+    if (remain < flateMinBuffer) {
+        const int start = index;
+        int total = remain;
+        index = (index + remain) & flateMask;
+        while (total < flateMinBuffer && !(endOfBlock && eof)) {
+            remain = 0;
+            readSome();
+            total += remain;
+            index = (index + remain) & flateMask;
+        }
+        index = start;
+        remain = total;
+    }
+    if (remain == 0) {
+        *nChars = 0;
+        return buf;
+    }
+    // the output buffer is circular: stop at its end
+    *nChars = std::min(remain, flateWindow - index);
+    return buf + index;
+}
+
+void FlateStream::skipBuffer(int n)
+{
+    index = (index + n) & flateMask;
+    remain -= n;
+}
+
 void FlateStream::getRawChars(int nChars, int *buffer)
 {
     for (int i = 0; i < nChars; ++i)
@@ -4298,7 +4400,9 @@ void FlateStream::readSome()
         }
 
     } else {
-        len = (blockLen < flateWindow) ? blockLen : flateWindow;
+        // at most half the window, so that getBuffer() can decode ahead
+        // without overwriting pending data
+        len = (blockLen < flateWindow / 2) ? blockLen : flateWindow / 2;
         for (i = 0, j = index; i < len; ++i, j = (j + 1) & flateMask) {
             if ((c = str->getChar()) == EOF) {
                 endOfBlock = eof = true;
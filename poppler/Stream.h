@@ -42,7 +42,9 @@
 #ifndef STREAM_H
 #define STREAM_H
 
+#include <algorithm>
 #include <atomic>
+#include <climits>
 #include <cstdio>
 
 #include "poppler-config.h"
@@ -186,6 +188,19 @@ public:
     // Peek at next char in stream.
     virtual int lookChar() = 0;
 
+    // Direct access to data that is already in memory.  If the stream
+    // supports it, returns a pointer to the next chars (decoding more
+    // data first if there are none) and sets <*nChars> to their number,
+    // which is 0 at the end of the stream.  skipBuffer(<n>) then skips
+    // <n> of them, as <n> calls to getChar() would.  Returns nullptr if
+    // the stream doesn't support it.
+    virtual const unsigned char *getBuffer(int *nChars)
+    {
+        *nChars = 0;
+        return nullptr;
+    }
+    virtual void skipBuffer(int n) { }
+
     // Get next char from stream without using the predictor.
     // This is only used by StreamPredictor.
     virtual int getRawChar();
@@ -370,6 +385,12 @@ public:
     void close() override;
     int getChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr++ & 0xff); }
     int lookChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr & 0xff); }
+    const unsigned char *getBuffer(int *nChars) override
+    {
+        *nChars = (bufPtr >= bufEnd && !fillBuf()) ? 0 : (int)(bufEnd - bufPtr);
+        return (const unsigned char *)bufPtr;
+    }
+    void skipBuffer(int n) override { bufPtr += n; }
     Goffset getPos() override { return bufPos + (bufPtr - buf); }
     void setPos(Goffset pos, int dir = 0) override;
     Goffset getStart() override { return start; }
@@ -459,6 +480,11 @@ public:
     // end of file.
     unsigned char *getLine();
 
+    // Returns a pointer to the next line of a 1 bit, 1 component image,
+    // packed 8 pixels per byte as in the stream.  Returns NULL at end of
+    // file.
+    unsigned char *getPackedLine();
+
     // Skip an entire line from the image.
     void skipLine();
 
@@ -530,6 +556,12 @@ public:
     void close() override;
     int getChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr++ & 0xff); }
     int lookChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr & 0xff); }
+    const unsigned char *getBuffer(int *nChars) override
+    {
+        *nChars = (bufPtr >= bufEnd && !fillBuf()) ? 0 : (int)(bufEnd - bufPtr);
+        return (const unsigned char *)bufPtr;
+    }
+    void skipBuffer(int n) override { bufPtr += n; }
     Goffset getPos() override { return bufPos + (bufPtr - buf); }
     void setPos(Goffset pos, int dir = 0) override;
     Goffset getStart() override { return start; }
@@ -551,6 +583,28 @@ private:
 
         n = 0;
         while (n < nChars) {
+            if (bufPtr >= bufEnd && nChars - n >= fileStreamBufSize) {
+                // large reads bypass the buffer
+                const Goffset pos = bufPos + (bufEnd - buf);
+                m = nChars - n;
+                if (limited) {
+                    if (pos >= start + length) {
+                        break;
+                    }
+                    if (pos + m > start + length) {
+                        m = (int)(start + length - pos);
+                    }
+                }
+                m = file->read((char *)buffer + n, m, offset);
+                if (m <= 0) {
+                    break;
+                }
+                offset += m;
+                bufPos = pos + m;
+                bufPtr = bufEnd = buf;
+                n += m;
+                continue;
+            }
             if (bufPtr >= bufEnd) {
                 if (!fillBuf()) {
                     break;
@@ -600,6 +654,12 @@ public:
     void close() override;
     int getChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr++ & 0xff); }
     int lookChar() override { return (bufPtr >= bufEnd && !fillBuf()) ? EOF : (*bufPtr & 0xff); }
+    const unsigned char *getBuffer(int *nChars) override
+    {
+        *nChars = (bufPtr >= bufEnd && !fillBuf()) ? 0 : (int)(bufEnd - bufPtr);
+        return (const unsigned char *)bufPtr;
+    }
+    void skipBuffer(int n) override { bufPtr += n; }
     Goffset getPos() override { return bufPos + (bufPtr - buf); }
     void setPos(Goffset pos, int dir = 0) override;
     Goffset getStart() override { return start; }
@@ -663,6 +723,14 @@ public:
 
     int lookChar() override { return (bufPtr < bufEnd) ? (*bufPtr & 0xff) : EOF; }
 
+    const unsigned char *getBuffer(int *nChars) override
+    {
+        *nChars = (int)std::min<Goffset>(bufEnd - bufPtr, INT_MAX);
+        return (const unsigned char *)bufPtr;
+    }
+
+    void skipBuffer(int n) override { bufPtr += n; }
+
     Goffset getPos() override { return (int)(bufPtr - buf); }
 
     void setPos(Goffset pos, int dir = 0) override
@@ -963,6 +1031,9 @@ public:
 
     void unfilteredReset() override;
 
+    bool hasGetChars() override { return true; }
+    int getChars(int nChars, unsigned char *buffer) override;
+
     int getEncoding() { return encoding; }
     bool getEndOfLine() { return endOfLine; }
     bool getEncodedByteAlign() { return byteAlign; }
@@ -1119,6 +1190,7 @@ private:
 
 #    define flateWindow 32768 // buffer size
 #    define flateMask (flateWindow - 1)
+#    define flateMinBuffer (flateWindow / 4) // amount getBuffer() decodes ahead
 #    define flateMaxHuffman 15 // max Huffman code length
 #    define flateMaxCodeLenCodes 19 // max # code length codes
 #    define flateMaxLitCodes 288 // max # literal codes
@@ -1155,6 +1227,8 @@ public:
     int lookChar() override;
     int getRawChar() override;
     void getRawChars(int nChars, int *buffer) override;
+    const unsigned char *getBuffer(int *nChars) override;
+    void skipBuffer(int n) override;
     GooString *getPSFilter(int psLevel, const char *indent) override;
     bool isBinary(bool last = true) const override;
     void unfilteredReset() override;
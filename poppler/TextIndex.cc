@@ -0,0 +1,356 @@
+//========================================================================
+//
+// TextIndex.cc
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "goo/gmem.h"
+#include "goo/gfile.h"
+#include "goo/GooString.h"
+#include "PDFDoc.h"
+#include "TextOutputDev.h"
+#include "UnicodeTypeTable.h"
+#include "UTF.h"
+#include "TextIndex.h"
+
+//------------------------------------------------------------------------
+
+// the on-disk format is "PTXI", a version number and then the raw
+// arrays of every page in host byte order, so an index file is only
+// meant to be read back on the machine that wrote it
+static const char textIndexMagic[4] = { 'P', 'T', 'X', 'I' };
+static const uint32_t textIndexVersion = 1;
+
+struct TextIndex::Page
+{
+    // NFKC-normalized text; words are separated by a single space
+    std::vector<Unicode> text;
+    std::vector<int> textBox; // box index of each <text> entry, -1 for separators
+    // ASCII translation of <text>, for diacritics insensitive search
+    std::vector<Unicode> ascii;
+    std::vector<int> asciiBox; // box index of each <ascii> entry, -1 for separators
+    std::vector<PDFRectangle> boxes; // one box per extracted character
+    std::vector<int> boxWord; // word index of each box
+    // upper-cased <text> and <ascii>, for case insensitive search; not
+    // saved, they are rebuilt when the index is built or loaded
+    std::vector<Unicode> upperText;
+    std::vector<Unicode> upperAscii;
+
+    void makeUpper();
+};
+
+void TextIndex::Page::makeUpper()
+{
+    upperText.resize(text.size());
+    std::transform(text.begin(), text.end(), upperText.begin(), unicodeToUpper);
+    upperAscii.resize(ascii.size());
+    std::transform(ascii.begin(), ascii.end(), upperAscii.begin(), unicodeToUpper);
+}
+
+namespace {
+
+inline bool isTermSeparator(Unicode u)
+{
+    return u == 0x20 || u == 0x09 || u == 0x0a || u == 0x0d || u == 0x3000;
+}
+
+template<typename T>
+bool writeVector(FILE *f, const std::vector<T> &v)
+{
+    const uint32_t n = v.size();
+    if (fwrite(&n, sizeof(n), 1, f) != 1) {
+        return false;
+    }
+    return n == 0 || fwrite(v.data(), sizeof(T), n, f) == n;
+}
+
+template<typename T>
+bool readVector(FILE *f, std::vector<T> *v)
+{
+    uint32_t n;
+    if (fread(&n, sizeof(n), 1, f) != 1) {
+        return false;
+    }
+    // don't trust the count blindly: grow while reading
+    v->clear();
+    T buf[256];
+    while (n > 0) {
+        const uint32_t chunk = n < 256 ? n : 256;
+        if (fread(buf, sizeof(T), chunk, f) != chunk) {
+            return false;
+        }
+        v->insert(v->end(), buf, buf + chunk);
+        n -= chunk;
+    }
+    return true;
+}
+
+bool checkBoxIndices(const std::vector<Unicode> &text, const std::vector<int> &textBox, int nBoxes)
+{
+    if (text.size() != textBox.size()) {
+        return false;
+    }
+    for (const int b : textBox) {
+        if (b < -1 || b >= nBoxes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TextIndex::TextIndex() : firstPage(1) { }
+
+TextIndex::~TextIndex() = default;
+
+std::unique_ptr<TextIndex> TextIndex::build(PDFDoc *doc, int firstPage, int lastPage, bool (*abortCheckCbk)(void *data), void *abortCheckCbkData)
+{
+    if (lastPage < 0 || lastPage > doc->getNumPages()) {
+        lastPage = doc->getNumPages();
+    }
+    if (firstPage < 1) {
+        firstPage = 1;
+    }
+
+    std::unique_ptr<TextIndex> index(new TextIndex());
+    index->firstPage = firstPage;
+
+    TextOutputDev textOut(nullptr, false, 0, false, false);
+    if (!textOut.isOk()) {
+        return nullptr;
+    }
+
+    for (int pg = firstPage; pg <= lastPage; ++pg) {
+        if (abortCheckCbk && (*abortCheckCbk)(abortCheckCbkData)) {
+            return nullptr;
+        }
+
+        auto page = std::make_unique<Page>();
+
+        doc->displayPage(&textOut, pg, 72, 72, 0, false, true, false);
+        TextPage *textPage = textOut.takeText();
+        std::unique_ptr<TextWordList> wordList = textPage->makeWordList(false);
+
+        for (int w = 0; w < wordList->getLength(); ++w) {
+            const TextWord *word = wordList->get(w);
+            const int len = word->getLength();
+            if (len == 0) {
+                continue;
+            }
+
+            const int boxBase = page->boxes.size();
+            for (int i = 0; i < len; ++i) {
+                PDFRectangle box;
+                word->getCharBBox(i, &box.x1, &box.y1, &box.x2, &box.y2);
+                page->boxes.push_back(box);
+                page->boxWord.push_back(w);
+            }
+
+            if (!page->text.empty()) {
+                page->text.push_back(0x20);
+                page->textBox.push_back(-1);
+                page->ascii.push_back(0x20);
+                page->asciiBox.push_back(-1);
+            }
+
+            int normLen;
+            int *normIdx;
+            Unicode *norm = unicodeNormalizeNFKC(word->getChar(0), len, &normLen, &normIdx);
+            for (int i = 0; i < normLen; ++i) {
+                page->text.push_back(norm[i]);
+                page->textBox.push_back(boxBase + normIdx[i]);
+            }
+
+            Unicode *ascii;
+            int asciiLen;
+            int *asciiIdx = nullptr;
+            unicodeToAscii7(norm, normLen, &ascii, &asciiLen, normIdx, &asciiIdx);
+            for (int i = 0; i < asciiLen; ++i) {
+                page->ascii.push_back(ascii[i]);
+                page->asciiBox.push_back(boxBase + asciiIdx[i]);
+            }
+
+            gfree(ascii);
+            gfree(asciiIdx);
+            gfree(norm);
+            gfree(normIdx);
+        }
+
+        textPage->decRefCnt();
+        page->makeUpper();
+        index->pages.push_back(std::move(page));
+    }
+
+    return index;
+}
+
+std::unique_ptr<TextIndex> TextIndex::load(const GooString *fileName)
+{
+    FILE *f = openFile(fileName->c_str(), "rb");
+    if (!f) {
+        return nullptr;
+    }
+
+    std::unique_ptr<TextIndex> index(new TextIndex());
+    char magic[4];
+    uint32_t version;
+    int32_t first, nPages;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, textIndexMagic, 4) == 0 && fread(&version, sizeof(version), 1, f) == 1 && version == textIndexVersion && fread(&first, sizeof(first), 1, f) == 1
+            && fread(&nPages, sizeof(nPages), 1, f) == 1 && first >= 1 && nPages >= 0;
+    if (ok) {
+        index->firstPage = first;
+        for (int i = 0; ok && i < nPages; ++i) {
+            auto page = std::make_unique<Page>();
+            ok = readVector(f, &page->text) && readVector(f, &page->textBox) && readVector(f, &page->ascii) && readVector(f, &page->asciiBox) && readVector(f, &page->boxes) && readVector(f, &page->boxWord);
+            ok = ok && page->boxes.size() == page->boxWord.size() && checkBoxIndices(page->text, page->textBox, page->boxes.size()) && checkBoxIndices(page->ascii, page->asciiBox, page->boxes.size());
+            page->makeUpper();
+            index->pages.push_back(std::move(page));
+        }
+    }
+    fclose(f);
+
+    if (!ok) {
+        return nullptr;
+    }
+    return index;
+}
+
+bool TextIndex::save(const GooString *fileName) const
+{
+    FILE *f = openFile(fileName->c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+
+    const int32_t first = firstPage;
+    const int32_t nPages = pages.size();
+    bool ok = fwrite(textIndexMagic, 1, 4, f) == 4 && fwrite(&textIndexVersion, sizeof(textIndexVersion), 1, f) == 1 && fwrite(&first, sizeof(first), 1, f) == 1 && fwrite(&nPages, sizeof(nPages), 1, f) == 1;
+    for (const std::unique_ptr<Page> &page : pages) {
+        if (!ok) {
+            break;
+        }
+        ok = writeVector(f, page->text) && writeVector(f, page->textBox) && writeVector(f, page->ascii) && writeVector(f, page->asciiBox) && writeVector(f, page->boxes) && writeVector(f, page->boxWord);
+    }
+
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+std::vector<TextIndexHit> TextIndex::find(const Unicode *s, int len, bool caseSensitive, bool ignoreDiacritics, bool wholeWord) const
+{
+    std::vector<TextIndexHit> hits;
+
+    // split the query into normalized terms
+    std::vector<std::vector<Unicode>> terms;
+    std::vector<bool> termIsAscii;
+    int i = 0;
+    while (i < len) {
+        while (i < len && isTermSeparator(s[i])) {
+            ++i;
+        }
+        const int start = i;
+        while (i < len && !isTermSeparator(s[i])) {
+            ++i;
+        }
+        if (i == start) {
+            break;
+        }
+
+        int normLen;
+        Unicode *norm = unicodeNormalizeNFKC(s + start, i - start, &normLen, nullptr);
+        std::vector<Unicode> term(norm, norm + normLen);
+        gfree(norm);
+
+        bool ascii = ignoreDiacritics;
+        for (Unicode &u : term) {
+            if (!caseSensitive) {
+                u = unicodeToUpper(u);
+            }
+            if (u >= 128) {
+                ascii = false;
+            }
+        }
+        terms.push_back(std::move(term));
+        termIsAscii.push_back(ascii);
+    }
+    if (terms.empty()) {
+        return hits;
+    }
+
+    std::vector<TextIndexHit> pageHits;
+    for (size_t pg = 0; pg < pages.size(); ++pg) {
+        pageHits.clear();
+        bool allFound = true;
+        for (size_t t = 0; allFound && t < terms.size(); ++t) {
+            const size_t before = pageHits.size();
+            findTerm(*pages[pg], firstPage + pg, terms[t], caseSensitive, termIsAscii[t], wholeWord, &pageHits);
+            allFound = pageHits.size() > before;
+        }
+        if (allFound) {
+            hits.insert(hits.end(), pageHits.begin(), pageHits.end());
+        }
+    }
+
+    return hits;
+}
+
+void TextIndex::findTerm(const Page &page, int pageNum, const std::vector<Unicode> &term, bool caseSensitive, bool ascii, bool wholeWord, std::vector<TextIndexHit> *hits) const
+{
+    const std::vector<Unicode> &text = caseSensitive ? (ascii ? page.ascii : page.text) : (ascii ? page.upperAscii : page.upperText);
+    const std::vector<int> &textBox = ascii ? page.asciiBox : page.textBox;
+    const size_t n = text.size();
+    const size_t m = term.size();
+    if (m == 0 || m > n) {
+        return;
+    }
+    const Unicode *txt = text.data();
+
+    for (size_t i = 0; i + m <= n; ++i) {
+        if (txt[i] != term[0] || memcmp(txt + i, term.data(), m * sizeof(Unicode)) != 0) {
+            continue;
+        }
+        if (wholeWord && ((i > 0 && unicodeTypeAlphaNum(txt[i - 1])) || (i + m < n && unicodeTypeAlphaNum(txt[i + m])))) {
+            continue;
+        }
+
+        // one rectangle per word touched by the match
+        int curWord = -1;
+        TextIndexHit hit;
+        hit.page = pageNum;
+        for (size_t k = i; k < i + m; ++k) {
+            const int b = textBox[k];
+            if (b < 0) {
+                continue;
+            }
+            const PDFRectangle &box = page.boxes[b];
+            if (page.boxWord[b] != curWord) {
+                if (curWord >= 0) {
+                    hits->push_back(hit);
+                }
+                curWord = page.boxWord[b];
+                hit.rect = box;
+            } else {
+                hit.rect.x1 = std::min(hit.rect.x1, box.x1);
+                hit.rect.y1 = std::min(hit.rect.y1, box.y1);
+                hit.rect.x2 = std::max(hit.rect.x2, box.x2);
+                hit.rect.y2 = std::max(hit.rect.y2, box.y2);
+            }
+        }
+        if (curWord >= 0) {
+            hits->push_back(hit);
+        }
+        i += m - 1;
+    }
+}
@@ -0,0 +1,85 @@
+//========================================================================
+//
+// TextIndex.h
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef TEXTINDEX_H
+#define TEXTINDEX_H
+
+#include <memory>
+#include <vector>
+
+#include "poppler-config.h"
+#include "poppler_private_export.h"
+#include "CharTypes.h"
+#include "Page.h"
+
+class GooString;
+class PDFDoc;
+
+//------------------------------------------------------------------------
+// TextIndexHit
+//------------------------------------------------------------------------
+
+struct TextIndexHit
+{
+    int page; // 1-based page number
+    PDFRectangle rect; // hit rectangle, in the same coordinates as
+                       //   TextPage::findText (72 dpi, upside down)
+};
+
+//------------------------------------------------------------------------
+// TextIndex
+//
+// A document-level text index. All pages are extracted once with
+// TextOutputDev; the index keeps, for each page, the NFKC-normalized text
+// and its ASCII (diacritic-folded) translation together with one box per
+// character, so that later searches don't need to run Gfx again.
+//------------------------------------------------------------------------
+
+class POPPLER_PRIVATE_EXPORT TextIndex
+{
+public:
+    // Extract pages <firstPage> .. <lastPage> (1-based, inclusive) of
+    // <doc>.  A negative <lastPage> means the last page of the
+    // document.  Returns nullptr if <abortCheckCbk> asked to stop.
+    static std::unique_ptr<TextIndex> build(PDFDoc *doc, int firstPage = 1, int lastPage = -1, bool (*abortCheckCbk)(void *data) = nullptr, void *abortCheckCbkData = nullptr);
+
+    // Read an index previously written with save().  Returns nullptr if
+    // the file can't be read or isn't a valid index.
+    static std::unique_ptr<TextIndex> load(const GooString *fileName);
+
+    ~TextIndex();
+
+    TextIndex(const TextIndex &) = delete;
+    TextIndex &operator=(const TextIndex &) = delete;
+
+    // Write the index to <fileName>.  Returns true on success.
+    bool save(const GooString *fileName) const;
+
+    // Search the whole index.  <s> is split on white space into terms;
+    // a page matches only if every term occurs on it, and one hit is
+    // returned for each occurrence of each term (one rectangle per
+    // word the occurrence touches), in page order.  <ignoreDiacritics>
+    // is ignored for terms that are not pure ASCII, as in
+    // TextPage::findText.
+    std::vector<TextIndexHit> find(const Unicode *s, int len, bool caseSensitive, bool ignoreDiacritics, bool wholeWord) const;
+
+    int getFirstPage() const { return firstPage; }
+    int getNumPages() const { return static_cast<int>(pages.size()); }
+
+private:
+    struct Page;
+
+    TextIndex();
+
+    void findTerm(const Page &page, int pageNum, const std::vector<Unicode> &term, bool caseSensitive, bool ascii, bool wholeWord, std::vector<TextIndexHit> *hits) const;
+
+    int firstPage;
+    std::vector<std::unique_ptr<Page>> pages;
+};
+
+#endif
@@ -59,6 +59,10 @@
 #include <cfloat>
 #include <cctype>
 #include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
 #if defined(_WIN32) || defined(__CYGWIN__)
 #    include <fcntl.h> // for O_BINARY
 #    include <io.h> // for _setmode
@@ -76,6 +80,7 @@
 #include "Page.h"
 #include "Annot.h"
 #include "UTF.h"
+#include "PDFDoc.h"
 
 //------------------------------------------------------------------------
 // parameters
@@ -399,12 +404,53 @@ int TextFontInfo::getWMode() const
     return gfxFont ? gfxFont->getWMode() : 0;
 }
 
+//------------------------------------------------------------------------
+// TextCharArena
+//------------------------------------------------------------------------
+
+// Default chunk size; larger blocks get a chunk of their own.
+#define textCharArenaChunkSize 65536
+
+TextCharArena::~TextCharArena()
+{
+    clear();
+}
+
+void *TextCharArena::alloc(size_t size)
+{
+    const size_t align = alignof(std::max_align_t);
+    size = (size + align - 1) & ~(align - 1);
+    if (chunks.empty() || size > chunkSize - chunkUsed) {
+        const size_t newChunkSize = std::max(size, (size_t)textCharArenaChunkSize);
+        void *chunk = gmalloc_checkoverflow(newChunkSize);
+        if (!chunk) {
+            return nullptr;
+        }
+        chunks.push_back(chunk);
+        chunkSize = newChunkSize;
+        chunkUsed = 0;
+    }
+    void *p = (char *)chunks.back() + chunkUsed;
+    chunkUsed += size;
+    return p;
+}
+
+void TextCharArena::clear()
+{
+    for (void *chunk : chunks) {
+        gfree(chunk);
+    }
+    chunks.clear();
+    chunkUsed = chunkSize = 0;
+}
+
 //------------------------------------------------------------------------
 // TextWord
 //------------------------------------------------------------------------
 
-TextWord::TextWord(const GfxState *state, int rotA, double fontSizeA)
+TextWord::TextWord(const GfxState *state, int rotA, double fontSizeA, TextCharArena *arenaA)
 {
+    arena = arenaA;
     rot = rotA;
     fontSize = fontSizeA;
     text = nullptr;
@@ -435,19 +481,13 @@ TextWord::TextWord(const GfxState *state, int rotA, double fontSizeA)
     link = nullptr;
 }
 
-TextWord::~TextWord()
-{
-    gfree(text);
-    gfree(charcode);
-    gfree(edge);
-    gfree(charPos);
-    gfree(font);
-    gfree(textMat);
-}
+TextWord::~TextWord() { }
 
-void TextWord::addChar(const GfxState *state, TextFontInfo *fontA, double x, double y, double dx, double dy, int charPosA, int charLen, CharCode c, Unicode u, const Matrix &textMatA)
+bool TextWord::addChar(const GfxState *state, TextFontInfo *fontA, double x, double y, double dx, double dy, int charPosA, int charLen, CharCode c, Unicode u, const Matrix &textMatA)
 {
-    ensureCapacity(len + 1);
+    if (!ensureCapacity(len + 1)) {
+        return false;
+    }
     text[len] = u;
     charcode[len] = c;
     charPos[len] = charPosA;
@@ -500,6 +540,7 @@ void TextWord::addChar(const GfxState *state, TextFontInfo *fontA, double x, dou
         }
     }
     ++len;
+    return true;
 }
 
 void TextWord::setInitialBounds(TextFontInfo *fontA, double x, double y)
@@ -591,17 +632,55 @@ void TextWord::setInitialBounds(TextFontInfo *fontA, double x, double y)
     }
 }
 
-void TextWord::ensureCapacity(int capacity)
+bool TextWord::ensureCapacity(int capacity)
 {
     if (capacity > size) {
-        size = std::max(size + 16, capacity);
-        text = (Unicode *)greallocn(text, size, sizeof(Unicode));
-        charcode = (CharCode *)greallocn(charcode, (size + 1), sizeof(CharCode));
-        edge = (double *)greallocn(edge, (size + 1), sizeof(double));
-        charPos = (int *)greallocn(charPos, size + 1, sizeof(int));
-        font = (TextFontInfo **)greallocn(font, size, sizeof(TextFontInfo *));
-        textMat = (Matrix *)greallocn(textMat, size, sizeof(Matrix));
-    }
+        // the old block isn't released until the page is freed, so grow
+        // geometrically to keep the total used by a word linear in its
+        // length; less than 128 bytes are needed per character
+        const int newSize = std::max(std::min(std::max(size * 2, size + 16), INT_MAX / 128 - 1), capacity);
+        if (newSize >= INT_MAX / 128) {
+            error(errInternal, -1, "Too many characters in a word");
+            return false;
+        }
+
+        // all the arrays share a single block from the page's arena,
+        // ordered by decreasing alignment
+        const size_t n = newSize;
+        char *p = (char *)arena->alloc(n * sizeof(Matrix) + (n + 1) * sizeof(double) + n * sizeof(TextFontInfo *) + (n + 1) * sizeof(int) + (n + 1) * sizeof(CharCode) + n * sizeof(Unicode));
+        if (!p) {
+            error(errInternal, -1, "Out of memory for the characters of a word");
+            return false;
+        }
+        Matrix *textMatA = (Matrix *)p;
+        p += n * sizeof(Matrix);
+        double *edgeA = (double *)p;
+        p += (n + 1) * sizeof(double);
+        TextFontInfo **fontA = (TextFontInfo **)p;
+        p += n * sizeof(TextFontInfo *);
+        int *charPosA = (int *)p;
+        p += (n + 1) * sizeof(int);
+        CharCode *charcodeA = (CharCode *)p;
+        p += (n + 1) * sizeof(CharCode);
+        Unicode *textA = (Unicode *)p;
+
+        if (size > 0) {
+            std::copy(textMat, textMat + len, textMatA);
+            std::copy(edge, edge + len + 1, edgeA);
+            std::copy(font, font + len, fontA);
+            std::copy(charPos, charPos + len + 1, charPosA);
+            std::copy(charcode, charcode + len, charcodeA);
+            std::copy(text, text + len, textA);
+        }
+        textMat = textMatA;
+        edge = edgeA;
+        font = fontA;
+        charPos = charPosA;
+        charcode = charcodeA;
+        text = textA;
+        size = newSize;
+    }
+    return true;
 }
 
 struct CombiningTable
@@ -666,7 +745,9 @@ bool TextWord::addCombining(const GfxState *state, TextFontInfo *fontA, double f
 
         // Add character, but don't adjust edge / bounding box because
         // combining character's positioning could be odd.
-        ensureCapacity(len + 1);
+        if (!ensureCapacity(len + 1)) {
+            return false;
+        }
         text[len] = cCurrent;
         charcode[len] = c;
         charPos[len] = charPosA;
@@ -699,7 +780,9 @@ bool TextWord::addCombining(const GfxState *state, TextFontInfo *fontA, double f
             return false;
 
         // move combining character to after base character
-        ensureCapacity(len + 1);
+        if (!ensureCapacity(len + 1)) {
+            return false;
+        }
         fontSize = fontSizeA;
         text[len] = cPrev;
         charcode[len] = charcode[len - 1];
@@ -765,10 +848,13 @@ bool TextWord::addCombining(const GfxState *state, TextFontInfo *fontA, double f
     return false;
 }
 
-void TextWord::merge(TextWord *word)
+bool TextWord::merge(TextWord *word)
 {
     int i;
 
+    if (!ensureCapacity(len + word->len)) {
+        return false;
+    }
     if (word->xMin < xMin) {
         xMin = word->xMin;
     }
@@ -781,7 +867,6 @@ void TextWord::merge(TextWord *word)
     if (word->yMax > yMax) {
         yMax = word->yMax;
     }
-    ensureCapacity(len + word->len);
     for (i = 0; i < word->len; ++i) {
         text[len + i] = word->text[i];
         charcode[len + i] = word->charcode[i];
@@ -793,6 +878,7 @@ void TextWord::merge(TextWord *word)
     edge[len + word->len] = word->edge[word->len];
     charPos[len + word->len] = word->charPos[word->len];
     len += word->len;
+    return true;
 }
 
 inline int TextWord::primaryCmp(const TextWord *word) const
@@ -1015,6 +1101,147 @@ void TextPool::addWord(TextWord *word)
     cursorBaseIdx = wordBaseIdx;
 }
 
+//------------------------------------------------------------------------
+// TextWordGrid
+//------------------------------------------------------------------------
+
+TextWordGrid::TextWordGrid(TextPool *poolA, int rotA)
+{
+    rot = rotA;
+    minBaseIdx = poolA->minBaseIdx;
+    if (poolA->minBaseIdx > poolA->maxBaseIdx) {
+        return;
+    }
+    lines.resize(poolA->maxBaseIdx - poolA->minBaseIdx + 1);
+
+    // the pool lists are already sorted along the primary axis; the
+    // keys are negated for rot = 2 and 3 so that they increase too
+    for (int baseIdx = poolA->minBaseIdx; baseIdx <= poolA->maxBaseIdx; ++baseIdx) {
+        Line &line = lines[baseIdx - minBaseIdx];
+        for (TextWord *word = poolA->getPool(baseIdx); word; word = word->next) {
+            double key, length;
+            switch (rot) {
+            case 0:
+            default:
+                key = word->xMin;
+                length = word->xMax - word->xMin;
+                break;
+            case 1:
+                key = word->yMin;
+                length = word->yMax - word->yMin;
+                break;
+            case 2:
+                key = -word->xMax;
+                length = word->xMax - word->xMin;
+                break;
+            case 3:
+                key = -word->yMax;
+                length = word->yMax - word->yMin;
+                break;
+            }
+            line.words.push_back(word);
+            line.keys.push_back(key);
+            line.maxLength = std::max(line.maxLength, length);
+        }
+        poolA->setPool(baseIdx, nullptr);
+    }
+    poolA->cursor = nullptr;
+}
+
+TextWordGrid::~TextWordGrid()
+{
+    for (const Line &line : lines) {
+        for (TextWord *word : line.words) {
+            delete word;
+        }
+    }
+}
+
+TextWord *TextWordGrid::getFirst(int baseIdx)
+{
+    if (baseIdx < minBaseIdx || baseIdx - minBaseIdx >= (int)lines.size()) {
+        return nullptr;
+    }
+    Line &line = lines[baseIdx - minBaseIdx];
+    while (line.first < line.words.size() && !line.words[line.first]) {
+        ++line.first;
+    }
+    return line.first < line.words.size() ? line.words[line.first] : nullptr;
+}
+
+TextWord *TextWordGrid::takeFirst(int baseIdx)
+{
+    if (!getFirst(baseIdx)) {
+        return nullptr;
+    }
+    return take(baseIdx, lines[baseIdx - minBaseIdx].first);
+}
+
+int TextWordGrid::findStart(int baseIdx, const TextBlock *blk, double margin) const
+{
+    if (baseIdx < minBaseIdx || baseIdx - minBaseIdx >= (int)lines.size()) {
+        return 0;
+    }
+    const Line &line = lines[baseIdx - minBaseIdx];
+    double lo;
+    switch (rot) {
+    case 0:
+    default:
+        lo = blk->xMin - margin;
+        break;
+    case 1:
+        lo = blk->yMin - margin;
+        break;
+    case 2:
+        lo = -(blk->xMax + margin);
+        break;
+    case 3:
+        lo = -(blk->yMax + margin);
+        break;
+    }
+    // a word can only reach <lo> if it starts less than maxLength
+    // before it (plus some slack for rounding)
+    lo -= line.maxLength + 1;
+    const auto start = std::lower_bound(line.keys.begin() + line.first, line.keys.end(), lo);
+    return (int)(start - line.keys.begin());
+}
+
+bool TextWordGrid::inRange(int baseIdx, int i, const TextBlock *blk, double margin) const
+{
+    if (baseIdx < minBaseIdx || baseIdx - minBaseIdx >= (int)lines.size()) {
+        return false;
+    }
+    const Line &line = lines[baseIdx - minBaseIdx];
+    if (i >= (int)line.keys.size()) {
+        return false;
+    }
+    double hi;
+    switch (rot) {
+    case 0:
+    default:
+        hi = blk->xMax + margin;
+        break;
+    case 1:
+        hi = blk->yMax + margin;
+        break;
+    case 2:
+        hi = -(blk->xMin - margin);
+        break;
+    case 3:
+        hi = -(blk->yMin - margin);
+        break;
+    }
+    return line.keys[i] <= hi;
+}
+
+TextWord *TextWordGrid::take(int baseIdx, int i)
+{
+    TextWord *word = lines[baseIdx - minBaseIdx].words[i];
+    lines[baseIdx - minBaseIdx].words[i] = nullptr;
+    word->next = nullptr;
+    return word;
+}
+
 //------------------------------------------------------------------------
 // TextLine
 //------------------------------------------------------------------------
@@ -1211,8 +1438,7 @@ void TextLine::coalesce(const UnicodeMap *uMap)
                 word0 = word1;
                 word1 = word1->next;
             } else if (word0->font[word0->len - 1] == word1->font[0] && word0->underlined == word1->underlined && fabs(word0->fontSize - word1->fontSize) < maxWordFontSizeDelta * words->fontSize
-                       && word1->charPos[0] == word0->charPos[word0->len]) {
-                word0->merge(word1);
+                       && word1->charPos[0] == word0->charPos[word0->len] && word0->merge(word1)) {
                 word0->next = word1->next;
                 delete word1;
                 word1 = word0->next;
@@ -2491,6 +2717,7 @@ void TextPage::clear()
         }
         gfree(blocks);
     }
+    charArena.clear();
     fonts.clear();
     underlines.clear();
     links.clear();
@@ -2617,7 +2844,7 @@ void TextPage::beginWord(const GfxState *state)
         rot = (rot + 1) & 3;
     }
 
-    curWord = new TextWord(state, rot, curFontSize);
+    curWord = new TextWord(state, rot, curFontSize, &charArena);
 }
 
 void TextPage::addChar(const GfxState *state, double x, double y, double dx, double dy, CharCode c, int nBytes, const Unicode *u, int uLen)
@@ -2821,18 +3048,18 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML)
 
 void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double minColSpacing1)
 {
-    TextWord *word0, *word1, *word2;
+    TextWord *word0, *word1;
     TextLine *line;
     TextBlock *blkList, *blk, *lastBlk, *blk0, *blk1, *blk2;
     TextFlow *flow, *lastFlow;
     int rot, poolMinBaseIdx, baseIdx, startBaseIdx, endBaseIdx;
     double minBase, maxBase, newMinBase, newMaxBase;
-    double fontSize, colSpace1, colSpace2, lineSpace, intraLineSpace, blkSpace;
+    double fontSize, colSpace1, colSpace2, lineSpace, intraLineSpace, gridMargin, blkSpace;
     bool found;
     int count[4];
     int lrCount;
     int col1, col2;
-    int j, n;
+    int wordIdx, j, n;
 
     if (rawOrder) {
         primaryRot = 0;
@@ -2997,6 +3224,7 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
     // build blocks for each rotation value
     for (rot = 0; rot < 4; ++rot) {
         std::unique_ptr<TextPool> &pool = pools[rot];
+        TextWordGrid grid(pool.get(), rot);
         poolMinBaseIdx = pool->minBaseIdx;
         count[rot] = 0;
 
@@ -3004,7 +3232,7 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
         while (true) {
 
             // find the first non-empty line in the pool
-            for (; poolMinBaseIdx <= pool->maxBaseIdx && !pool->getPool(poolMinBaseIdx); ++poolMinBaseIdx)
+            for (; poolMinBaseIdx <= pool->maxBaseIdx && !grid.getFirst(poolMinBaseIdx); ++poolMinBaseIdx)
                 ;
             if (poolMinBaseIdx > pool->maxBaseIdx) {
                 break;
@@ -3014,18 +3242,16 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
             // pool -- this avoids starting with a superscript word
             startBaseIdx = poolMinBaseIdx;
             for (baseIdx = poolMinBaseIdx + 1; baseIdx < poolMinBaseIdx + 4 && baseIdx <= pool->maxBaseIdx; ++baseIdx) {
-                if (!pool->getPool(baseIdx)) {
+                if (!grid.getFirst(baseIdx)) {
                     continue;
                 }
-                if (pool->getPool(baseIdx)->primaryCmp(pool->getPool(startBaseIdx)) < 0) {
+                if (grid.getFirst(baseIdx)->primaryCmp(grid.getFirst(startBaseIdx)) < 0) {
                     startBaseIdx = baseIdx;
                 }
             }
 
             // create a new block
-            word0 = pool->getPool(startBaseIdx);
-            pool->setPool(startBaseIdx, word0->next);
-            word0->next = nullptr;
+            word0 = grid.takeFirst(startBaseIdx);
             blk = new TextBlock(this, rot);
             blk->addWord(word0);
 
@@ -3036,6 +3262,10 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
             lineSpace = maxLineSpacingDelta * fontSize;
             intraLineSpace = maxIntraLineDelta * fontSize;
 
+            // only words within this distance of the block, along the
+            // primary axis, can be added to it
+            gridMargin = std::max(0.0, std::max(colSpace1, colSpace2));
+
             // add words to the block
             do {
                 found = false;
@@ -3044,25 +3274,13 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
                 // the block
                 newMinBase = minBase;
                 for (baseIdx = pool->getBaseIdx(minBase); baseIdx >= pool->getBaseIdx(minBase - lineSpace); --baseIdx) {
-                    word0 = nullptr;
-                    word1 = pool->getPool(baseIdx);
-                    while (word1) {
-                        if (word1->base < minBase && word1->base >= minBase - lineSpace && ((rot == 0 || rot == 2) ? (word1->xMin < blk->xMax && word1->xMax > blk->xMin) : (word1->yMin < blk->yMax && word1->yMax > blk->yMin))
-                            && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta1 * fontSize) {
-                            word2 = word1;
-                            if (word0) {
-                                word0->next = word1->next;
-                            } else {
-                                pool->setPool(baseIdx, word1->next);
-                            }
-                            word1 = word1->next;
-                            word2->next = nullptr;
-                            blk->addWord(word2);
+                    for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                        word1 = grid.get(baseIdx, wordIdx);
+                        if (word1 && word1->base < minBase && word1->base >= minBase - lineSpace
+                            && ((rot == 0 || rot == 2) ? (word1->xMin < blk->xMax && word1->xMax > blk->xMin) : (word1->yMin < blk->yMax && word1->yMax > blk->yMin)) && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta1 * fontSize) {
+                            blk->addWord(grid.take(baseIdx, wordIdx));
                             found = true;
-                            newMinBase = word2->base;
-                        } else {
-                            word0 = word1;
-                            word1 = word1->next;
+                            newMinBase = word1->base;
                         }
                     }
                 }
@@ -3072,25 +3290,13 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
                 // the block
                 newMaxBase = maxBase;
                 for (baseIdx = pool->getBaseIdx(maxBase); baseIdx <= pool->getBaseIdx(maxBase + lineSpace); ++baseIdx) {
-                    word0 = nullptr;
-                    word1 = pool->getPool(baseIdx);
-                    while (word1) {
-                        if (word1->base > maxBase && word1->base <= maxBase + lineSpace && ((rot == 0 || rot == 2) ? (word1->xMin < blk->xMax && word1->xMax > blk->xMin) : (word1->yMin < blk->yMax && word1->yMax > blk->yMin))
-                            && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta1 * fontSize) {
-                            word2 = word1;
-                            if (word0) {
-                                word0->next = word1->next;
-                            } else {
-                                pool->setPool(baseIdx, word1->next);
-                            }
-                            word1 = word1->next;
-                            word2->next = nullptr;
-                            blk->addWord(word2);
+                    for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                        word1 = grid.get(baseIdx, wordIdx);
+                        if (word1 && word1->base > maxBase && word1->base <= maxBase + lineSpace
+                            && ((rot == 0 || rot == 2) ? (word1->xMin < blk->xMax && word1->xMax > blk->xMin) : (word1->yMin < blk->yMax && word1->yMax > blk->yMin)) && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta1 * fontSize) {
+                            blk->addWord(grid.take(baseIdx, wordIdx));
                             found = true;
-                            newMaxBase = word2->base;
-                        } else {
-                            word0 = word1;
-                            word1 = word1->next;
+                            newMaxBase = word1->base;
                         }
                     }
                 }
@@ -3099,25 +3305,13 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
                 // look for words that are on lines already in the block, and
                 // that overlap the block horizontally
                 for (baseIdx = pool->getBaseIdx(minBase - intraLineSpace); baseIdx <= pool->getBaseIdx(maxBase + intraLineSpace); ++baseIdx) {
-                    word0 = nullptr;
-                    word1 = pool->getPool(baseIdx);
-                    while (word1) {
-                        if (word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
+                    for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                        word1 = grid.get(baseIdx, wordIdx);
+                        if (word1 && word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
                             && ((rot == 0 || rot == 2) ? (word1->xMin < blk->xMax + colSpace1 && word1->xMax > blk->xMin - colSpace1) : (word1->yMin < blk->yMax + colSpace1 && word1->yMax > blk->yMin - colSpace1))
                             && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta2 * fontSize) {
-                            word2 = word1;
-                            if (word0) {
-                                word0->next = word1->next;
-                            } else {
-                                pool->setPool(baseIdx, word1->next);
-                            }
-                            word1 = word1->next;
-                            word2->next = nullptr;
-                            blk->addWord(word2);
+                            blk->addWord(grid.take(baseIdx, wordIdx));
                             found = true;
-                        } else {
-                            word0 = word1;
-                            word1 = word1->next;
                         }
                     }
                 }
@@ -3133,44 +3327,31 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
                 // three or fewer, add them to the block
                 n = 0;
                 for (baseIdx = pool->getBaseIdx(minBase - intraLineSpace); baseIdx <= pool->getBaseIdx(maxBase + intraLineSpace); ++baseIdx) {
-                    word1 = pool->getPool(baseIdx);
-                    while (word1) {
-                        if (word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
+                    for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                        word1 = grid.get(baseIdx, wordIdx);
+                        if (word1 && word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
                             && ((rot == 0 || rot == 2) ? (word1->xMax <= blk->xMin && word1->xMax > blk->xMin - colSpace2) : (word1->yMax <= blk->yMin && word1->yMax > blk->yMin - colSpace2))
                             && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta3 * fontSize) {
                             ++n;
                             break;
                         }
-                        word1 = word1->next;
                     }
                 }
                 if (n > 0 && n <= 3) {
                     for (baseIdx = pool->getBaseIdx(minBase - intraLineSpace); baseIdx <= pool->getBaseIdx(maxBase + intraLineSpace); ++baseIdx) {
-                        word0 = nullptr;
-                        word1 = pool->getPool(baseIdx);
-                        while (word1) {
-                            if (word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
+                        for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                            word1 = grid.get(baseIdx, wordIdx);
+                            if (word1 && word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
                                 && ((rot == 0 || rot == 2) ? (word1->xMax <= blk->xMin && word1->xMax > blk->xMin - colSpace2) : (word1->yMax <= blk->yMin && word1->yMax > blk->yMin - colSpace2))
                                 && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta3 * fontSize) {
-                                word2 = word1;
-                                if (word0) {
-                                    word0->next = word1->next;
-                                } else {
-                                    pool->setPool(baseIdx, word1->next);
-                                }
-                                word1 = word1->next;
-                                word2->next = nullptr;
-                                blk->addWord(word2);
-                                if (word2->base < minBase) {
-                                    minBase = word2->base;
-                                } else if (word2->base > maxBase) {
-                                    maxBase = word2->base;
+                                blk->addWord(grid.take(baseIdx, wordIdx));
+                                if (word1->base < minBase) {
+                                    minBase = word1->base;
+                                } else if (word1->base > maxBase) {
+                                    maxBase = word1->base;
                                 }
                                 found = true;
                                 break;
-                            } else {
-                                word0 = word1;
-                                word1 = word1->next;
                             }
                         }
                     }
@@ -3181,44 +3362,31 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
                 // three or fewer, add them to the block
                 n = 0;
                 for (baseIdx = pool->getBaseIdx(minBase - intraLineSpace); baseIdx <= pool->getBaseIdx(maxBase + intraLineSpace); ++baseIdx) {
-                    word1 = pool->getPool(baseIdx);
-                    while (word1) {
-                        if (word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
+                    for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                        word1 = grid.get(baseIdx, wordIdx);
+                        if (word1 && word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
                             && ((rot == 0 || rot == 2) ? (word1->xMin >= blk->xMax && word1->xMin < blk->xMax + colSpace2) : (word1->yMin >= blk->yMax && word1->yMin < blk->yMax + colSpace2))
                             && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta3 * fontSize) {
                             ++n;
                             break;
                         }
-                        word1 = word1->next;
                     }
                 }
                 if (n > 0 && n <= 3) {
                     for (baseIdx = pool->getBaseIdx(minBase - intraLineSpace); baseIdx <= pool->getBaseIdx(maxBase + intraLineSpace); ++baseIdx) {
-                        word0 = nullptr;
-                        word1 = pool->getPool(baseIdx);
-                        while (word1) {
-                            if (word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
+                        for (wordIdx = grid.findStart(baseIdx, blk, gridMargin); grid.inRange(baseIdx, wordIdx, blk, gridMargin); ++wordIdx) {
+                            word1 = grid.get(baseIdx, wordIdx);
+                            if (word1 && word1->base >= minBase - intraLineSpace && word1->base <= maxBase + intraLineSpace
                                 && ((rot == 0 || rot == 2) ? (word1->xMin >= blk->xMax && word1->xMin < blk->xMax + colSpace2) : (word1->yMin >= blk->yMax && word1->yMin < blk->yMax + colSpace2))
                                 && fabs(word1->fontSize - fontSize) < maxBlockFontSizeDelta3 * fontSize) {
-                                word2 = word1;
-                                if (word0) {
-                                    word0->next = word1->next;
-                                } else {
-                                    pool->setPool(baseIdx, word1->next);
-                                }
-                                word1 = word1->next;
-                                word2->next = nullptr;
-                                blk->addWord(word2);
-                                if (word2->base < minBase) {
-                                    minBase = word2->base;
-                                } else if (word2->base > maxBase) {
-                                    maxBase = word2->base;
+                                blk->addWord(grid.take(baseIdx, wordIdx));
+                                if (word1->base < minBase) {
+                                    minBase = word1->base;
+                                } else if (word1->base > maxBase) {
+                                    maxBase = word1->base;
                                 }
                                 found = true;
                                 break;
-                            } else {
-                                word0 = word1;
-                                word1 = word1->next;
                             }
                         }
                     }
@@ -3458,6 +3626,18 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
     double deltaX, deltaY;
     TextBlock *fblk2 = nullptr, *fblk3 = nullptr, *fblk4 = nullptr;
 
+    // the neighbour search below only needs the block boxes: copy them
+    // (in list order) to an array, so that the inner loop doesn't have
+    // to walk the block list -- this matters on pages with many blocks
+    std::vector<TextBlock *> blkArray;
+    std::vector<PDFRectangle> blkBoxes;
+    blkArray.reserve(nBlocks);
+    blkBoxes.reserve(nBlocks);
+    for (blk1 = blkList; blk1; blk1 = blk1->next) {
+        blkArray.push_back(blk1);
+        blkBoxes.emplace_back(blk1->xMin, blk1->yMin, blk1->xMax, blk1->yMax);
+    }
+
     for (blk1 = blkList; blk1; blk1 = blk1->next) {
         blk1->ExMin = blk1->xMin;
         blk1->ExMax = blk1->xMax;
@@ -3479,18 +3659,19 @@ void TextPage::coalesce(bool physLayout, double fixedPitch, bool doHTML, double
          *  fblk4 is under blk1 and on the right of blk1
          *  and they are closest to blk1
          */
-        for (blk2 = blkList; blk2; blk2 = blk2->next) {
-            if (blk2 != blk1) {
-                if (blk2->yMin <= blk1->yMax && blk2->yMax >= blk1->yMin && blk2->xMin > blk1->xMax && blk2->xMin < bxMin0) {
-                    bxMin0 = blk2->xMin;
-                    fblk2 = blk2;
-                } else if (blk2->xMin <= blk1->xMax && blk2->xMax >= blk1->xMin && blk2->yMin > blk1->yMax && blk2->yMin < byMin0) {
-                    byMin0 = blk2->yMin;
-                    fblk3 = blk2;
-                } else if (blk2->xMin > blk1->xMax && blk2->xMin < bxMin1 && blk2->yMin > blk1->yMax && blk2->yMin < byMin1) {
-                    bxMin1 = blk2->xMin;
-                    byMin1 = blk2->yMin;
-                    fblk4 = blk2;
+        for (size_t k = 0; k < blkArray.size(); ++k) {
+            const PDFRectangle &box2 = blkBoxes[k];
+            if (blkArray[k] != blk1) {
+                if (box2.y1 <= blk1->yMax && box2.y2 >= blk1->yMin && box2.x1 > blk1->xMax && box2.x1 < bxMin0) {
+                    bxMin0 = box2.x1;
+                    fblk2 = blkArray[k];
+                } else if (box2.x1 <= blk1->xMax && box2.x2 >= blk1->xMin && box2.y1 > blk1->yMax && box2.y1 < byMin0) {
+                    byMin0 = box2.y1;
+                    fblk3 = blkArray[k];
+                } else if (box2.x1 > blk1->xMax && box2.x1 < bxMin1 && box2.y1 > blk1->yMax && box2.y1 < byMin1) {
+                    bxMin1 = box2.x1;
+                    byMin1 = box2.y1;
+                    fblk4 = blkArray[k];
                 }
             }
         }
@@ -5910,6 +6091,10 @@ TextPage *TextOutputDev::takeText()
 
     ret = text;
     text = new TextPage(rawOrder, discardDiag);
+    // ActualText keeps its own reference to the page it feeds, so it
+    // has to follow the new page for this device to be reusable
+    delete actualText;
+    actualText = new ActualText(text);
     return ret;
 }
 
@@ -5917,3 +6102,83 @@ const TextFlow *TextOutputDev::getFlows() const
 {
     return text->getFlows();
 }
+
+//------------------------------------------------------------------------
+// extractTextPages
+//------------------------------------------------------------------------
+
+void extractTextPages(PDFDoc *doc, int firstPage, int lastPage, int nThreads, double hDPI, double vDPI, bool useMediaBox, bool crop, int sliceX, int sliceY, int sliceW, int sliceH,
+                      const std::function<std::unique_ptr<TextOutputDev>()> &makeOutputDev, const std::function<void(int pageNum, TextPage *text)> &pageDone)
+{
+    if (lastPage < firstPage) {
+        return;
+    }
+    if (nThreads < 1) {
+        nThreads = 1;
+    }
+    if (nThreads > lastPage - firstPage + 1) {
+        nThreads = lastPage - firstPage + 1;
+    }
+    const int window = 2 * nThreads;
+
+    std::mutex mutex;
+    std::condition_variable pageReady; // signalled by the workers
+    std::condition_variable pageTaken; // signalled by the calling thread
+    std::map<int, TextPage *> finished; // reordering buffer
+    int nextPage = firstPage; // next page to hand out to a worker
+    int nextDone = firstPage; // next page to pass to pageDone
+
+    auto worker = [&] {
+        std::unique_ptr<TextOutputDev> textOut = makeOutputDev();
+        while (true) {
+            int pg;
+            {
+                std::unique_lock<std::mutex> locker(mutex);
+                pageTaken.wait(locker, [&] { return nextPage > lastPage || nextPage < nextDone + window; });
+                if (nextPage > lastPage) {
+                    return;
+                }
+                pg = nextPage++;
+            }
+
+            TextPage *text = nullptr;
+            if (textOut && textOut->isOk()) {
+                doc->displayPageSlice(textOut.get(), pg, hDPI, vDPI, 0, useMediaBox, crop, false, sliceX, sliceY, sliceW, sliceH, nullptr, nullptr, nullptr, nullptr, true);
+                text = textOut->takeText();
+            }
+
+            std::unique_lock<std::mutex> locker(mutex);
+            finished[pg] = text;
+            pageReady.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads);
+    for (int i = 0; i < nThreads; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    while (nextDone <= lastPage) {
+        TextPage *text;
+        {
+            std::unique_lock<std::mutex> locker(mutex);
+            pageReady.wait(locker, [&] { return finished.count(nextDone) > 0; });
+            auto it = finished.find(nextDone);
+            text = it->second;
+            finished.erase(it);
+        }
+        if (text) {
+            pageDone(nextDone, text);
+        }
+        {
+            std::unique_lock<std::mutex> locker(mutex);
+            ++nextDone;
+        }
+        pageTaken.notify_all();
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
@@ -39,6 +39,9 @@
 #include "poppler-config.h"
 #include "poppler_private_export.h"
 #include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "GfxFont.h"
 #include "GfxState.h"
 #include "OutputDev.h"
@@ -130,6 +133,35 @@ private:
     friend class TextSelectionPainter;
 };
 
+//------------------------------------------------------------------------
+// TextCharArena
+//------------------------------------------------------------------------
+
+// Storage for the per-character arrays of all the TextWords on a page.
+// Blocks are carved sequentially out of large chunks, and are only
+// released, all at once, by clear().
+class TextCharArena
+{
+public:
+    TextCharArena() = default;
+    ~TextCharArena();
+
+    TextCharArena(const TextCharArena &) = delete;
+    TextCharArena &operator=(const TextCharArena &) = delete;
+
+    // Return a block of <size> bytes, suitably aligned for doubles and
+    // pointers, or nullptr if it can't be allocated.
+    void *alloc(size_t size);
+
+    // Free all the blocks.
+    void clear();
+
+private:
+    std::vector<void *> chunks;
+    size_t chunkUsed = 0; // bytes used in the last chunk
+    size_t chunkSize = 0; // size of the last chunk
+};
+
 //------------------------------------------------------------------------
 // TextWord
 //------------------------------------------------------------------------
@@ -138,7 +170,9 @@ class POPPLER_PRIVATE_EXPORT TextWord
 {
 public:
     // Constructor.
-    TextWord(const GfxState *state, int rotA, double fontSize);
+    // The per-character arrays are allocated from <arenaA>, which
+    // must outlive the word.
+    TextWord(const GfxState *state, int rotA, double fontSize, TextCharArena *arenaA);
 
     // Destructor.
     ~TextWord();
@@ -146,8 +180,9 @@ public:
     TextWord(const TextWord &) = delete;
     TextWord &operator=(const TextWord &) = delete;
 
-    // Add a character to the word.
-    void addChar(const GfxState *state, TextFontInfo *fontA, double x, double y, double dx, double dy, int charPosA, int charLen, CharCode c, Unicode u, const Matrix &textMatA);
+    // Add a character to the word.  Returns false, leaving the word
+    // unchanged, if there is no memory left for the character.
+    bool addChar(const GfxState *state, TextFontInfo *fontA, double x, double y, double dx, double dy, int charPosA, int charLen, CharCode c, Unicode u, const Matrix &textMatA);
 
     // Attempt to add a character to the word as a combining character.
     // Either character u or the last character in the word must be an
@@ -155,8 +190,9 @@ public:
     // the character was added.
     bool addCombining(const GfxState *state, TextFontInfo *fontA, double fontSizeA, double x, double y, double dx, double dy, int charPosA, int charLen, CharCode c, Unicode u, const Matrix &textMatA);
 
-    // Merge <word> onto the end of <this>.
-    void merge(TextWord *word);
+    // Merge <word> onto the end of <this>.  Returns false, leaving both
+    // words unchanged, if there is no memory left for the characters.
+    bool merge(TextWord *word);
 
     // Compares <this> to <word>, returning -1 (<), 0 (=), or +1 (>),
     // based on a primary-axis comparison, e.g., x ordering if rot=0.
@@ -209,7 +245,7 @@ public:
     const TextWord *nextWord() const { return next; };
 
 private:
-    void ensureCapacity(int capacity);
+    bool ensureCapacity(int capacity);
     void setInitialBounds(TextFontInfo *fontA, double x, double y);
 
     int rot; // rotation, multiple of 90 degrees
@@ -229,6 +265,7 @@ private:
     int size; // size of text/edge/charPos/font arrays
     TextFontInfo **font; // font information for each char
     Matrix *textMat; // transformation matrix for each char
+    TextCharArena *arena; // where the per-char arrays live
     double fontSize; // font size
     bool spaceAfter; // set if there is a space between this
                      //   word and the next word on the line
@@ -248,6 +285,7 @@ private:
     friend class TextBlock;
     friend class TextFlow;
     friend class TextWordList;
+    friend class TextWordGrid;
     friend class TextPage;
 
     friend class TextSelectionPainter;
@@ -284,6 +322,65 @@ private:
 
     friend class TextBlock;
     friend class TextPage;
+    friend class TextWordGrid;
+};
+
+//------------------------------------------------------------------------
+// TextWordGrid
+//------------------------------------------------------------------------
+
+// Spatial index used while building blocks.  The words of a TextPool
+// are moved into one array per baseline bucket, sorted along the
+// primary axis, so that the words close to a block can be found by
+// binary search instead of walking the whole line.  Words taken out
+// of the grid are replaced by nullptr.
+class TextWordGrid
+{
+public:
+    // Take all the words out of <poolA>.
+    TextWordGrid(TextPool *poolA, int rotA);
+    ~TextWordGrid();
+
+    TextWordGrid(const TextWordGrid &) = delete;
+    TextWordGrid &operator=(const TextWordGrid &) = delete;
+
+    // Return the first remaining word in bucket <baseIdx>, or nullptr
+    // if the bucket is empty.
+    TextWord *getFirst(int baseIdx);
+
+    // Remove and return the first remaining word in bucket <baseIdx>.
+    TextWord *takeFirst(int baseIdx);
+
+    // Return the index of the first word in bucket <baseIdx> that may
+    // overlap <blk> along the primary axis, once the block is
+    // extended by <margin> on both sides.
+    int findStart(int baseIdx, const TextBlock *blk, double margin) const;
+
+    // Return false if index <i> of bucket <baseIdx> is past the last
+    // word that may overlap <blk> extended by <margin>.  Words are
+    // never reordered, so this can be checked against a block that
+    // grew during the scan.
+    bool inRange(int baseIdx, int i, const TextBlock *blk, double margin) const;
+
+    // Return the word at index <i> of bucket <baseIdx>, or nullptr if
+    // it was already taken.
+    TextWord *get(int baseIdx, int i) const { return lines[baseIdx - minBaseIdx].words[i]; }
+
+    // Remove and return the word at index <i> of bucket <baseIdx>.
+    TextWord *take(int baseIdx, int i);
+
+private:
+    struct Line
+    {
+        std::vector<TextWord *> words;
+        std::vector<double> keys; // start of each word along the primary axis
+        double maxLength = 0; // longest word along the primary axis
+        size_t first = 0; // index of the first word not yet taken
+    };
+
+    int rot;
+    int minBaseIdx;
+    std::vector<Line> lines;
 };
 
 struct TextFlowData;
@@ -452,6 +549,7 @@ private:
     friend class TextLineFrag;
     friend class TextFlow;
     friend class TextWordList;
+    friend class TextWordGrid;
     friend class TextPage;
     friend class TextSelectionPainter;
     friend class TextSelectionDumper;
@@ -690,6 +788,7 @@ private:
                           //   previous char
     bool diagonal; // whether the current text is diagonal
 
+    TextCharArena charArena; // per-char arrays of all the words
     std::unique_ptr<TextPool> pools[4]; // a "pool" of TextWords for each rotation
     TextFlow *flows; // linked list of flows
     TextBlock **blocks; // array of blocks, in yx order
@@ -796,6 +895,10 @@ public:
     // Does this device need non-text content?
     bool needNonText() override { return false; }
 
+    // Paths are only used to find underlines and link borders in HTML
+    // mode.
+    bool needPaths() override { return doHTML; }
+
     // Does this device require incCharCount to be called for text on
     // non-shown layers?
     bool needCharCount() override { return true; }
@@ -915,4 +1018,22 @@ private:
     ActualText *actualText;
 };
 
+//------------------------------------------------------------------------
+// extractTextPages
+//------------------------------------------------------------------------
+
+class PDFDoc;
+
+// Extract the text of pages <firstPage> .. <lastPage> of <doc> on up to
+// <nThreads> worker threads which share <doc>.  Each worker runs its
+// own Gfx (on a private copy of the XRef) and its own TextOutputDev,
+// created by <makeOutputDev> on the worker thread; the device should
+// not have an output stream.  <pageDone> is called on the calling
+// thread for every page, in page order, with a reference to the page's
+// TextPage that it must release with decRefCnt().  Pages finished out
+// of order are held back until their turn; workers never run more than
+// 2 * <nThreads> pages ahead of <pageDone>.
+void POPPLER_PRIVATE_EXPORT extractTextPages(PDFDoc *doc, int firstPage, int lastPage, int nThreads, double hDPI, double vDPI, bool useMediaBox, bool crop, int sliceX, int sliceY, int sliceW, int sliceH,
+                                             const std::function<std::unique_ptr<TextOutputDev>()> &makeOutputDev, const std::function<void(int pageNum, TextPage *text)> &pageDone);
+
 #endif
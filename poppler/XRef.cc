@@ -49,6 +49,11 @@
 #include <climits>
 #include <cfloat>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
 #include "goo/gfile.h"
 #include "goo/gmem.h"
 #include "Object.h"
@@ -58,6 +63,7 @@
 #include "Dict.h"
 #include "Error.h"
 #include "ErrorCodes.h"
+#include "JBIG2Stream.h"
 #include "XRef.h"
 
 //------------------------------------------------------------------------
@@ -232,6 +238,9 @@ Object ObjectStream::getObject(int objIdx, int objNum)
 
 #define xrefLocker() std::unique_lock<std::recursive_mutex> locker(mutex)
 
+// memory used by the decoded JBIG2 globals of a document
+#define jbig2GlobalsCacheSize (64 * 1024 * 1024)
+
 XRef::XRef() : objStrs { 5 }
 {
     ok = true;
@@ -252,6 +261,8 @@ XRef::XRef() : objStrs { 5 }
     strOwner = false;
     xrefReconstructed = false;
     encAlgorithm = cryptNone;
+    preloadCanceled = false;
+    jbig2GlobalsCache = std::make_unique<JBIG2GlobalsCache>(jbig2GlobalsCacheSize);
 }
 
 XRef::XRef(const Object *trailerDictA) : XRef {}
@@ -334,6 +345,11 @@ XRef::XRef(BaseStream *strA, Goffset pos, Goffset mainXRefEntriesOffsetA, bool *
 
 XRef::~XRef()
 {
+    if (preloadThread.joinable()) {
+        preloadCanceled = true;
+        preloadThread.join();
+    }
+
     for (int i = 0; i < size; i++) {
         if (entries[i].type == xrefEntryFree) {
             continue;
@@ -353,6 +369,8 @@ XRef::~XRef()
 
 XRef *XRef::copy() const
 {
+    xrefLocker();
+
     XRef *xref = new XRef();
     xref->str = str->copy();
     xref->strOwner = true;
@@ -392,8 +410,9 @@ XRef *XRef::copy() const
         xref->entries[i].gen = entries[i].gen;
 
         // If entry has been changed from the stream value we need to copy it
-        // otherwise it's lost
-        if (entries[i].getFlag(XRefEntry::Updated)) {
+        // otherwise it's lost.  Preloaded objects are never modified, so
+        // they are shared rather than decoded again
+        if (entries[i].getFlag(XRefEntry::Updated) || entries[i].getFlag(XRefEntry::Preloaded)) {
             xref->entries[i].obj = entries[i].obj.copy();
         }
     }
@@ -849,40 +868,41 @@ bool XRef::readXRefStreamSection(Stream *xrefStr, const int *w, int first, int n
 // Warning: Reconstruction of files where last XRef section is a stream
 //          or where some objects are defined inside an object stream is not yet supported.
 //          Existing data in XRef::entries may get corrupted if applied anyway.
-bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
+namespace {
+
+// Something constructXRef found while scanning the file.
+struct ConstructXRefItem
+{
+    enum Kind
+    {
+        objectHeader, // "<num> <gen> obj"
+        trailer, // "trailer"
+        streamEnd // "endstream"
+    };
+
+    Kind kind;
+    Goffset pos;
+    int num, gen;
+};
+
+}
+
+// Scan the lines of <s>, from its current position, for object headers,
+// trailers and endstreams, appending them to <items> in file order.
+// <base> is added to the stream positions.
+static void scanForObjects(Stream *s, Goffset base, std::vector<ConstructXRefItem> *items)
 {
-    Parser *parser;
     char buf[256];
     Goffset pos;
     int num, gen;
-    int streamEndsSize;
     char *p;
-    bool gotRoot;
     char *token = nullptr;
     bool oneCycle = true;
     int offset = 0;
 
-    resize(0); // free entries properly
-    gfree(entries);
-    capacity = 0;
-    size = 0;
-    entries = nullptr;
-
-    gotRoot = false;
-    streamEndsLen = streamEndsSize = 0;
-
-    if (wasReconstructed) {
-        *wasReconstructed = true;
-    }
-
-    if (xrefReconstructedCb) {
-        xrefReconstructedCb();
-    }
-
-    str->reset();
     while (true) {
-        pos = str->getPos();
-        if (!str->getLine(buf, 256)) {
+        pos = base + s->getPos();
+        if (!s->getLine(buf, 256)) {
             break;
         }
         p = buf;
@@ -905,18 +925,7 @@ bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
 
             // got trailer dictionary
             if (!strncmp(p, "trailer", 7)) {
-                parser = new Parser(nullptr, str->makeSubStream(pos + 7, false, 0, Object(objNull)), false);
-                Object newTrailerDict = parser->getObj();
-                if (newTrailerDict.isDict()) {
-                    const Object &obj = newTrailerDict.dictLookupNF("Root");
-                    if (obj.isRef() && (!gotRoot || !needCatalogDict) && rootNum != obj.getRefNum()) {
-                        rootNum = obj.getRefNum();
-                        rootGen = obj.getRefGen();
-                        trailerDict = newTrailerDict.copy();
-                        gotRoot = true;
-                    }
-                }
-                delete parser;
+                items->push_back({ ConstructXRefItem::trailer, pos, 0, 0 });
 
                 // look for object
             } else if (isdigit(*p & 0xff)) {
@@ -928,8 +937,10 @@ bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
                     if ((*p & 0xff) == 0 || isspace(*p & 0xff)) {
                         if ((*p & 0xff) == 0) {
                             // new line, continue with next line!
-                            str->getLine(buf, 256);
+                            s->getLine(buf, 256);
                             p = buf;
+                            // <token> pointed into the previous line
+                            token = nullptr;
                         } else {
                             ++p;
                         }
@@ -943,34 +954,16 @@ bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
                             if ((*p & 0xff) == 0 || isspace(*p & 0xff)) {
                                 if ((*p & 0xff) == 0) {
                                     // new line, continue with next line!
-                                    str->getLine(buf, 256);
+                                    s->getLine(buf, 256);
                                     p = buf;
+                                    token = nullptr;
                                 } else {
                                     ++p;
                                 }
                                 while (*p && isspace(*p & 0xff))
                                     ++p;
                                 if (!strncmp(p, "obj", 3)) {
-                                    if (num >= size) {
-                                        if (unlikely(num >= INT_MAX - 1 - 255)) {
-                                            error(errSyntaxError, -1, "Bad object number");
-                                            return false;
-                                        }
-                                        const int newSize = (num + 1 + 255) & ~255;
-                                        if (newSize < 0) {
-                                            error(errSyntaxError, -1, "Bad object number");
-                                            return false;
-                                        }
-                                        if (resize(newSize) != newSize) {
-                                            error(errSyntaxError, -1, "Invalid 'obj' parameters");
-                                            return false;
-                                        }
-                                    }
-                                    if (entries[num].type == xrefEntryFree || gen >= entries[num].gen) {
-                                        entries[num].offset = pos - start;
-                                        entries[num].gen = gen;
-                                        entries[num].type = xrefEntryUncompressed;
-                                    }
+                                    items->push_back({ ConstructXRefItem::objectHeader, pos, num, gen });
                                 }
                             }
                         }
@@ -984,15 +977,7 @@ bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
                     if ((endstreamPos == 0 || Lexer::isSpace(p[endstreamPos - 1] & 0xff)) // endstream is either at beginning or preceeded by space
                         && (endstreamPos + 9 >= 256 || Lexer::isSpace(p[endstreamPos + 9] & 0xff))) // endstream is either at end or followed by space
                     {
-                        if (streamEndsLen == streamEndsSize) {
-                            streamEndsSize += 64;
-                            if (streamEndsSize >= INT_MAX / (int)sizeof(int)) {
-                                error(errSyntaxError, -1, "Invalid 'endstream' parameter.");
-                                return false;
-                            }
-                            streamEnds = (Goffset *)greallocn(streamEnds, streamEndsSize, sizeof(Goffset));
-                        }
-                        streamEnds[streamEndsLen++] = pos + endstreamPos;
+                        items->push_back({ ConstructXRefItem::streamEnd, pos + endstreamPos, 0, 0 });
                     }
                 }
             }
@@ -1006,6 +991,203 @@ bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
             }
         }
     }
+}
+
+// Returns true if scanning <line> can't make scanForObjects read the
+// next line as the rest of an object header: that only happens when a
+// digit is followed by the end of the line, a nul char, or the end of
+// the string cut at "endobj".
+static bool lineEndsObjectHeader(const char *line, int length)
+{
+    for (int i = 0; i < length; ++i) {
+        if (isdigit(line[i] & 0xff) && (i + 1 == length || line[i + 1] == '\0' || line[i + 1] == 'e')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Find in <data> a line start where scanForObjects can begin and give
+// the same results as a scan of the whole file: the line must not be
+// read as the continuation of the line before it.
+static bool findScanStart(const char *data, int length, int *start)
+{
+    int lineStart = -1; // unknown until the first end of line
+    for (int i = 0; i < length; ++i) {
+        if (data[i] != '\n' && data[i] != '\r') {
+            continue;
+        }
+        int next = i + 1;
+        if (data[i] == '\r') {
+            if (next == length) {
+                return false;
+            }
+            if (data[next] == '\n') {
+                ++next;
+            }
+        }
+        if (lineStart >= 0 && lineEndsObjectHeader(data + lineStart, i - lineStart)) {
+            *start = next;
+            return true;
+        }
+        lineStart = next;
+        i = next - 1;
+    }
+    return false;
+}
+
+// large files are read, and scanned in parallel, in chunks of this size
+#define constructXRefChunkSize (16 * 1024 * 1024)
+
+// how far after a chunk boundary to look for a line to start at
+#define constructXRefStartWindow (64 * 1024)
+
+bool XRef::constructXRef(bool *wasReconstructed, bool needCatalogDict)
+{
+    Parser *parser;
+    int streamEndsSize;
+    bool gotRoot;
+
+    resize(0); // free entries properly
+    gfree(entries);
+    capacity = 0;
+    size = 0;
+    entries = nullptr;
+
+    gotRoot = false;
+    streamEndsLen = streamEndsSize = 0;
+
+    if (wasReconstructed) {
+        *wasReconstructed = true;
+    }
+
+    if (xrefReconstructedCb) {
+        xrefReconstructedCb();
+    }
+
+    str->reset();
+    const Goffset scanStart = str->getPos();
+    const Goffset scanEnd = str->getStart() + str->getLength();
+    const unsigned int numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    // the scan results, one vector per chunk, in file order
+    std::vector<std::vector<ConstructXRefItem>> chunkItems;
+
+    // read large files in chunks, scanned in parallel; each chunk
+    // starts on a line which the scan of the previous chunk won't read,
+    // and a chunk where no such line is found is scanned with the
+    // previous one
+    std::vector<Goffset> chunkStarts;
+    if (str->getKind() == strFile && scanEnd - scanStart >= 2 * constructXRefChunkSize) {
+        chunkStarts.push_back(scanStart);
+        std::vector<char> window(constructXRefStartWindow);
+        for (Goffset boundary = scanStart + constructXRefChunkSize; boundary < scanEnd - constructXRefChunkSize / 2; boundary += constructXRefChunkSize) {
+            Stream *s = str->makeSubStream(boundary, true, constructXRefStartWindow, Object(objNull));
+            s->reset();
+            const int n = s->doGetChars(constructXRefStartWindow, (unsigned char *)window.data());
+            delete s;
+            int lineStart;
+            if (findScanStart(window.data(), n, &lineStart)) {
+                chunkStarts.push_back(boundary + lineStart);
+            } else if (boundary - chunkStarts.back() >= INT_MAX / 2 - constructXRefChunkSize) {
+                // too far without a place to split: don't
+                chunkStarts.clear();
+                break;
+            }
+        }
+    }
+
+    if (!chunkStarts.empty()) {
+        chunkStarts.push_back(scanEnd);
+        const int numChunks = chunkStarts.size() - 1;
+        chunkItems.resize(numChunks);
+        std::atomic_int nextChunk { 0 };
+        auto scanChunks = [&]() {
+            std::vector<char> chunk;
+            int i;
+            while ((i = nextChunk++) < numChunks) {
+                const Goffset length = chunkStarts[i + 1] - chunkStarts[i];
+                chunk.resize(length);
+                Stream *s = str->makeSubStream(chunkStarts[i], true, length, Object(objNull));
+                s->reset();
+                const int n = s->doGetChars(length, (unsigned char *)chunk.data());
+                delete s;
+                MemStream mem(chunk.data(), 0, n, Object(objNull));
+                mem.reset();
+                scanForObjects(&mem, chunkStarts[i], &chunkItems[i]);
+            }
+        };
+        std::vector<std::thread> threads;
+        for (unsigned int i = 1; i < std::min<unsigned int>(numThreads, numChunks); ++i) {
+            threads.emplace_back(scanChunks);
+        }
+        scanChunks();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    } else {
+        chunkItems.resize(1);
+        scanForObjects(str, 0, &chunkItems[0]);
+    }
+
+    // use what was found, in file order: later definitions replace
+    // earlier ones
+    for (const std::vector<ConstructXRefItem> &items : chunkItems) {
+        for (const ConstructXRefItem &item : items) {
+            switch (item.kind) {
+            case ConstructXRefItem::trailer: {
+                parser = new Parser(nullptr, str->makeSubStream(item.pos + 7, false, 0, Object(objNull)), false);
+                Object newTrailerDict = parser->getObj();
+                if (newTrailerDict.isDict()) {
+                    const Object &obj = newTrailerDict.dictLookupNF("Root");
+                    if (obj.isRef() && (!gotRoot || !needCatalogDict) && rootNum != obj.getRefNum()) {
+                        rootNum = obj.getRefNum();
+                        rootGen = obj.getRefGen();
+                        trailerDict = newTrailerDict.copy();
+                        gotRoot = true;
+                    }
+                }
+                delete parser;
+                break;
+            }
+            case ConstructXRefItem::objectHeader: {
+                const int num = item.num;
+                if (num >= size) {
+                    if (unlikely(num >= INT_MAX - 1 - 255)) {
+                        error(errSyntaxError, -1, "Bad object number");
+                        return false;
+                    }
+                    const int newSize = (num + 1 + 255) & ~255;
+                    if (newSize < 0) {
+                        error(errSyntaxError, -1, "Bad object number");
+                        return false;
+                    }
+                    if (resize(newSize) != newSize) {
+                        error(errSyntaxError, -1, "Invalid 'obj' parameters");
+                        return false;
+                    }
+                }
+                if (entries[num].type == xrefEntryFree || item.gen >= entries[num].gen) {
+                    entries[num].offset = item.pos - start;
+                    entries[num].gen = item.gen;
+                    entries[num].type = xrefEntryUncompressed;
+                }
+                break;
+            }
+            case ConstructXRefItem::streamEnd:
+                if (streamEndsLen == streamEndsSize) {
+                    streamEndsSize += 64;
+                    if (streamEndsSize >= INT_MAX / (int)sizeof(int)) {
+                        error(errSyntaxError, -1, "Invalid 'endstream' parameter.");
+                        return false;
+                    }
+                    streamEnds = (Goffset *)greallocn(streamEnds, streamEndsSize, sizeof(Goffset));
+                }
+                streamEnds[streamEndsLen++] = item.pos;
+                break;
+            }
+        }
+    }
 
     if (gotRoot)
         return true;
@@ -1053,7 +1235,7 @@ bool XRef::isRefEncrypted(Ref r)
     xrefLocker();
 
     const XRefEntry *e = getEntry(r.num);
-    if (!e->obj.isNull()) { // check for updated object
+    if (!e->obj.isNull() && !e->getFlag(XRefEntry::Preloaded)) { // check for updated object
         return false;
     }
 
@@ -1401,6 +1583,7 @@ void XRef::setModifiedObject(const Object *o, Ref r)
     XRefEntry *e = getEntry(r.num);
     e->obj = o->copy();
     e->setFlag(XRefEntry::Updated, true);
+    e->setFlag(XRefEntry::Preloaded, false);
     setModified();
 }
 
@@ -1453,6 +1636,7 @@ void XRef::removeIndirectObject(Ref r)
         e->gen++;
     }
     e->setFlag(XRefEntry::Updated, true);
+    e->setFlag(XRefEntry::Preloaded, false);
     setModified();
 }
 
@@ -1687,6 +1871,76 @@ DummyXRefEntry dummyXRefEntry;
 
 }
 
+void XRef::preloadObjectStreams(size_t maxSize, bool background)
+{
+    if (preloadThread.joinable()) {
+        return;
+    }
+    if (background && str->getKind() == strFile) {
+        preloadThread = std::thread([this, maxSize] { doPreloadObjectStreams(maxSize); });
+    } else {
+        doPreloadObjectStreams(maxSize);
+    }
+}
+
+void XRef::doPreloadObjectStreams(size_t maxSize)
+{
+    // the compressed objects, by object stream; entries which weren't
+    // read yet are left alone
+    std::vector<std::pair<int, int>> objs; // (object stream number, object number)
+    {
+        xrefLocker();
+        for (int num = 0; num < size; ++num) {
+            const XRefEntry *e = &entries[num];
+            if (e->type == xrefEntryCompressed && e->obj.isNull() && e->offset >= 0 && e->offset < size) {
+                objs.emplace_back((int)e->offset, num);
+            }
+        }
+    }
+    std::stable_sort(objs.begin(), objs.end(), [](const std::pair<int, int> &a, const std::pair<int, int> &b) { return a.first < b.first; });
+
+    size_t preloadedSize = 0;
+    auto it = objs.begin();
+    while (it != objs.end() && preloadedSize < maxSize && !preloadCanceled) {
+        const int objStrNum = it->first;
+        auto end = it;
+        while (end != objs.end() && end->first == objStrNum) {
+            ++end;
+        }
+
+        // lock for each object stream only, so that the document can be
+        // used in the meantime
+        xrefLocker();
+        if (objStrNum < size && entries[objStrNum].type == xrefEntryUncompressed) {
+            std::unique_ptr<ObjectStream> ownObjStr;
+            ObjectStream *objStr = objStrs.lookup(objStrNum);
+            if (!objStr) {
+                ownObjStr = std::make_unique<ObjectStream>(this, objStrNum);
+                objStr = ownObjStr.get();
+            }
+            if (objStr->isOk()) {
+                for (; it != end; ++it) {
+                    // the xref may have been reconstructed meanwhile
+                    if (it->second >= size) {
+                        continue;
+                    }
+                    XRefEntry *e = &entries[it->second];
+                    if (e->type != xrefEntryCompressed || e->offset != objStrNum || !e->obj.isNull()) {
+                        continue;
+                    }
+                    Object obj = objStr->getObject(e->gen, it->second);
+                    if (!obj.isNull()) {
+                        preloadedSize += obj.getMemorySize();
+                        e->obj = std::move(obj);
+                        e->setFlag(XRefEntry::Preloaded, true);
+                    }
+                }
+            }
+        }
+        it = end;
+    }
+}
+
 XRefEntry *XRef::getEntry(int i, bool complainIfMissing)
 {
     if (unlikely(i < 0)) {
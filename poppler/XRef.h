@@ -36,7 +36,10 @@
 #ifndef XREF_H
 #define XREF_H
 
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <thread>
 
 #include "poppler-config.h"
 #include "poppler_private_export.h"
@@ -48,6 +51,7 @@ class Dict;
 class Stream;
 class Parser;
 class ObjectStream;
+class JBIG2GlobalsCache;
 
 //------------------------------------------------------------------------
 // XRef
@@ -74,6 +78,7 @@ struct XRefEntry
         // Regular flags
         Updated, // Entry was modified
         Parsing, // Entry is currently being parsed
+        Preloaded, // obj holds the (unmodified) object, decoded from its object stream
 
         // Special flags -- available only after xref->scanSpecialFlags() is run
         Unencrypted, // Entry is stored in unencrypted form (meaningless in unencrypted documents)
@@ -194,6 +199,20 @@ public:
     // decryption is enabled, and therefore the Unencrypted flag is ignored.
     void scanSpecialFlags();
 
+    // Decode all the object streams, and keep their objects in the xref
+    // entries, so that fetching a compressed object doesn't need its
+    // object stream again.  Stops once the kept objects use about
+    // <maxSize> bytes.  If <background> is true and the document is read
+    // from a local file, this is done in a separate thread, and
+    // preloadObjectStreams returns at once.  Copies of the XRef share
+    // the objects preloaded so far; like the objects fetched from the
+    // original XRef, they keep resolving references through it.
+    void preloadObjectStreams(size_t maxSize, bool background);
+
+    // The decoded JBIG2 globals of the document, shared by its JBIG2
+    // streams.
+    JBIG2GlobalsCache *getJBIG2GlobalsCache() { return jbig2GlobalsCache.get(); }
+
     // Direct access.
     XRefEntry *getEntry(int i, bool complainIfMissing = true);
     Object *getTrailerDict() { return &trailerDict; }
@@ -258,6 +277,9 @@ private:
     bool strOwner; // true if str is owned by the instance
     mutable std::recursive_mutex mutex;
     std::function<void()> xrefReconstructedCb;
+    std::thread preloadThread; // runs preloadObjectStreams in the background
+    std::atomic_bool preloadCanceled; // tells preloadThread to stop
+    std::unique_ptr<JBIG2GlobalsCache> jbig2GlobalsCache;
 
     int reserve(int newSize);
     int resize(int newSize);
@@ -269,6 +291,7 @@ private:
     bool parseEntry(Goffset offset, XRefEntry *entry);
     void readXRefUntil(int untilEntryNum, std::vector<int> *xrefStreamObjsNum = nullptr);
     void markUnencrypted(Object *obj);
+    void doPreloadObjectStreams(size_t maxSize);
 
     class XRefWriter
     {
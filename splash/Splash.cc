@@ -2722,7 +2722,7 @@ void Splash::fillGlyph2(int x0, int y0, SplashGlyphBitmap *glyph, bool noClip)
     }
 }
 
-SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData, int w, int h, SplashCoord *mat, bool glyphMode)
+SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData, int w, int h, SplashCoord *mat, bool glyphMode, SplashImageMaskPackedSource packedSrc)
 {
     SplashBitmap *scaledMask;
     SplashClipResult clipRes;
@@ -2766,7 +2766,7 @@ SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData, int
             if (yp < 0 || yp > INT_MAX - 1) {
                 return splashErrBadArg;
             }
-            scaledMask = scaleMask(src, srcData, w, h, scaledWidth, scaledHeight);
+            scaledMask = scaleMask(src, packedSrc, srcData, w, h, scaledWidth, scaledHeight);
             blitMask(scaledMask, x0, y0, clipRes);
             delete scaledMask;
         }
@@ -2793,7 +2793,7 @@ SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData, int
             if (yp < 0 || yp > INT_MAX - 1) {
                 return splashErrBadArg;
             }
-            scaledMask = scaleMask(src, srcData, w, h, scaledWidth, scaledHeight);
+            scaledMask = scaleMask(src, packedSrc, srcData, w, h, scaledWidth, scaledHeight);
             vertFlipImage(scaledMask, scaledWidth, scaledHeight, 1);
             blitMask(scaledMask, x0, y0, clipRes);
             delete scaledMask;
@@ -2801,13 +2801,13 @@ SplashError Splash::fillImageMask(SplashImageMaskSource src, void *srcData, int
 
         // all other cases
     } else {
-        arbitraryTransformMask(src, srcData, w, h, mat, glyphMode);
+        arbitraryTransformMask(src, packedSrc, srcData, w, h, mat, glyphMode);
     }
 
     return splashOk;
 }
 
-void Splash::arbitraryTransformMask(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, SplashCoord *mat, bool glyphMode)
+void Splash::arbitraryTransformMask(SplashImageMaskSource src, SplashImageMaskPackedSource packedSrc, void *srcData, int srcWidth, int srcHeight, SplashCoord *mat, bool glyphMode)
 {
     SplashBitmap *scaledMask;
     SplashClipResult clipRes, clipRes2;
@@ -2913,7 +2913,7 @@ void Splash::arbitraryTransformMask(SplashImageMaskSource src, void *srcData, in
     ir11 = r00 / det;
 
     // scale the input image
-    scaledMask = scaleMask(src, srcData, srcWidth, srcHeight, scaledWidth, scaledHeight);
+    scaledMask = scaleMask(src, packedSrc, srcData, srcWidth, srcHeight, scaledWidth, scaledHeight);
     if (scaledMask->data == nullptr) {
         error(errInternal, -1, "scaledMask->data is NULL in Splash::arbitraryTransformMask");
         delete scaledMask;
@@ -3070,13 +3070,15 @@ void Splash::arbitraryTransformMask(SplashImageMaskSource src, void *srcData, in
 }
 
 // Scale an image mask into a SplashBitmap.
-SplashBitmap *Splash::scaleMask(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight)
+SplashBitmap *Splash::scaleMask(SplashImageMaskSource src, SplashImageMaskPackedSource packedSrc, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight)
 {
     SplashBitmap *dest;
 
     dest = new SplashBitmap(scaledWidth, scaledHeight, 1, splashModeMono8, false);
     if (scaledHeight < srcHeight) {
-        if (scaledWidth < srcWidth) {
+        if (scaledWidth < srcWidth && packedSrc) {
+            scaleMaskPackedYdownXdown(packedSrc, srcData, srcWidth, srcHeight, scaledWidth, scaledHeight, dest);
+        } else if (scaledWidth < srcWidth) {
             scaleMaskYdownXdown(src, srcData, srcWidth, srcHeight, scaledWidth, scaledHeight, dest);
         } else {
             scaleMaskYdownXup(src, srcData, srcWidth, srcHeight, scaledWidth, scaledHeight, dest);
@@ -3175,6 +3177,136 @@ void Splash::scaleMaskYdownXdown(SplashImageMaskSource src, void *srcData, int s
     gfree(lineBuf);
 }
 
+// Returns the number of set bits in <x>.
+static inline int popCount64(unsigned long long x)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    x -= (x >> 1) & 0x5555555555555555ULL;
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Same as scaleMaskYdownXdown, reading packed lines: the pixels of each
+// box are counted 64 at a time in the line words, instead of being
+// unpacked and added one by one.
+void Splash::scaleMaskPackedYdownXdown(SplashImageMaskPackedSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest)
+{
+    unsigned char *lineBuf;
+    unsigned long long *words;
+    int *boxX;
+    unsigned int *pixBuf;
+    unsigned int pix;
+    unsigned char *destPtr;
+    int yp, yq, xp, xq, yt, y, yStep, xt, x, d0, d1;
+    int nWords, i, j;
+
+    // Bresenham parameters for y scale
+    yp = srcHeight / scaledHeight;
+    yq = srcHeight % scaledHeight;
+
+    // Bresenham parameters for x scale
+    xp = srcWidth / scaledWidth;
+    xq = srcWidth % scaledWidth;
+
+    // allocate buffers; lineBuf is padded to whole words
+    nWords = (srcWidth + 63) >> 6;
+    lineBuf = (unsigned char *)gmallocn_checkoverflow(nWords, 8);
+    words = (unsigned long long *)gmallocn_checkoverflow(nWords, sizeof(unsigned long long));
+    boxX = (int *)gmallocn_checkoverflow(scaledWidth + 1, sizeof(int));
+    pixBuf = (unsigned int *)gmallocn_checkoverflow(scaledWidth, sizeof(int));
+    if (unlikely(!lineBuf || !words || !boxX || !pixBuf)) {
+        error(errInternal, -1, "Couldn't allocate memory for the line buffers in Splash::scaleMaskPackedYdownXdown");
+        gfree(pixBuf);
+        gfree(boxX);
+        gfree(words);
+        gfree(lineBuf);
+        return;
+    }
+    memset(lineBuf, 0, nWords * 8);
+
+    // the first source column of each box, with the x scale Bresenham
+    xt = 0;
+    boxX[0] = 0;
+    for (x = 0; x < scaledWidth; ++x) {
+        if ((xt += xq) >= scaledWidth) {
+            xt -= scaledWidth;
+            boxX[x + 1] = boxX[x] + xp + 1;
+        } else {
+            boxX[x + 1] = boxX[x] + xp;
+        }
+    }
+
+    // init y scale Bresenham
+    yt = 0;
+
+    destPtr = dest->data;
+    for (y = 0; y < scaledHeight; ++y) {
+
+        // y scale Bresenham
+        if ((yt += yq) >= scaledHeight) {
+            yt -= scaledHeight;
+            yStep = yp + 1;
+        } else {
+            yStep = yp;
+        }
+
+        // count the painted pixels of each box, skipping blank lines
+        memset(pixBuf, 0, scaledWidth * sizeof(int));
+        for (i = 0; i < yStep; ++i) {
+            (*src)(srcData, lineBuf);
+            for (j = 0; j < nWords; ++j) {
+                const unsigned char *p = lineBuf + 8 * j;
+                words[j] = ((unsigned long long)p[0] << 56) | ((unsigned long long)p[1] << 48) | ((unsigned long long)p[2] << 40) | ((unsigned long long)p[3] << 32) | ((unsigned long long)p[4] << 24) | ((unsigned long long)p[5] << 16)
+                        | ((unsigned long long)p[6] << 8) | (unsigned long long)p[7];
+            }
+            if (srcWidth & 63) {
+                words[nWords - 1] &= ~0ULL << (64 - (srcWidth & 63));
+            }
+            unsigned long long any = 0;
+            for (j = 0; j < nWords; ++j) {
+                any |= words[j];
+            }
+            if (!any) {
+                continue;
+            }
+            for (x = 0; x < scaledWidth; ++x) {
+                const int x0 = boxX[x];
+                const int x1 = boxX[x + 1] - 1;
+                const unsigned long long mask0 = ~0ULL >> (x0 & 63);
+                const unsigned long long mask1 = ~0ULL << (63 - (x1 & 63));
+                int w0 = x0 >> 6;
+                const int w1 = x1 >> 6;
+                if (w0 == w1) {
+                    pixBuf[x] += popCount64(words[w0] & mask0 & mask1);
+                } else {
+                    unsigned int n = popCount64(words[w0] & mask0);
+                    while (++w0 < w1) {
+                        n += popCount64(words[w0]);
+                    }
+                    pixBuf[x] += n + popCount64(words[w1] & mask1);
+                }
+            }
+        }
+
+        d0 = (255 << 23) / (yStep * xp);
+        d1 = (255 << 23) / (yStep * (xp + 1));
+        for (x = 0; x < scaledWidth; ++x) {
+            // (255 * pix) / xStep * yStep
+            pix = (pixBuf[x] * (boxX[x + 1] - boxX[x] > xp ? d1 : d0)) >> 23;
+            *destPtr++ = (unsigned char)pix;
+        }
+    }
+
+    gfree(pixBuf);
+    gfree(boxX);
+    gfree(words);
+    gfree(lineBuf);
+}
+
 void Splash::scaleMaskYdownXup(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest)
 {
     unsigned char *lineBuf;
@@ -49,6 +49,12 @@ struct SplashPipe;
 // exhausted, returns false.
 typedef bool (*SplashImageMaskSource)(void *data, SplashColorPtr pixel);
 
+// Retrieves the next line of an image mask packed 8 pixels per byte,
+// the first pixel in the most significant bit, 1 meaning the pixel is
+// painted.  The bits past the end of the line are ignored.  Returns
+// false if the image stream is exhausted.
+typedef bool (*SplashImageMaskPackedSource)(void *data, unsigned char *line);
+
 // Retrieves the next line of pixels in an image.  Normally, fills in
 // *<line> and returns true.  If the image stream is exhausted,
 // returns false.
@@ -184,8 +190,10 @@ public:
     //    [x' y' 1] = [x y 1] * mat
     // Note that the Splash y axis points downward, and the image source
     // is assumed to produce pixels in raster order, starting from the
-    // top line.
-    SplashError fillImageMask(SplashImageMaskSource src, void *srcData, int w, int h, SplashCoord *mat, bool glyphMode);
+    // top line.  If <packedSrc> is set, it reads the same lines as
+    // <src>, packed, from <srcData>; it is used instead of <src> when the
+    // mask is scaled down in both directions, which is much faster.
+    SplashError fillImageMask(SplashImageMaskSource src, void *srcData, int w, int h, SplashCoord *mat, bool glyphMode, SplashImageMaskPackedSource packedSrc = nullptr);
 
     // Draw an image.  This will read <h> lines of <w> pixels from
     // <src>, starting with the top line.  These pixels are assumed to
@@ -291,9 +299,10 @@ private:
     SplashError fillWithPattern(SplashPath *path, bool eo, SplashPattern *pattern, SplashCoord alpha);
     bool pathAllOutside(SplashPath *path);
     void fillGlyph2(int x0, int y0, SplashGlyphBitmap *glyph, bool noclip);
-    void arbitraryTransformMask(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, SplashCoord *mat, bool glyphMode);
-    SplashBitmap *scaleMask(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight);
+    void arbitraryTransformMask(SplashImageMaskSource src, SplashImageMaskPackedSource packedSrc, void *srcData, int srcWidth, int srcHeight, SplashCoord *mat, bool glyphMode);
+    SplashBitmap *scaleMask(SplashImageMaskSource src, SplashImageMaskPackedSource packedSrc, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight);
     void scaleMaskYdownXdown(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest);
+    void scaleMaskPackedYdownXdown(SplashImageMaskPackedSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest);
     void scaleMaskYdownXup(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest);
     void scaleMaskYupXdown(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest);
     void scaleMaskYupXup(SplashImageMaskSource src, void *srcData, int srcWidth, int srcHeight, int scaledWidth, int scaledHeight, SplashBitmap *dest);
@@ -147,6 +147,34 @@ SplashBitmap *SplashBitmap::copy(const SplashBitmap *src)
     return result;
 }
 
+SplashBitmap *SplashBitmap::copyRect(const SplashBitmap *src, int x, int y, int w, int h)
+{
+    SplashBitmap *result = new SplashBitmap(w, h, src->getRowPad(), src->getMode(), src->getAlphaPtr() != nullptr, src->getRowSize() >= 0, src->getSeparationList());
+    if (!result->getDataPtr()) {
+        return result;
+    }
+    for (int row = 0; row < h; ++row) {
+        SplashColorConstPtr dataSource = src->getDataPtr() + (y + row) * src->getRowSize();
+        SplashColorPtr dataDest = result->getDataPtr() + row * result->getRowSize();
+        if (src->getMode() == splashModeMono1) {
+            for (int col = 0; col < w; ++col) {
+                if (dataSource[(x + col) >> 3] & (0x80 >> ((x + col) & 7))) {
+                    dataDest[col >> 3] |= 0x80 >> (col & 7);
+                } else {
+                    dataDest[col >> 3] &= ~(0x80 >> (col & 7));
+                }
+            }
+        } else {
+            const int nComps = splashColorModeNComps[src->getMode()];
+            memcpy(dataDest, dataSource + x * nComps, w * nComps);
+        }
+        if (src->getAlphaPtr() != nullptr) {
+            memcpy(result->getAlphaPtr() + row * w, src->getAlphaPtr() + (y + row) * src->getWidth() + x, w);
+        }
+    }
+    return result;
+}
+
 SplashBitmap::~SplashBitmap()
 {
     if (data) {
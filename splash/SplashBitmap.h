@@ -53,6 +53,9 @@ public:
     // upside-down, i.e., with the last row first in memory.
     SplashBitmap(int widthA, int heightA, int rowPad, SplashColorMode modeA, bool alphaA, bool topDown = true, const std::vector<GfxSeparationColorSpace *> *separationList = nullptr);
     static SplashBitmap *copy(const SplashBitmap *src);
+    // Create a new bitmap holding the <w> x <h> pixels of <src> at
+    // (<x>, <y>), which must be inside <src>.
+    static SplashBitmap *copyRect(const SplashBitmap *src, int x, int y, int w, int h);
 
     ~SplashBitmap();
 
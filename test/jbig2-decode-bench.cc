@@ -0,0 +1,660 @@
+//========================================================================
+//
+// jbig2-decode-bench.cc
+//
+// Time JBIG2Stream on synthetic scanned pages, or on all the JBIG2
+// images of the PDF files given as arguments.  The synthetic pages are
+// either coded as one generic region each, or as text regions placing
+// the symbols of a dictionary shared by all the pages through a
+// JBIG2Globals stream.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "goo/GooString.h"
+#include "goo/GooTimer.h"
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "Stream.h"
+#include "XRef.h"
+#include "utils/parseargs.h"
+#include "test-pdf-writer.h"
+
+static int pageWidth = 2480;
+static int pageHeight = 3508;
+static int numPages = 1;
+static bool tpgdOn = false;
+static bool otherAT = false;
+static bool useSymbols = false;
+static int numRuns = 1;
+static char pdfOutFile[1024] = "";
+static bool printHelp = false;
+
+static const ArgDesc argDesc[] = { { "-width", argInt, &pageWidth, 0, "width of the synthetic page (default is 2480)" },
+                                   { "-height", argInt, &pageHeight, 0, "height of the synthetic page (default is 3508)" },
+                                   { "-pages", argInt, &numPages, 0, "number of synthetic pages (default is 1)" },
+                                   { "-tpgdon", argFlag, &tpgdOn, 0, "code the synthetic pages with typical prediction" },
+                                   { "-at", argFlag, &otherAT, 0, "code the synthetic pages with non-nominal AT pixels" },
+                                   { "-symbols", argFlag, &useSymbols, 0, "code the synthetic pages as text regions, with a shared symbol dictionary" },
+                                   { "-runs", argInt, &numRuns, 0, "number of times the images are decoded (default is 1)" },
+                                   { "-o", argString, pdfOutFile, sizeof(pdfOutFile), "also write the generated PDF to this file" },
+                                   { "-h", argFlag, &printHelp, 0, "print usage information" },
+                                   { "-help", argFlag, &printHelp, 0, "print usage information" },
+                                   { "--help", argFlag, &printHelp, 0, "print usage information" },
+                                   { "-?", argFlag, &printHelp, 0, "print usage information" },
+                                   {} };
+
+//------------------------------------------------------------------------
+// the MQ arithmetic encoder of the JBIG2 spec (T.88 annex E)
+//------------------------------------------------------------------------
+
+static const unsigned int qeTab[47] = { 0x5601, 0x3401, 0x1801, 0x0AC1, 0x0521, 0x0221, 0x5601, 0x5401, 0x4801, 0x3801, 0x3001, 0x2401, 0x1C01, 0x1601, 0x5601, 0x5401, 0x5101, 0x4801, 0x3801, 0x3401, 0x3001, 0x2801, 0x2401, 0x2201,
+                                        0x1C01, 0x1801, 0x1601, 0x1401, 0x1201, 0x1101, 0x0AC1, 0x09C1, 0x08A1, 0x0521, 0x0441, 0x02A1, 0x0221, 0x0141, 0x0111, 0x0085, 0x0049, 0x0025, 0x0015, 0x0009, 0x0005, 0x0001, 0x5601 };
+static const int nmpsTab[47] = { 1, 2, 3, 4, 5, 38, 7, 8, 9, 10, 11, 12, 13, 29, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 45, 46 };
+static const int nlpsTab[47] = { 1, 6, 9, 12, 29, 33, 6, 14, 14, 14, 17, 18, 20, 21, 14, 14, 15, 16, 17, 18, 19, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 46 };
+static const int switchTab[47] = { 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// The probability states of a set of contexts.
+struct MQStats
+{
+    explicit MQStats(int contextSize) : index(contextSize, 0), mps(contextSize, 0) { }
+
+    std::vector<int> index;
+    std::vector<int> mps;
+};
+
+class MQEncoder
+{
+public:
+    MQEncoder() : a(0x8000), c(0), ct(12)
+    {
+        // a dummy byte stands for the byte before the start of the data
+        out.push_back(0);
+    }
+
+    void encode(MQStats *stats, unsigned int cx, int d)
+    {
+        int &index = stats->index[cx];
+        const unsigned int qe = qeTab[index];
+        a -= qe;
+        if (d == stats->mps[cx]) {
+            if (a & 0x8000) {
+                c += qe;
+                return;
+            }
+            if (a < qe) {
+                a = qe;
+            } else {
+                c += qe;
+            }
+            index = nmpsTab[index];
+        } else {
+            if (a < qe) {
+                c += qe;
+            } else {
+                a = qe;
+            }
+            if (switchTab[index]) {
+                stats->mps[cx] ^= 1;
+            }
+            index = nlpsTab[index];
+        }
+        do {
+            a <<= 1;
+            c <<= 1;
+            if (--ct == 0) {
+                byteOut();
+            }
+        } while (!(a & 0x8000));
+    }
+
+    // Encode the integer <x> (T.88 annex A.2), with the 512 contexts of
+    // <stats>; <oob> encodes the out-of-band value instead.
+    void encodeInt(MQStats *stats, int x, bool oob = false)
+    {
+        const unsigned int v = oob ? 0 : (x < 0 ? -x : x);
+        int prefix, nBits;
+        unsigned int offset;
+        if (v < 4) {
+            prefix = 0x0, nBits = 2, offset = 0;
+        } else if (v < 20) {
+            prefix = 0x2, nBits = 4, offset = 4;
+        } else if (v < 84) {
+            prefix = 0x6, nBits = 6, offset = 20;
+        } else if (v < 340) {
+            prefix = 0xe, nBits = 8, offset = 84;
+        } else if (v < 4436) {
+            prefix = 0x1e, nBits = 12, offset = 340;
+        } else {
+            prefix = 0x1f, nBits = 32, offset = 4436;
+        }
+        int prefixLen = 1;
+        while (prefix >> prefixLen) {
+            ++prefixLen;
+        }
+        unsigned int prev = 1;
+        auto encodeIntBit = [&](int bit) {
+            encode(stats, prev, bit);
+            prev = prev < 0x100 ? (prev << 1) | bit : (((prev << 1) | bit) & 0x1ff) | 0x100;
+        };
+        encodeIntBit(oob || x < 0);
+        for (int i = prefixLen - 1; i >= 0; --i) {
+            encodeIntBit((prefix >> i) & 1);
+        }
+        for (int i = nBits - 1; i >= 0; --i) {
+            encodeIntBit(((v - offset) >> i) & 1);
+        }
+    }
+
+    // Encode the symbol ID <id> of <codeLen> bits (T.88 annex A.3).
+    void encodeIAID(MQStats *stats, unsigned int codeLen, unsigned int id)
+    {
+        unsigned int prev = 1;
+        for (int i = (int)codeLen - 1; i >= 0; --i) {
+            const int bit = (id >> i) & 1;
+            encode(stats, prev, bit);
+            prev = (prev << 1) | bit;
+        }
+    }
+
+    // Flush the coder and return the coded data, with its end marker.
+    std::string finish()
+    {
+        const unsigned int tempC = c + a;
+        c |= 0xffff;
+        if (c >= tempC) {
+            c -= 0x8000;
+        }
+        c <<= ct;
+        byteOut();
+        c <<= ct;
+        byteOut();
+        if (out.back() != 0xff) {
+            out.push_back(0xff);
+        }
+        out.push_back(0xac);
+        return std::string((const char *)out.data() + 1, out.size() - 1);
+    }
+
+private:
+    void byteOut()
+    {
+        if (out.back() == 0xff) {
+            out.push_back(c >> 20);
+            c &= 0xfffff;
+            ct = 7;
+        } else if (c < 0x8000000) {
+            out.push_back(c >> 19);
+            c &= 0x7ffff;
+            ct = 8;
+        } else {
+            ++out.back();
+            if (out.back() == 0xff) {
+                c &= 0x7ffffff;
+                out.push_back(c >> 20);
+                c &= 0xfffff;
+                ct = 7;
+            } else {
+                out.push_back(c >> 19);
+                c &= 0x7ffff;
+                ct = 8;
+            }
+        }
+    }
+
+    std::vector<unsigned char> out;
+    unsigned int a, c;
+    int ct;
+};
+
+//------------------------------------------------------------------------
+// synthetic pages
+//------------------------------------------------------------------------
+
+// A 1 bpp bitmap, 1 = black, rows padded to whole bytes, like
+// JBIG2Stream's output before it is inverted.
+struct Bitmap
+{
+    Bitmap(int wA, int hA) : w(wA), h(hA), line((wA + 7) / 8), data((size_t)line * hA, 0) { }
+
+    int getPixel(int x, int y) const { return (x < 0 || x >= w || y < 0 || y >= h) ? 0 : (data[(size_t)y * line + (x >> 3)] >> (7 - (x & 7))) & 1; }
+    void setPixel(int x, int y) { data[(size_t)y * line + (x >> 3)] |= 1 << (7 - (x & 7)); }
+
+    int w, h, line;
+    std::vector<unsigned char> data;
+};
+
+struct Placement
+{
+    int glyph;
+    int x, y; // top left corner
+};
+
+// The text lines of a page: the glyphs of each line, left to right.
+typedef std::vector<std::vector<Placement>> TextPage;
+
+// Make a set of text-like glyphs <glyphH> pixels high, or a bit more
+// for the ones with a descender, sorted by height.
+static std::vector<Bitmap> makeGlyphs(int glyphH)
+{
+    std::vector<Bitmap> glyphs;
+    const int stroke = glyphH / 8 + 1;
+    for (int descender = 0; descender < 2; ++descender) {
+        for (int k = 0; k < 32; ++k) {
+            const int h = descender ? glyphH + glyphH / 4 : glyphH;
+            const int w = glyphH / 3 + (k * 5) % (glyphH / 2 + 1);
+            Bitmap glyph(w, h);
+            for (int gy = 0; gy < h; ++gy) {
+                for (int gx = 0; gx < w; ++gx) {
+                    bool ink;
+                    switch (k % 4) {
+                    case 0: // a stem
+                        ink = gx < stroke;
+                        break;
+                    case 1: // a bowl
+                        ink = gy < stroke || gy >= h - stroke || gx < stroke || gx >= w - stroke;
+                        break;
+                    case 2: // a crossbar
+                        ink = gx < stroke || (gy >= h / 2 && gy < h / 2 + stroke);
+                        break;
+                    default: // a diagonal
+                        ink = gx * h >= gy * w - stroke * h && gx * h < gy * w + stroke * h;
+                        break;
+                    }
+                    if (ink) {
+                        glyph.setPixel(gx, gy);
+                    }
+                }
+            }
+            glyphs.push_back(std::move(glyph));
+        }
+    }
+    return glyphs;
+}
+
+// Lay out lines of random glyphs, with paragraph breaks, on a page.
+static TextPage layOutPage(int page, int w, int h, int lineH, const std::vector<Bitmap> &glyphs)
+{
+    unsigned int seed = page + 1;
+    auto rnd = [&seed](int n) {
+        seed = seed * 1103515245 + 12345;
+        return (int)((seed >> 16) % (unsigned int)n);
+    };
+
+    TextPage lines;
+    const int margin = w / 12;
+    const int space = lineH / 2;
+    for (int y = margin, lineNum = 0; y + lineH < h - margin; y += lineH, ++lineNum) {
+        if (lineNum % 12 == 11) {
+            continue;
+        }
+        lines.emplace_back();
+        for (int x = margin;;) {
+            const int glyph = rnd((int)glyphs.size());
+            if (x + glyphs[glyph].w > w - margin) {
+                break;
+            }
+            lines.back().push_back({ glyph, x, y });
+            x += glyphs[glyph].w + lineH / 8 + (rnd(6) == 0 ? space : 0);
+        }
+    }
+    return lines;
+}
+
+static Bitmap renderPage(const TextPage &lines, int w, int h, const std::vector<Bitmap> &glyphs)
+{
+    Bitmap bitmap(w, h);
+    for (const std::vector<Placement> &line : lines) {
+        for (const Placement &p : line) {
+            const Bitmap &glyph = glyphs[p.glyph];
+            for (int gy = 0; gy < glyph.h; ++gy) {
+                for (int gx = 0; gx < glyph.w; ++gx) {
+                    if (glyph.getPixel(gx, gy)) {
+                        bitmap.setPixel(p.x + gx, p.y + gy);
+                    }
+                }
+            }
+        }
+    }
+    return bitmap;
+}
+
+//------------------------------------------------------------------------
+// JBIG2 segments
+//------------------------------------------------------------------------
+
+static const int nominalATX[4] = { 3, -3, 2, -2 };
+static const int nominalATY[4] = { -1, -1, -2, -2 };
+
+// Code <bitmap> as a template 0 generic region, with the context layout
+// JBIG2Stream uses (T.88 6.2.5.3).
+static void encodeGenericRegion(MQEncoder *enc, MQStats *stats, const Bitmap &bitmap, bool tpgd, const int *atx, const int *aty)
+{
+    const unsigned int ltpCX = 0x3953;
+    bool ltp = false;
+
+    for (int y = 0; y < bitmap.h; ++y) {
+        if (tpgd) {
+            bool typical = true;
+            for (int x = 0; x < bitmap.w && typical; ++x) {
+                typical = bitmap.getPixel(x, y) == bitmap.getPixel(x, y - 1);
+            }
+            enc->encode(stats, ltpCX, typical != ltp);
+            ltp = typical;
+            if (ltp) {
+                continue;
+            }
+        }
+        for (int x = 0; x < bitmap.w; ++x) {
+            unsigned int cx = 0;
+            for (int i = -1; i <= 1; ++i) {
+                cx = (cx << 1) | bitmap.getPixel(x + i, y - 2);
+            }
+            for (int i = -2; i <= 2; ++i) {
+                cx = (cx << 1) | bitmap.getPixel(x + i, y - 1);
+            }
+            for (int i = -4; i <= -1; ++i) {
+                cx = (cx << 1) | bitmap.getPixel(x + i, y);
+            }
+            for (int i = 0; i < 4; ++i) {
+                cx = (cx << 1) | bitmap.getPixel(x + atx[i], y + aty[i]);
+            }
+            enc->encode(stats, cx, bitmap.getPixel(x, y));
+        }
+    }
+}
+
+static void appendULong(std::string *s, unsigned int x)
+{
+    s->push_back((char)(x >> 24));
+    s->push_back((char)(x >> 16));
+    s->push_back((char)(x >> 8));
+    s->push_back((char)x);
+}
+
+// Append a segment header; <refSeg> is the referred-to segment, or -1.
+static void appendSegmentHeader(std::string *s, unsigned int segNum, unsigned int type, unsigned int page, int refSeg, unsigned int dataLength)
+{
+    appendULong(s, segNum);
+    s->push_back((char)type);
+    if (refSeg >= 0) {
+        s->push_back(1 << 5);
+        s->push_back((char)refSeg);
+    } else {
+        s->push_back(0);
+    }
+    s->push_back((char)page);
+    appendULong(s, dataLength);
+}
+
+static void appendPageInfo(std::string *s, int w, int h)
+{
+    appendSegmentHeader(s, 0, 48, 1, -1, 19);
+    appendULong(s, w);
+    appendULong(s, h);
+    appendULong(s, 0);
+    appendULong(s, 0);
+    s->push_back(0);
+    s->push_back(0);
+    s->push_back(0);
+}
+
+static void appendRegionInfo(std::string *s, int w, int h)
+{
+    appendULong(s, w);
+    appendULong(s, h);
+    appendULong(s, 0);
+    appendULong(s, 0);
+    s->push_back(0); // combination operator: or
+}
+
+// Build the JBIG2 data (embedded format) of a page holding <bitmap> in
+// a generic region.
+static std::string makeGenericRegionPage(const Bitmap &bitmap)
+{
+    static const int otherATX[4] = { 4, -3, 2, -2 };
+    static const int otherATY[4] = { -1, -1, -2, -2 };
+    const int *atx = otherAT ? otherATX : nominalATX;
+    const int *aty = otherAT ? otherATY : nominalATY;
+    std::string s;
+
+    appendPageInfo(&s, bitmap.w, bitmap.h);
+
+    // immediate generic region segment
+    MQEncoder enc;
+    MQStats stats(1 << 16);
+    encodeGenericRegion(&enc, &stats, bitmap, tpgdOn, atx, aty);
+    const std::string coded = enc.finish();
+    appendSegmentHeader(&s, 1, 38, 1, -1, 17 + 1 + 8 + coded.size());
+    appendRegionInfo(&s, bitmap.w, bitmap.h);
+    s.push_back(tpgdOn ? 8 : 0); // arithmetic coding, template 0
+    for (int i = 0; i < 4; ++i) {
+        s.push_back((char)atx[i]);
+        s.push_back((char)aty[i]);
+    }
+    s += coded;
+    return s;
+}
+
+// Build JBIG2 globals data holding a symbol dictionary (segment 0) with
+// <glyphs>, which are sorted by height.
+static std::string makeSymbolDict(const std::vector<Bitmap> &glyphs)
+{
+    MQEncoder enc;
+    MQStats genericStats(1 << 16), iadhStats(512), iadwStats(512), iaexStats(512);
+    int symHeight = 0;
+
+    for (size_t i = 0; i < glyphs.size();) {
+        enc.encodeInt(&iadhStats, glyphs[i].h - symHeight);
+        symHeight = glyphs[i].h;
+        int symWidth = 0;
+        for (; i < glyphs.size() && glyphs[i].h == symHeight; ++i) {
+            enc.encodeInt(&iadwStats, glyphs[i].w - symWidth);
+            symWidth = glyphs[i].w;
+            encodeGenericRegion(&enc, &genericStats, glyphs[i], false, nominalATX, nominalATY);
+        }
+        enc.encodeInt(&iadwStats, 0, true);
+    }
+
+    // export all the symbols
+    enc.encodeInt(&iaexStats, 0);
+    enc.encodeInt(&iaexStats, (int)glyphs.size());
+    const std::string coded = enc.finish();
+
+    std::string s;
+    appendSegmentHeader(&s, 0, 0, 0, -1, 2 + 8 + 4 + 4 + coded.size());
+    s.push_back(0); // arithmetic coding, template 0, no refinement
+    s.push_back(0);
+    for (int i = 0; i < 4; ++i) {
+        s.push_back((char)nominalATX[i]);
+        s.push_back((char)nominalATY[i]);
+    }
+    appendULong(&s, glyphs.size());
+    appendULong(&s, glyphs.size());
+    s += coded;
+    return s;
+}
+
+// Build the JBIG2 data of a page placing the symbols of the dictionary
+// in the globals (segment 0) in a text region.
+static std::string makeTextRegionPage(const TextPage &lines, int w, int h, const std::vector<Bitmap> &glyphs)
+{
+    MQEncoder enc;
+    MQStats iadtStats(512), iafsStats(512), iadsStats(512);
+    unsigned int symCodeLen = 0;
+    while ((1u << symCodeLen) < glyphs.size()) {
+        ++symCodeLen;
+    }
+    MQStats iaidStats(1 << (symCodeLen + 1));
+
+    // one strip per line, with the symbols placed by their top left
+    // corner
+    unsigned int numInstances = 0;
+    int t = 0, sFirst = 0;
+    enc.encodeInt(&iadtStats, 0);
+    for (const std::vector<Placement> &line : lines) {
+        if (line.empty()) {
+            continue;
+        }
+        enc.encodeInt(&iadtStats, line[0].y - t);
+        t = line[0].y;
+        enc.encodeInt(&iafsStats, line[0].x - sFirst);
+        sFirst = line[0].x;
+        for (size_t i = 0; i < line.size(); ++i) {
+            enc.encodeIAID(&iaidStats, symCodeLen, line[i].glyph);
+            if (i + 1 < line.size()) {
+                enc.encodeInt(&iadsStats, line[i + 1].x - (line[i].x + glyphs[line[i].glyph].w - 1));
+            } else {
+                enc.encodeInt(&iadsStats, 0, true);
+            }
+        }
+        numInstances += line.size();
+    }
+    const std::string coded = enc.finish();
+
+    std::string s;
+    appendPageInfo(&s, w, h);
+    appendSegmentHeader(&s, 1, 6, 1, 0, 17 + 2 + 4 + coded.size());
+    appendRegionInfo(&s, w, h);
+    s.push_back(0); // arithmetic coding, no refinement, one strip
+    s.push_back(1 << 4); // top left reference corner
+    appendULong(&s, numInstances);
+    s += coded;
+    return s;
+}
+
+// Build a PDF whose pages each show one of the JBIG2 images <images>,
+// with the globals <globals> if not empty.
+static std::string makeImagePDF(const std::vector<std::string> &images, const std::string &globals, int w, int h)
+{
+    TestPDFWriter writer;
+
+    // 1: catalog, 2: pages, 3: globals, 4: content, 5..: pages and images
+    std::string kids;
+    for (size_t i = 0; i < images.size(); ++i) {
+        kids += std::to_string(5 + 2 * i) + " 0 R ";
+    }
+    const std::string size = std::to_string(w) + " " + std::to_string(h);
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(images.size()) + " >>");
+    writer.addStream("", globals);
+    writer.addStream("", "q " + std::to_string(w) + " 0 0 " + std::to_string(h) + " 0 0 cm /Im1 Do Q");
+    for (size_t i = 0; i < images.size(); ++i) {
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 " + size + " ] /Contents 4 0 R /Resources << /XObject << /Im1 " + std::to_string(6 + 2 * i) + " 0 R >> >> >>");
+        writer.addStream("/Type /XObject /Subtype /Image /Width " + std::to_string(w) + " /Height " + std::to_string(h) + " /ColorSpace /DeviceGray /BitsPerComponent 1 /Filter /JBIG2Decode"
+                                 + (globals.empty() ? std::string() : " /DecodeParms << /JBIG2Globals 3 0 R >>"),
+                         images[i]);
+    }
+    return writer.finish();
+}
+
+//------------------------------------------------------------------------
+
+// Collect the JBIG2 image streams of <doc>.
+static std::vector<Object> findJBIG2Streams(PDFDoc *doc)
+{
+    std::vector<Object> streams;
+    XRef *xref = doc->getXRef();
+    for (int i = 1; i < xref->getNumObjects(); ++i) {
+        Object obj = xref->fetch(i, xref->getEntry(i)->gen);
+        if (obj.isStream() && obj.getStream()->getKind() == strJBIG2) {
+            streams.push_back(std::move(obj));
+        }
+    }
+    return streams;
+}
+
+// Decode <streams> <numRuns> times, print the timings, and return the
+// data of the last run.
+static std::vector<std::string> timeDecode(const std::vector<Object> &streams, const char *name)
+{
+    std::vector<std::string> decoded(streams.size());
+    long long pixels = 0;
+    for (const Object &obj : streams) {
+        Dict *dict = obj.streamGetDict();
+        const Object w = dict->lookup("Width");
+        const Object h = dict->lookup("Height");
+        if (w.isInt() && h.isInt()) {
+            pixels += (long long)w.getInt() * h.getInt();
+        }
+    }
+    for (int run = 0; run < numRuns; ++run) {
+        GooTimer timer;
+        for (size_t i = 0; i < streams.size(); ++i) {
+            decoded[i].clear();
+            streams[i].getStream()->fillString(decoded[i]);
+            streams[i].getStream()->close();
+        }
+        timer.stop();
+        printf("%s: %zu image(s), %.3f ms (%.1f Mpixel/s)\n", name, streams.size(), timer.getElapsed() * 1000, timer.getElapsed() > 0 ? pixels / timer.getElapsed() / 1e6 : 0.0);
+    }
+    return decoded;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool ok = parseArgs(argDesc, &argc, argv);
+    if (!ok || printHelp || pageWidth < 1 || pageHeight < 1 || numPages < 1 || numRuns < 1) {
+        printUsage(argv[0], "[<PDF-file> ...]", argDesc);
+        return printHelp ? 0 : 1;
+    }
+
+    globalParams = std::make_unique<GlobalParams>();
+
+    // time the JBIG2 images of the given files
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            PDFDoc doc(new GooString(argv[i]));
+            if (!doc.isOk()) {
+                fprintf(stderr, "Error loading %s\n", argv[i]);
+                return 1;
+            }
+            timeDecode(findJBIG2Streams(&doc), argv[i]);
+        }
+        return 0;
+    }
+
+    // time the synthetic pages, and check they decode to what was coded
+    const int lineH = pageHeight / 60 > 8 ? pageHeight / 60 : 8;
+    const std::vector<Bitmap> glyphs = makeGlyphs(lineH * 2 / 3);
+    std::vector<std::string> images, expected;
+    for (int page = 0; page < numPages; ++page) {
+        const TextPage lines = layOutPage(page, pageWidth, pageHeight, lineH, glyphs);
+        const Bitmap bitmap = renderPage(lines, pageWidth, pageHeight, glyphs);
+        images.push_back(useSymbols ? makeTextRegionPage(lines, pageWidth, pageHeight, glyphs) : makeGenericRegionPage(bitmap));
+        expected.emplace_back(bitmap.data.begin(), bitmap.data.end());
+        for (char &c : expected.back()) {
+            c ^= 0xff;
+        }
+    }
+    const std::string pdf = makeImagePDF(images, useSymbols ? makeSymbolDict(glyphs) : std::string(), pageWidth, pageHeight);
+    if (pdfOutFile[0]) {
+        FILE *f = fopen(pdfOutFile, "wb");
+        if (f) {
+            fwrite(pdf.data(), 1, pdf.size(), f);
+            fclose(f);
+        }
+    }
+
+    PDFDoc doc(new MemStream(pdf.data(), 0, pdf.size(), Object(objNull)));
+    if (!doc.isOk()) {
+        fprintf(stderr, "Error loading the generated document\n");
+        return 1;
+    }
+    const std::vector<Object> streams = findJBIG2Streams(&doc);
+    if (timeDecode(streams, "synthetic pages") != expected) {
+        fprintf(stderr, "The synthetic pages were not decoded correctly\n");
+        return 1;
+    }
+
+    return 0;
+}
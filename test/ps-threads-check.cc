@@ -0,0 +1,162 @@
+//========================================================================
+//
+// ps-threads-check.cc
+//
+// Check the raster threads of PSOutputDev: a multi-page document, with
+// pages rasterized for their transparency between vector ones, must
+// convert to the same PostScript with any number of threads as without
+// them -- in page order, with pages listed out of order or twice, and
+// with pages of the list skipped by the caller.
+//
+// The worker threads open their own copy of the document, so the
+// document is written to the file given on the command line.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GlobalParams.h"
+#include "GooString.h"
+#include "PDFDoc.h"
+#include "PSOutputDev.h"
+#include "test-pdf-writer.h"
+
+static const int numPages = 12;
+
+// Rectangles in random colors, and on the pages with a soft mask or a
+// constant alpha, which are rasterized, text over them.
+static std::string makePageContent(int page, unsigned int *seed)
+{
+    std::string content;
+    char buf[128];
+    if (page % 3 == 1) {
+        content += "/G1 gs\n";
+    } else if (page % 3 == 2) {
+        content += "/G2 gs\n";
+    }
+    for (int i = 0; i < 200; ++i) {
+        int v[7];
+        for (int &x : v) {
+            *seed = *seed * 1103515245 + 12345;
+            x = (*seed >> 16) & 0xff;
+        }
+        snprintf(buf, sizeof(buf), "%.2f %.2f %.2f rg %d %d %d %d re f\n", v[0] / 255.0, v[1] / 255.0, v[2] / 255.0, v[3] * 3 / 4, v[4] * 3 / 4, v[5] / 16 + 2, v[6] / 16 + 2);
+        content += buf;
+    }
+    snprintf(buf, sizeof(buf), "0 g BT /F1 12 Tf 20 170 Td (Page %d) Tj ET\n", page);
+    content += buf;
+    return content;
+}
+
+static std::string makeTestPDF()
+{
+    TestPDFWriter writer;
+
+    // 1: catalog, 2: pages, 3: font, 4, 5: graphics states, 6: soft mask
+    // group, then a page and its content per page
+    std::string kids;
+    for (int i = 0; i < numPages; ++i) {
+        kids += std::to_string(7 + 2 * i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(numPages) + " >>");
+    writer.addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    writer.addObject("<< /Type /ExtGState /ca 0.5 /CA 0.5 >>");
+    writer.addObject("<< /Type /ExtGState /SMask << /Type /Mask /S /Luminosity /G 6 0 R >> >>");
+    writer.addStream("/Type /XObject /Subtype /Form /BBox [ 0 0 200 200 ] /Group << /S /Transparency /CS /DeviceGray >>", "0.8 g 20 20 160 160 re f");
+    unsigned int seed = 4321;
+    for (int i = 0; i < numPages; ++i) {
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 200 200 ] /Contents " + std::to_string(8 + 2 * i) + " 0 R /Resources << /Font << /F1 3 0 R >> /ExtGState << /G1 4 0 R /G2 5 0 R >> >> >>");
+        writer.addStream("", makePageContent(i + 1, &seed));
+    }
+    return writer.finish();
+}
+
+static void appendOutput(void *stream, const char *data, int len)
+{
+    static_cast<std::string *>(stream)->append(data, len);
+}
+
+// Convert the pages <displayed> of <pages> with <threads> raster threads.
+static std::string convert(PDFDoc *doc, const std::vector<int> &pages, const std::vector<int> &displayed, int threads)
+{
+    std::string out;
+    char title[] = "ps-threads-check";
+    PSOutputDev *psOut = new PSOutputDev(&appendOutput, &out, title, doc, pages, psModePS);
+    if (!psOut->isOk()) {
+        delete psOut;
+        return std::string();
+    }
+    if (threads > 0) {
+        psOut->setRasterThreads(threads);
+    }
+    for (const int page : displayed) {
+        doc->displayPage(psOut, page, 72, 72, 0, false, true, true);
+    }
+    delete psOut;
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        fprintf(stderr, "Usage: ps-threads-check <temporary PDF file>\n");
+        return 1;
+    }
+
+    globalParams = std::make_unique<GlobalParams>();
+
+    const std::string pdf = makeTestPDF();
+    FILE *f = fopen(argv[1], "wb");
+    if (!f || fwrite(pdf.data(), 1, pdf.size(), f) != pdf.size() || fclose(f) != 0) {
+        fprintf(stderr, "Error writing %s\n", argv[1]);
+        return 1;
+    }
+    PDFDoc doc(new GooString(argv[1]));
+    if (!doc.isOk()) {
+        fprintf(stderr, "Error loading the generated document\n");
+        remove(argv[1]);
+        return 1;
+    }
+
+    std::vector<int> all;
+    for (int page = 1; page <= numPages; ++page) {
+        all.push_back(page);
+    }
+    const std::vector<int> shuffled = { 5, 2, 2, 9, 1, 12, 7, 8, 8, 3 };
+    const std::vector<int> odd = { 1, 3, 5, 7, 9, 11 };
+
+    struct Run
+    {
+        const char *name;
+        const std::vector<int> &pages;
+        const std::vector<int> &displayed;
+    };
+    const Run runs[] = { { "all pages", all, all }, { "pages out of order", shuffled, shuffled }, { "pages skipped", all, odd } };
+
+    int errors = 0;
+    for (const Run &run : runs) {
+        const std::string expected = convert(&doc, run.pages, run.displayed, 0);
+        if (expected.empty()) {
+            fprintf(stderr, "%s: no output without threads\n", run.name);
+            ++errors;
+            continue;
+        }
+        for (const int threads : { 1, 2, 4 }) {
+            if (convert(&doc, run.pages, run.displayed, threads) != expected) {
+                fprintf(stderr, "%s, %d threads: the output differs from the output without threads\n", run.name, threads);
+                ++errors;
+            }
+        }
+    }
+
+    remove(argv[1]);
+    return errors ? 1 : 0;
+}
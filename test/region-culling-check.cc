@@ -0,0 +1,204 @@
+//========================================================================
+//
+// region-culling-check.cc
+//
+// Check the region culling of Gfx: a page drawn with culling must be
+// the same as without it, with clip regions cutting through paths,
+// strokes, text, images and forms, at several resolutions and page
+// rotations.  Each page has the same drawings at a different distance
+// from the clip edges, one point apart, so that the culling tests are
+// checked from both sides of their limits.  Culling must also skip
+// the drawings far outside the clip regions.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "SplashOutputDev.h"
+#include "Stream.h"
+#include "splash/SplashBitmap.h"
+#include "test-pdf-writer.h"
+
+// A SplashOutputDev which can turn culling off, and counts the
+// operations which draw.
+class CountingOutputDev : public SplashOutputDev
+{
+public:
+    CountingOutputDev(bool cullA, SplashColorPtr paperColorA) : SplashOutputDev(splashModeRGB8, 4, false, paperColorA), cull(cullA) { }
+
+    bool useRegionCulling() override { return cull; }
+
+    void stroke(GfxState *state) override
+    {
+        ++drawOps;
+        SplashOutputDev::stroke(state);
+    }
+    void fill(GfxState *state) override
+    {
+        ++drawOps;
+        SplashOutputDev::fill(state);
+    }
+    void eoFill(GfxState *state) override
+    {
+        ++drawOps;
+        SplashOutputDev::eoFill(state);
+    }
+    void drawChar(GfxState *state, double x, double y, double dx, double dy, double originX, double originY, CharCode code, int nBytes, const Unicode *u, int uLen) override
+    {
+        ++drawOps;
+        SplashOutputDev::drawChar(state, x, y, dx, dy, originX, originY, code, nBytes, u, uLen);
+    }
+    void drawImageMask(GfxState *state, Object *ref, Stream *str, int width, int height, bool invert, bool interpolate, bool inlineImg) override
+    {
+        ++drawOps;
+        SplashOutputDev::drawImageMask(state, ref, str, width, height, invert, interpolate, inlineImg);
+    }
+    void drawImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, bool interpolate, const int *maskColors, bool inlineImg) override
+    {
+        ++drawOps;
+        SplashOutputDev::drawImage(state, ref, str, width, height, colorMap, interpolate, maskColors, inlineImg);
+    }
+
+    int drawOps = 0;
+
+private:
+    bool cull;
+};
+
+// Everything Gfx culls, side by side within about 48 x 56 points:
+// a rectangle, a curve, a stroke with a long miter pointing to the
+// right, text, an image, an image mask, an inline image and a form.
+static const char *const cell = "0 0 1 rg 0 0 10 10 re f\n"
+                                "0.5 0 0.5 rg 0 12 m 14 18 6 24 0 22 c f\n"
+                                "1 0 0 RG 5 w 10 M 0 30 m 14 34 l 0 38 l S\n"
+                                "0 0.5 0 rg BT /F1 12 Tf 0 44 Td (Ag) Tj ET\n"
+                                "q 12 0 0 12 26 0 cm /Im1 Do Q\n"
+                                "0.7 0.3 0 rg q 8 0 0 8 28 14 cm /Im2 Do Q\n"
+                                "q 8 0 0 8 28 24 cm BI /W 2 /H 2 /CS /G /BPC 8 /F /AHx ID 00ff8040> EI Q\n"
+                                "/Fm1 Do\n";
+
+// Draw the cell across the four edges of the 200 x 200 box at (x0, y0),
+// <d> points from the edge: entirely outside the box for d = -60, just
+// inside for d = 4.  The four cells don't overlap.
+static std::string drawCells(int x0, int y0, int d)
+{
+    std::string s;
+    char buf[64];
+    const int pos[4][2] = { { x0 + d, y0 + 70 }, { x0 + 152 - d, y0 + 70 }, { x0 + 76, y0 + d }, { x0 + 76, y0 + 144 - d } };
+    for (const auto &p : pos) {
+        snprintf(buf, sizeof(buf), "q 1 0 0 1 %d %d cm\n", p[0], p[1]);
+        s += buf;
+        s += cell;
+        s += "Q\n";
+    }
+    return s;
+}
+
+// The page of the cells at <d> points from the edges of four clip
+// regions.
+static std::string makePageContent(int d)
+{
+    std::string content;
+    // a rectangle
+    content += "q 50 50 200 200 re W n\n" + drawCells(50, 50, d) + "Q\n";
+    // a rotated rectangle, with the cells in its coordinates
+    content += "q 0.8 0.6 -0.6 0.8 450 20 cm 0 0 200 200 re W n\n" + drawCells(0, 0, d) + "Q\n";
+    // a curve inside a rectangle
+    content += "q 50 350 200 200 re W n 150 350 m 290 350 290 550 150 550 c 10 550 10 350 150 350 c W n\n" + drawCells(50, 350, d) + "Q\n";
+    // text, which must be kept whole even outside the clip region
+    content += "q 350 350 200 200 re W n BT 7 Tr /F1 12 Tf 250 440 Td (MMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMMM) Tj ET\n" + drawCells(350, 350, d) + "Q\n";
+    return content;
+}
+
+static const int firstOffset = -60, lastOffset = 4;
+
+static std::string makeTestPDF()
+{
+    const int numPages = lastOffset - firstOffset + 1;
+    TestPDFWriter writer;
+
+    // 1: catalog, 2: pages, 3: font, 4, 5, 6: images and form, then a
+    // page and its content per offset
+    std::string kids;
+    for (int i = 0; i < numPages; ++i) {
+        kids += std::to_string(7 + 2 * i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(numPages) + " >>");
+    writer.addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    writer.addStream("/Type /XObject /Subtype /Image /Width 4 /Height 4 /ColorSpace /DeviceRGB /BitsPerComponent 8 /Filter /ASCIIHexDecode",
+                     "ff0000 00ff00 0000ff ffff00 00ffff ff00ff 808080 000000 ff8000 0080ff 80ff00 ff0080 404040 c0c0c0 ffffff 800000>");
+    writer.addStream("/Type /XObject /Subtype /Image /Width 8 /Height 8 /ImageMask true /Decode [ 1 0 ] /Filter /ASCIIHexDecode", "18 3c 7e ff ff 7e 3c 18>");
+    writer.addStream("/Type /XObject /Subtype /Form /BBox [ -2 -2 14 14 ] /Matrix [ 0.8 0.6 -0.6 0.8 36 36 ] /Resources << /Font << /F1 3 0 R >> >>", "0.2 0.6 0.6 rg 0 0 m 16 6 l 6 16 l f 1 0 0 rg BT /F1 9 Tf 0 2 Td (x) Tj ET");
+    for (int i = 0; i < numPages; ++i) {
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 600 600 ] /Contents " + std::to_string(8 + 2 * i) + " 0 R /Resources << /Font << /F1 3 0 R >> /XObject << /Im1 4 0 R /Im2 5 0 R /Fm1 6 0 R >> >> >>");
+        writer.addStream("", makePageContent(firstOffset + i));
+    }
+    return writer.finish();
+}
+
+static SplashBitmap *render(PDFDoc *doc, int page, bool cull, double dpi, int rotate, bool antialias, int *drawOps)
+{
+    SplashColor paperColor;
+    paperColor[0] = paperColor[1] = paperColor[2] = 0xff;
+    CountingOutputDev out(cull, paperColor);
+    out.setVectorAntialias(antialias);
+    out.setFontAntialias(antialias);
+    out.startDoc(doc);
+    doc->displayPage(&out, page, dpi, dpi, rotate, false, true, false);
+    *drawOps = out.drawOps;
+    return out.takeBitmap();
+}
+
+int main()
+{
+    globalParams = std::make_unique<GlobalParams>();
+
+    const std::string pdf = makeTestPDF();
+    PDFDoc doc(new MemStream(pdf.data(), 0, pdf.size(), Object(objNull)));
+    if (!doc.isOk()) {
+        fprintf(stderr, "Error loading the generated document\n");
+        return 1;
+    }
+
+    struct Setup
+    {
+        double dpi;
+        int rotate;
+        bool antialias;
+    };
+    static const Setup setups[] = { { 72, 0, false }, { 72, 0, true }, { 150, 0, true }, { 150, 90, false } };
+
+    int errors = 0;
+    for (int page = 1; page <= doc.getNumPages(); ++page) {
+        const int d = firstOffset + page - 1;
+        for (const Setup &setup : setups) {
+            int culledOps, allOps;
+            SplashBitmap *culled = render(&doc, page, true, setup.dpi, setup.rotate, setup.antialias, &culledOps);
+            SplashBitmap *all = render(&doc, page, false, setup.dpi, setup.rotate, setup.antialias, &allOps);
+            if (culled->getWidth() != all->getWidth() || culled->getHeight() != all->getHeight() || memcmp(culled->getDataPtr(), all->getDataPtr(), culled->getRowSize() * culled->getHeight()) != 0) {
+                fprintf(stderr, "cells %d points from the edges, %g dpi, rotation %d, antialias %d: the page differs with culling\n", d, setup.dpi, setup.rotate, setup.antialias);
+                ++errors;
+            }
+            // the cells far outside the clip regions are culled
+            if (d < -50 && culledOps >= allOps) {
+                fprintf(stderr, "cells %d points from the edges, %g dpi, rotation %d, antialias %d: nothing was culled (%d operations)\n", d, setup.dpi, setup.rotate, setup.antialias, culledOps);
+                ++errors;
+            }
+            delete culled;
+            delete all;
+        }
+    }
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+//========================================================================
+//
+// splash-mask-scale-check.cc
+//
+// Check that Splash::fillImageMask draws the same image masks from the
+// packed lines (Splash::scaleMaskPackedYdownXdown) as from the unpacked
+// ones (Splash::scaleMaskYdownXdown), for odd widths, with the bits of
+// both Decode arrays, and with upright, flipped and rotated matrices.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "splash/Splash.h"
+#include "splash/SplashBitmap.h"
+#include "splash/SplashPattern.h"
+
+// A 1 bit mask, packed as in a PDF image stream.  The padding bits at
+// the end of each line are random too, as they are in the streams.
+struct MaskData
+{
+    const unsigned char *bits;
+    int width, height, rowBytes;
+    bool invert; // as SplashOutputDev: true with Decode [0 1]
+    int y;
+};
+
+static bool unpackedSrc(void *data, SplashColorPtr line)
+{
+    MaskData *mask = (MaskData *)data;
+    if (mask->y == mask->height) {
+        return false;
+    }
+    const unsigned char *p = mask->bits + mask->y * mask->rowBytes;
+    for (int x = 0; x < mask->width; ++x) {
+        line[x] = ((p[x >> 3] >> (7 - (x & 7))) & 1) ^ mask->invert;
+    }
+    ++mask->y;
+    return true;
+}
+
+static bool packedSrc(void *data, unsigned char *line)
+{
+    MaskData *mask = (MaskData *)data;
+    if (mask->y == mask->height) {
+        return false;
+    }
+    const unsigned char *p = mask->bits + mask->y * mask->rowBytes;
+    for (int i = 0; i < mask->rowBytes; ++i) {
+        line[i] = mask->invert ? p[i] ^ 0xff : p[i];
+    }
+    ++mask->y;
+    return true;
+}
+
+// Draw the mask with the matrix <mat> on a blank <size> x <size> bitmap,
+// from the packed lines or not.
+static SplashBitmap *drawMask(const std::vector<unsigned char> &bits, int width, int height, bool invert, const SplashCoord *mat, bool antialias, bool packed, int size)
+{
+    SplashBitmap *bitmap = new SplashBitmap(size, size, 1, splashModeMono8, false);
+    Splash splash(bitmap, antialias);
+    SplashColor color;
+    color[0] = 0;
+    splash.clear(color);
+    color[0] = 0xff;
+    splash.setFillPattern(new SplashSolidColor(color));
+
+    MaskData mask = { bits.data(), width, height, (width + 7) >> 3, invert, 0 };
+    SplashCoord m[6];
+    memcpy(m, mat, sizeof(m));
+    splash.fillImageMask(&unpackedSrc, &mask, width, height, m, false, packed ? &packedSrc : nullptr);
+    return bitmap;
+}
+
+int main()
+{
+    static const int widths[] = { 1, 7, 63, 64, 65, 129, 333, 1001 };
+    static const int heights[] = { 1, 5, 97, 250 };
+    static const int sizes[] = { 1, 3, 40 };
+
+    unsigned int seed = 12345;
+    int errors = 0, checks = 0;
+    for (const int width : widths) {
+        for (const int height : heights) {
+            // random bits, with a few blank and full lines
+            const int rowBytes = (width + 7) >> 3;
+            std::vector<unsigned char> bits(rowBytes * height);
+            for (int y = 0; y < height; ++y) {
+                for (int i = 0; i < rowBytes; ++i) {
+                    seed = seed * 1103515245 + 12345;
+                    bits[y * rowBytes + i] = y % 7 == 3 ? 0 : y % 11 == 5 ? 0xff : (seed >> 16) & 0xff;
+                }
+            }
+
+            for (const int size : sizes) {
+                // scaled down in both directions, upright, flipped and
+                // rotated (through arbitraryTransformMask)
+                const SplashCoord s = size;
+                const SplashCoord mats[][6] = { { s, 0, 0, s, 0, 0 }, { s, 0, 0, -s, 0, s }, { 0, s, s, 0, 0, 0 }, { 0.7 * s, 0.3 * s, -0.3 * s, 0.7 * s, 0.3 * s, 0 } };
+                for (const SplashCoord *mat : mats) {
+                    for (const bool invert : { false, true }) {
+                        for (const bool antialias : { false, true }) {
+                            SplashBitmap *unpacked = drawMask(bits, width, height, invert, mat, antialias, false, size);
+                            SplashBitmap *packed = drawMask(bits, width, height, invert, mat, antialias, true, size);
+                            ++checks;
+                            if (memcmp(unpacked->getDataPtr(), packed->getDataPtr(), unpacked->getRowSize() * size) != 0) {
+                                fprintf(stderr, "%dx%d mask drawn at %d pixels, matrix [%g %g %g %g], invert %d, antialias %d: packed and unpacked lines differ\n", width, height, size, (double)mat[0], (double)mat[1], (double)mat[2], (double)mat[3],
+                                        invert, antialias);
+                                ++errors;
+                            }
+                            delete unpacked;
+                            delete packed;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (errors) {
+        fprintf(stderr, "%d of %d masks differ\n", errors, checks);
+    }
+    return errors ? 1 : 0;
+}
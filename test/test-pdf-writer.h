@@ -0,0 +1,57 @@
+//========================================================================
+//
+// test-pdf-writer.h
+//
+// Build small PDF documents in memory, for the tests and benchmarks
+// which generate their input.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#ifndef TEST_PDF_WRITER_H
+#define TEST_PDF_WRITER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class TestPDFWriter
+{
+public:
+    TestPDFWriter() : pdf("%PDF-1.4\n") { }
+
+    // Append an object and return its number.  Objects are numbered from
+    // 1 in the order they are added, so that the callers can refer to an
+    // object before adding it.
+    int addObject(const std::string &body)
+    {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(offsets.size()) + " 0 obj\n" + body + "\nendobj\n";
+        return offsets.size();
+    }
+
+    // Append a stream object, with the dictionary entries <entries> (the
+    // Length excepted) and the data <data>.
+    int addStream(const std::string &entries, const std::string &data) { return addObject("<< " + entries + (entries.empty() ? "" : " ") + "/Length " + std::to_string(data.size()) + " >>\nstream\n" + data + "\nendstream"); }
+
+    // Return the document, with object 1 as its catalog.
+    std::string finish() const
+    {
+        std::string out = pdf;
+        char buf[32];
+        out += "xref\n0 " + std::to_string(offsets.size() + 1) + "\n0000000000 65535 f \n";
+        for (const size_t offset : offsets) {
+            snprintf(buf, sizeof(buf), "%010zu 00000 n \n", offset);
+            out += buf;
+        }
+        out += "trailer\n<< /Size " + std::to_string(offsets.size() + 1) + " /Root 1 0 R >>\nstartxref\n" + std::to_string(pdf.size()) + "\n%%EOF\n";
+        return out;
+    }
+
+private:
+    std::string pdf;
+    std::vector<size_t> offsets;
+};
+
+#endif
@@ -0,0 +1,128 @@
+//========================================================================
+//
+// text-extraction-bench.cc
+//
+// Time TextOutputDev on synthetic pages with a large number of glyphs,
+// laid out as a dense table (the worst case for word coalescing).
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <string>
+
+#include "goo/GooString.h"
+#include "goo/GooTimer.h"
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "Stream.h"
+#include "TextOutputDev.h"
+#include "utils/parseargs.h"
+#include "test-pdf-writer.h"
+
+static int numGlyphs = 200000;
+static int numPages = 1;
+static int numRuns = 1;
+static bool physLayout = false;
+static bool rawOrder = false;
+static char pdfOutFile[1024] = "";
+static bool printHelp = false;
+
+static const ArgDesc argDesc[] = { { "-glyphs", argInt, &numGlyphs, 0, "number of glyphs per page (default is 200000)" },
+                                   { "-pages", argInt, &numPages, 0, "number of pages (default is 1)" },
+                                   { "-runs", argInt, &numRuns, 0, "number of times the document is extracted (default is 1)" },
+                                   { "-layout", argFlag, &physLayout, 0, "maintain original physical layout" },
+                                   { "-raw", argFlag, &rawOrder, 0, "keep strings in content stream order" },
+                                   { "-o", argString, pdfOutFile, sizeof(pdfOutFile), "also write the generated PDF to this file" },
+                                   { "-h", argFlag, &printHelp, 0, "print usage information" },
+                                   { "-help", argFlag, &printHelp, 0, "print usage information" },
+                                   { "--help", argFlag, &printHelp, 0, "print usage information" },
+                                   { "-?", argFlag, &printHelp, 0, "print usage information" },
+                                   {} };
+
+// Build a PDF whose pages are tables of 4-digit cells in 6 pt
+// Helvetica, <glyphsPerPage> glyphs per page.  Smaller glyphs would
+// hit TextPage's limit on the number of tiny characters.
+static std::string makeTablePDF(int pages, int glyphsPerPage)
+{
+    const int cellChars = 4;
+    const int cells = glyphsPerPage / cellChars;
+    int cols = 1;
+    while (cols * cols < cells) {
+        ++cols;
+    }
+    const int rows = (cells + cols - 1) / cols;
+    const double cellW = 18, cellH = 8;
+    const double pageW = cols * cellW + 20, pageH = rows * cellH + 20;
+
+    std::string content = "BT /F1 6 Tf\n";
+    char buf[128];
+    for (int i = 0; i < cells; ++i) {
+        snprintf(buf, sizeof(buf), "1 0 0 1 %g %g Tm (%04d) Tj\n", 10 + (i % cols) * cellW, pageH - 10 - (i / cols + 1) * cellH, i % 10000);
+        content += buf;
+    }
+    content += "ET\n";
+
+    TestPDFWriter writer;
+
+    // 1: catalog, 2: pages, 3: font, 4: content, 5..: pages
+    std::string kids;
+    for (int i = 0; i < pages; ++i) {
+        kids += std::to_string(5 + i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(pages) + " >>");
+    writer.addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica >>");
+    writer.addStream("", content);
+    snprintf(buf, sizeof(buf), "[ 0 0 %g %g ]", pageW, pageH);
+    for (int i = 0; i < pages; ++i) {
+        writer.addObject(std::string("<< /Type /Page /Parent 2 0 R /MediaBox ") + buf + " /Contents 4 0 R /Resources << /Font << /F1 3 0 R >> >> >>");
+    }
+    return writer.finish();
+}
+
+static void countText(void *stream, const char *, int len)
+{
+    *(size_t *)stream += len;
+}
+
+int main(int argc, char *argv[])
+{
+    const bool ok = parseArgs(argDesc, &argc, argv);
+    if (!ok || argc != 1 || printHelp || numGlyphs < 4 || numPages < 1 || numRuns < 1) {
+        printUsage(argv[0], "", argDesc);
+        return printHelp ? 0 : 1;
+    }
+
+    globalParams = std::make_unique<GlobalParams>();
+
+    const std::string pdf = makeTablePDF(numPages, numGlyphs);
+    if (pdfOutFile[0]) {
+        FILE *f = fopen(pdfOutFile, "wb");
+        if (f) {
+            fwrite(pdf.data(), 1, pdf.size(), f);
+            fclose(f);
+        }
+    }
+
+    PDFDoc doc(new MemStream(pdf.data(), 0, pdf.size(), Object(objNull)));
+    if (!doc.isOk()) {
+        fprintf(stderr, "Error loading the generated document\n");
+        return 1;
+    }
+
+    for (int run = 0; run < numRuns; ++run) {
+        size_t textBytes = 0;
+        GooTimer timer;
+        TextOutputDev textOut(&countText, &textBytes, physLayout, 0, rawOrder);
+        doc.displayPages(&textOut, 1, numPages, 72, 72, 0, true, false, false);
+        timer.stop();
+        printf("%d page(s) of %d glyphs: %.3f ms/page (%zu bytes of text)\n", numPages, numGlyphs, timer.getElapsed() * 1000 / numPages, textBytes);
+    }
+
+    return 0;
+}
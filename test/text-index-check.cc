@@ -0,0 +1,199 @@
+//========================================================================
+//
+// text-index-check.cc
+//
+// Check TextIndex: build an index of a generated document, search it,
+// save it, load it back and search it again.
+//
+// This file is licensed under the GPLv2 or later
+//
+//========================================================================
+
+#include <config.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#    include <io.h>
+#else
+#    include <unistd.h>
+#endif
+
+#include "goo/gmem.h"
+#include "goo/GooString.h"
+#include "GlobalParams.h"
+#include "Object.h"
+#include "PDFDoc.h"
+#include "Stream.h"
+#include "TextIndex.h"
+#include "UTF.h"
+#include "test-pdf-writer.h"
+
+// The content streams of the pages of the test document.  The third
+// page shows "Xyz" replaced by the ActualText "Quux".
+static const char *const pageContents[] = { "BT /F1 24 Tf 72 700 Td (Hello World) Tj 0 -40 Td (caf\351 Bonjour) Tj ET",
+                                            "BT /F1 24 Tf 72 700 Td (hello again, Worldwide) Tj ET",
+                                            "BT /F1 24 Tf 72 700 Td /Span << /ActualText (Quux) >> BDC (Xyz) Tj EMC ( Bonjour) Tj ET" };
+
+static std::string makeTestPDF()
+{
+    const int numPages = sizeof(pageContents) / sizeof(pageContents[0]);
+    TestPDFWriter writer;
+
+    // 1: catalog, 2: pages, 3: font, then a page and its content per page
+    std::string kids;
+    for (int i = 0; i < numPages; ++i) {
+        kids += std::to_string(4 + 2 * i) + " 0 R ";
+    }
+    writer.addObject("<< /Type /Catalog /Pages 2 0 R >>");
+    writer.addObject("<< /Type /Pages /Kids [ " + kids + "] /Count " + std::to_string(numPages) + " >>");
+    writer.addObject("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+    for (int i = 0; i < numPages; ++i) {
+        writer.addObject("<< /Type /Page /Parent 2 0 R /MediaBox [ 0 0 612 792 ] /Contents " + std::to_string(5 + 2 * i) + " 0 R /Resources << /Font << /F1 3 0 R >> >> >>");
+        writer.addStream("", pageContents[i]);
+    }
+    return writer.finish();
+}
+
+// Create an empty temporary file, and return its name (empty on error).
+static std::string makeTempFile()
+{
+#ifdef _WIN32
+    char name[L_tmpnam];
+    if (!tmpnam(name)) {
+        return std::string();
+    }
+    FILE *f = fopen(name, "wb");
+    if (!f) {
+        return std::string();
+    }
+    fclose(f);
+    return name;
+#else
+    const char *dir = getenv("TMPDIR");
+    std::string name = std::string(dir && *dir ? dir : "/tmp") + "/text-index-check-XXXXXX";
+    const int fd = mkstemp(&name[0]);
+    if (fd < 0) {
+        return std::string();
+    }
+    close(fd);
+    return name;
+#endif
+}
+
+// Search <index> for <query>, and return the page of each hit.
+static std::vector<int> findPages(const TextIndex &index, const char *query, bool caseSensitive, bool ignoreDiacritics, bool wholeWord)
+{
+    Unicode *u;
+    const int len = utf8ToUCS4(query, &u);
+    std::vector<int> pages;
+    for (const TextIndexHit &hit : index.find(u, len, caseSensitive, ignoreDiacritics, wholeWord)) {
+        pages.push_back(hit.page);
+    }
+    gfree(u);
+    return pages;
+}
+
+static int checkSearches(const TextIndex &index, const char *what)
+{
+    struct Search
+    {
+        const char *query;
+        bool caseSensitive, ignoreDiacritics, wholeWord;
+        std::vector<int> pages;
+    };
+    static const Search searches[] = {
+        { "hello", false, false, false, { 1, 2 } },
+        { "hello", true, false, false, { 2 } },
+        { "HELLO world", false, false, false, { 1, 1, 2, 2 } },
+        { "world", false, false, true, { 1 } },
+        { "cafe", false, true, false, { 1 } },
+        { "cafe", false, false, false, {} },
+        { "caf\xc3\xa9", false, false, false, { 1 } },
+        { "bonjour", false, false, false, { 1, 3 } },
+        { "quux", false, false, false, { 3 } },
+        { "xyz", false, false, false, {} },
+        { "hello quux", false, false, false, {} },
+    };
+
+    int errors = 0;
+    for (const Search &search : searches) {
+        if (findPages(index, search.query, search.caseSensitive, search.ignoreDiacritics, search.wholeWord) != search.pages) {
+            fprintf(stderr, "%s: wrong hits for \"%s\"\n", what, search.query);
+            ++errors;
+        }
+    }
+    return errors;
+}
+
+int main()
+{
+    globalParams = std::make_unique<GlobalParams>();
+
+    const std::string pdf = makeTestPDF();
+    PDFDoc doc(new MemStream(pdf.data(), 0, pdf.size(), Object(objNull)));
+    if (!doc.isOk()) {
+        fprintf(stderr, "Error loading the generated document\n");
+        return 1;
+    }
+
+    std::unique_ptr<TextIndex> index = TextIndex::build(&doc);
+    if (!index || index->getFirstPage() != 1 || index->getNumPages() != doc.getNumPages()) {
+        fprintf(stderr, "TextIndex::build() failed\n");
+        return 1;
+    }
+    int errors = checkSearches(*index, "built index");
+
+    // the hits of a page range are numbered as in the document
+    std::unique_ptr<TextIndex> rangeIndex = TextIndex::build(&doc, 2, 3);
+    if (!rangeIndex || findPages(*rangeIndex, "bonjour", false, false, false) != std::vector<int> { 3 }) {
+        fprintf(stderr, "wrong hits in the index of pages 2 to 3\n");
+        ++errors;
+    }
+
+    const std::string tempName = makeTempFile();
+    if (tempName.empty()) {
+        fprintf(stderr, "Error creating a temporary file\n");
+        return 1;
+    }
+    const GooString fileName(tempName);
+    if (!index->save(&fileName)) {
+        fprintf(stderr, "TextIndex::save() failed\n");
+        remove(fileName.c_str());
+        return 1;
+    }
+    std::unique_ptr<TextIndex> loaded = TextIndex::load(&fileName);
+    if (!loaded || loaded->getNumPages() != index->getNumPages()) {
+        fprintf(stderr, "TextIndex::load() failed\n");
+        ++errors;
+    } else {
+        errors += checkSearches(*loaded, "loaded index");
+    }
+
+    // a truncated file is rejected
+    std::string data;
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (f) {
+        char buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) {
+            data.append(buf, n);
+        }
+        fclose(f);
+    }
+    if (!data.empty() && (f = fopen(fileName.c_str(), "wb"))) {
+        fwrite(data.data(), 1, data.size() - 1, f);
+        fclose(f);
+    }
+    if (TextIndex::load(&fileName)) {
+        fprintf(stderr, "TextIndex::load() accepted a truncated file\n");
+        ++errors;
+    }
+    remove(fileName.c_str());
+
+    return errors ? 1 : 0;
+}
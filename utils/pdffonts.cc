@@ -109,6 +109,8 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    doc->preloadObjectStreams();
+
     // get page range
     if (firstPage < 1) {
         firstPage = 1;
@@ -996,6 +996,8 @@ int main(int argc, char *argv[])
         goto err2;
     }
 
+    doc->preloadObjectStreams();
+
     // get page range
     if (firstPage < 1) {
         firstPage = 1;
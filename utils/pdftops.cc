@@ -99,6 +99,7 @@ static bool doForm = false;
 static bool doOPI = false;
 #endif
 static int splashResolution = 0;
+static int rasterBandMemory = 0;
 static bool psBinary = false;
 static bool noEmbedT1Fonts = false;
 static bool noEmbedTTFonts = false;
@@ -110,6 +111,8 @@ static bool passLevel1CustomColor = false;
 static char rasterAntialiasStr[16] = "";
 static char forceRasterizeStr[16] = "";
 static bool preload = false;
+static bool streamPages = false;
+static int numThreads = 0;
 static char paperSize[15] = "";
 static int paperWidth = -1;
 static int paperHeight = -1;
@@ -153,6 +156,7 @@ static const ArgDesc argDesc[] = { { "-f", argInt, &firstPage, 0, "first page to
                                    { "-opi", argFlag, &doOPI, 0, "generate OPI comments" },
 #endif
                                    { "-r", argInt, &splashResolution, 0, "resolution for rasterization, in DPI (default is 300)" },
+                                   { "-rasterbandmem", argInt, &rasterBandMemory, 0, "memory for the bitmap of each band of a rasterized page, in MB" },
                                    { "-binary", argFlag, &psBinary, 0, "write binary data in Level 1 PostScript" },
                                    { "-noembt1", argFlag, &noEmbedT1Fonts, 0, "don't embed Type 1 fonts" },
                                    { "-noembtt", argFlag, &noEmbedTTFonts, 0, "don't embed TrueType fonts" },
@@ -171,6 +175,8 @@ static const ArgDesc argDesc[] = { { "-f", argInt, &firstPage, 0, "first page to
                                    { "-optimizecolorspace", argFlag, &optimizeColorSpace, 0, "convert gray RGB images to gray color space" },
                                    { "-passlevel1customcolor", argFlag, &passLevel1CustomColor, 0, "pass custom color in level1sep" },
                                    { "-preload", argFlag, &preload, 0, "preload images and forms" },
+                                   { "-stream", argFlag, &streamPages, 0, "write the fonts and forms with each page, without a pass over the document" },
+                                   { "-threads", argInt, &numThreads, 0, "number of threads pre-scanning and rasterizing the pages ahead" },
                                    { "-paper", argString, paperSize, sizeof(paperSize), "paper size (letter, legal, A4, A3, match)" },
                                    { "-paperw", argInt, &paperWidth, 0, "paper width, in points" },
                                    { "-paperh", argInt, &paperHeight, 0, "paper height, in points" },
@@ -475,6 +481,9 @@ int main(int argc, char *argv[])
     if (splashResolution > 0) {
         psOut->setRasterResolution(splashResolution);
     }
+    if (rasterBandMemory > 0) {
+        psOut->setRasterBandMemory((size_t)rasterBandMemory << 20);
+    }
     if (processcolorformatspecified)
         psOut->setProcessColorFormat(processcolorformat);
 #ifdef USE_CMS
@@ -489,6 +498,18 @@ int main(int argc, char *argv[])
     psOut->setEmbedCIDTrueType(!noEmbedCIDTTFonts);
     psOut->setFontPassthrough(fontPassthrough);
     psOut->setPreloadImagesForms(preload);
+    psOut->setStreamPages(streamPages);
+    if (numThreads > 0) {
+        // the worker threads open their own copy of the document
+        std::unique_ptr<GooString> ownerPW2, userPW2;
+        if (ownerPassword[0] != '\001') {
+            ownerPW2 = std::make_unique<GooString>(ownerPassword);
+        }
+        if (userPassword[0] != '\001') {
+            userPW2 = std::make_unique<GooString>(userPassword);
+        }
+        psOut->setRasterThreads(numThreads, ownerPW2.get(), userPW2.get());
+    }
     psOut->setOptimizeColorSpace(optimizeColorSpace);
     psOut->setPassLevel1CustomColor(passLevel1CustomColor);
 #ifdef OPI_SUPPORT
@@ -67,6 +67,10 @@
 #include <sstream>
 #include <iomanip>
 #include "Win32Console.h"
+#if defined(_WIN32) || defined(__CYGWIN__)
+#    include <fcntl.h> // for O_BINARY
+#    include <io.h> // for _setmode
+#endif
 
 static void printInfoString(FILE *f, Dict *infoDict, const char *key, const char *text1, const char *text2, const UnicodeMap *uMap);
 static void printInfoDate(FILE *f, Dict *infoDict, const char *key, const char *fmt);
@@ -88,6 +92,7 @@ static double colspacing = TextOutputDev::minColSpacing1_default;
 static double fixedPitch = 0;
 static bool rawOrder = false;
 static bool discardDiag = false;
+static int numThreads = 1;
 static bool htmlMeta = false;
 static char textEncName[128] = "";
 static char textEOLStr[16] = "";
@@ -110,6 +115,7 @@ static const ArgDesc argDesc[] = { { "-f", argInt, &firstPage, 0, "first page to
                                    { "-fixed", argFP, &fixedPitch, 0, "assume fixed-pitch (or tabular) text" },
                                    { "-raw", argFlag, &rawOrder, 0, "keep strings in content stream order" },
                                    { "-nodiag", argFlag, &discardDiag, 0, "discard diagonal text" },
+                                   { "-j", argInt, &numThreads, 0, "number of threads used to extract pages concurrently (default is 1)" },
                                    { "-htmlmeta", argFlag, &htmlMeta, 0, "generate a simple HTML file, including the meta information" },
                                    { "-enc", argString, textEncName, sizeof(textEncName), "output text encoding name" },
                                    { "-listenc", argFlag, &printEnc, 0, "list available encodings" },
@@ -145,6 +151,11 @@ static std::string myStringReplace(const std::string &inString, const std::strin
     return result;
 }
 
+static void outputToFile(void *stream, const char *text, int len)
+{
+    fwrite(text, 1, len, (FILE *)stream);
+}
+
 static std::string myXmlTokenReplace(const char *inString)
 {
     std::string myString(inString);
@@ -275,6 +286,8 @@ int main(int argc, char *argv[])
     }
 #endif
 
+    doc->preloadObjectStreams();
+
     // construct text file name
     if (argc == 3) {
         textFileName = new GooString(argv[2]);
@@ -362,6 +375,36 @@ int main(int argc, char *argv[])
         if (f != stdout) {
             fclose(f);
         }
+    } else if (numThreads > 1) {
+        // each worker extracts whole pages with its own TextOutputDev,
+        // the pages are then written here in page order
+        textOut = nullptr;
+        if (!textFileName->cmp("-")) {
+            f = stdout;
+#if defined(_WIN32) || defined(__CYGWIN__)
+            // keep DOS from munging the end-of-line characters
+            _setmode(fileno(stdout), O_BINARY);
+#endif
+        } else if (!(f = fopen(textFileName->c_str(), htmlMeta ? "ab" : "wb"))) {
+            error(errIO, -1, "Couldn't open text file '{0:t}'", textFileName);
+            exitCode = 2;
+            goto err3;
+        }
+        const bool slice = (w != 0) || (h != 0) || (x != 0) || (y != 0);
+        extractTextPages(
+                doc.get(), firstPage, lastPage, numThreads, resolution, resolution, true, false, slice ? x : -1, slice ? y : -1, slice ? w : -1, slice ? h : -1,
+                [] {
+                    auto dev = std::make_unique<TextOutputDev>(nullptr, physLayout, fixedPitch, rawOrder, false, discardDiag);
+                    dev->setMinColSpacing1(colspacing);
+                    return dev;
+                },
+                [f, textEOL](int, TextPage *text) {
+                    text->dump(f, &outputToFile, physLayout, textEOL, !noPageBreaks);
+                    text->decRefCnt();
+                });
+        if (f != stdout) {
+            fclose(f);
+        }
     } else {
         textOut = new TextOutputDev(textFileName->c_str(), physLayout, fixedPitch, rawOrder, htmlMeta, discardDiag);
         if (textOut->isOk()) {